@@ -4,6 +4,11 @@
 #include "ui_MainWindow.h"
 
 #include <QFileSystemModel>
+#include <QFileSystemWatcher>
+#include <QSet>
+#include <QTimer>
+
+#include "DeployIgnore.h"
 
 enum class piStatus;
 class RaspberryPi;
@@ -16,6 +21,9 @@ struct piConfig {
     // Map the meta parameter names to their values
     QMap<QString, QString> args;
 
+    // Map the names of further options (e.g., workspace) to their values, they override the options of the project
+    QMap<QString, QString> options;
+
     // Save if the project name is valid (found in sw_workspace)
     bool projectValid;
 };
@@ -47,9 +55,15 @@ private:
     // Stores the path of the projects
     QString projectsPath = "";
 
+    // Maps the names of the global options of the testbed configuration (e.g., ignore) to their values, used by every project
+    QMap<QString, QString> globalOptions;
+
     // Maps the project names to the arguments of the project
     QMap<QString, QString> projects_argv;
 
+    // Maps the project names to the further options of the project (e.g., workspace)
+    QMap<QString, QMap<QString, QString>> projects_options;
+
     // Store every Raspberry Pi inside a list
     QList<RaspberryPi*> pis;
 
@@ -68,6 +82,34 @@ private:
     // Saves the number of busy Raspberry Pis where a operation is executed (e.g., currenly saving, building, starting, or stopping)
     unsigned int busyPiCount = 0;
 
+    // Indicates that a build is running, the button "btn_compile" aborts it meanwhile
+    bool building = false;
+
+    // Watches the folders and files of the projects in watch mode (inotify on Linux)
+    QFileSystemWatcher* watcher;
+
+    // Maps the watched projects to their debounce timer, the update starts when no further change happened for WATCH_DEBOUNCE ms
+    QMap<QString, QTimer*> watchTimers;
+
+    // Maps the watched projects to the time (ms since the Unix epoch) of the first change since their last update
+    QMap<QString, qint64> watchFirstChange;
+
+    // Maps the watched projects to their ignore patterns (option ignore and .deployignore), changes of ignored paths don't start an update
+    QMap<QString, DeployIgnore> watchIgnore;
+
+    // Maps the watched folders to their entries which aren't ignored and their modification times, a folder change which only concerns ignored entries (e.g., swap files) is skipped
+    QMap<QString, QMap<QString, qint64>> watchEntries;
+
+    // The Raspberry Pis which are updated in watch mode
+    QList<RaspberryPi*> watchPis;
+
+    // Maps the Raspberry Pis which are currently updated resp. have to be updated again afterwards to the time of the first change they apply
+    QMap<RaspberryPi*, qint64> watchBusy;
+    QMap<RaspberryPi*, qint64> watchPending;
+
+    // Shows the current transfer rates of the Raspberry Pis every RATE_INTERVAL ms
+    QTimer* rateTimer;
+
     // Save if the last change to the output scrollbar was made by the user
     //bool scrollbarChangedByUser = true;
 
@@ -83,7 +125,7 @@ private:
     QList<piConfig> readConfig();
 
     /// <summary>
-    /// Reads the arguments file (argv.txt) of the given project
+    /// Reads the configuration file (config.txt) of the given project i.e., the arguments and further options
     /// </summary>
     /// <param name="projectName">Name of the project</param>
     /// <param name="projectPath">Path to the project's directory</param>
@@ -123,6 +165,38 @@ private:
     /// <param name="enable">If true enables all buttons, else disables all buttons</param>
     void btns_setEnabled(bool enable);
 
+    /// <summary>
+    /// Adds the folder and all subfolders of the project which aren't ignored to the watcher, folders which are already watched are skipped
+    /// </summary>
+    /// <param name="project">Name of the project</param>
+    void watch_addPaths(QString project);
+
+    /// <summary>
+    /// Checks if a folder or file of a watched project is ignored by its patterns, also if one of its parent folders is ignored
+    /// </summary>
+    /// <param name="project">Name of the project</param>
+    /// <param name="path">Absolute path of the folder or file</param>
+    /// <returns>true if the folder or file isn't deployed, i.e., its changes don't need an update</returns>
+    bool watch_ignored(QString project, QString path);
+
+    /// <summary>
+    /// Returns the names and modification times (ms since epoch) of the entries of a watched folder which aren't ignored
+    /// </summary>
+    /// <param name="project">Name of the project</param>
+    /// <param name="folder">Absolute path of the folder</param>
+    QMap<QString, qint64> watch_entries(QString project, QString folder);
+
+    /// <summary>
+    /// Updates the watched Raspberry Pis of the project after it has changed, called when its debounce timer expires
+    /// </summary>
+    /// <param name="project">Name of the project</param>
+    void watch_update(QString project);
+
+    /// <summary>
+    /// Shows the current transfer rates which the SSH executables save inside RATE_FOLDER next to the Raspberry Pis, called by rateTimer
+    /// </summary>
+    void show_rates();
+
 public slots:
     /// <summary>
     /// Called if the button "btn_save" was clicked
@@ -149,6 +223,28 @@ public slots:
     /// </summary>
     void btn_refresh_clicked();
 
+    /// <summary>
+    /// Called if the button "btn_collect" was clicked
+    /// </summary>
+    void btn_collect_clicked();
+
+    /// <summary>
+    /// Called if the button "btn_pipeline" was clicked
+    /// </summary>
+    void btn_pipeline_clicked();
+
+    /// <summary>
+    /// Called if the button "btn_watch" was toggled
+    /// </summary>
+    /// <param name="checked">true if watch mode was started, false if it was stopped</param>
+    void btn_watch_toggled(bool checked);
+
+    /// <summary>
+    /// Called if a watched folder or file has changed
+    /// </summary>
+    /// <param name="path">Path of the changed folder or file</param>
+    void watcher_pathChanged(QString path);
+
     /// <summary>
     /// Called if the checkbox "chbx_selectAll" has been toggled
     /// </summary>
@@ -185,6 +281,23 @@ public slots:
     /// <param name="output">Output from the SSH executable</param>
     void SSHsave_finished(RaspberryPi* pi, bool success, QByteArray output);
 
+    /// <summary>
+    /// Received after the project has been synced and relayed to other Raspberry Pis, response from RaspberryPi
+    /// </summary>
+    /// <param name="pi">Pointer to a RaspberryPi object (the seed)</param>
+    /// <param name="success">true, if the project was synced and relayed to all targets, else false</param>
+    /// <param name="output">Output from the SSH executable, including the result of every target</param>
+    /// <param name="targets">Addresses of all targets of the relay, they are counted as busy until they have finished</param>
+    /// <param name="unrelayed">Addresses of the targets which didn't receive the project, they save it themselves</param>
+    void SSHrelay_finished(RaspberryPi* pi, bool success, QByteArray output, QStringList targets, QStringList unrelayed);
+
+    /// <summary>
+    /// Received while the project is compiled or its pipeline runs whenever new lines were printed, response from RaspberryPi
+    /// </summary>
+    /// <param name="pi">Pointer to a RaspberryPi object</param>
+    /// <param name="output">The new complete lines of the output</param>
+    void SSHstream_output(RaspberryPi* pi, QByteArray output);
+
     /// <summary>
     /// Received after the project has been compiled, response from RaspberryPi
     /// </summary>
@@ -193,6 +306,16 @@ public slots:
     /// <param name="output">Output from the SSH executable</param>
     void SSHcompile_finished(RaspberryPi* pi, bool success, QByteArray output);
 
+    /// <summary>
+    /// Received after the project has been compiled and its binary copied to other Raspberry Pis, response from RaspberryPi
+    /// </summary>
+    /// <param name="pi">Pointer to a RaspberryPi object</param>
+    /// <param name="success">true, if the project was compiled successfully, else false</param>
+    /// <param name="output">Output from the SSH executable, including the result of every target</param>
+    /// <param name="unshared">Addresses of the targets which didn't receive the binary, they build the project themselves</param>
+    /// <param name="rebuild">The rebuild flag of the request</param>
+    void SSHcompileShare_finished(RaspberryPi* pi, bool success, QByteArray output, QStringList unshared, bool rebuild);
+
     /// <summary>
     /// Received after the project has been started, response from RaspberryPi
     /// </summary>
@@ -209,6 +332,30 @@ public slots:
     /// <param name="output">Output from the SSH executable</param>
     void SSHstop_finished(RaspberryPi* pi, bool success, QByteArray output);
 
+    /// <summary>
+    /// Received after the results have been collected, response from RaspberryPi
+    /// </summary>
+    /// <param name="pi">Pointer to a RaspberryPi object</param>
+    /// <param name="success">true, if all results were collected successfully, else false</param>
+    /// <param name="output">Output from the SSH executable</param>
+    void SSHcollect_finished(RaspberryPi* pi, bool success, QByteArray output);
+
+    /// <summary>
+    /// Received after the pipeline of the project has run, response from RaspberryPi
+    /// </summary>
+    /// <param name="pi">Pointer to a RaspberryPi object</param>
+    /// <param name="success">true, if all stages succeeded, else false</param>
+    /// <param name="output">Output from the SSH executable which wasn't shown line by line</param>
+    void SSHpipeline_finished(RaspberryPi* pi, bool success, QByteArray output);
+
+    /// <summary>
+    /// Received after the project has been synced, rebuilt, and restarted in watch mode, response from RaspberryPi
+    /// </summary>
+    /// <param name="pi">Pointer to a RaspberryPi object</param>
+    /// <param name="success">true, if the application is running the changed project, else false</param>
+    /// <param name="output">Output from the SSH executable</param>
+    void SSHupdate_finished(RaspberryPi* pi, bool success, QByteArray output);
+
     /// <summary>
     /// Received after checking the status of the Raspberry Pi, signal from RaspberryPi
     /// </summary>
@@ -7,6 +7,8 @@
 #include <QThread>
 #include <QTreeWidgetItem>
 
+#include <atomic>
+
 class MainWindow;
 struct piConfig;
 
@@ -27,9 +29,10 @@ public:
     /// <param name="w">Pointer to a MainWindow object</param>
     /// <param name="config">The configuration (struct) for the Raspberry Pi</param>
     /// <param name="project_argv">The arguments of the project which may include meta parameters</param>
+    /// <param name="project_options">The further options of the project (e.g., workspace)</param>
     /// <param name="item">A pointer to the item of the Raspberry Pi inside the QTreeWidget of the clients</param>
     /// <param name="te_output">A pointer to the QTextEdit tab of the Raspberry Pi from the output tab widget</param>
-    RaspberryPi(MainWindow* w, piConfig config, QString project_argv, QTreeWidgetItem* item, QTextEdit* te_output);
+    RaspberryPi(MainWindow* w, piConfig config, QString project_argv, QMap<QString, QString> project_options, QTreeWidgetItem* item, QTextEdit* te_output);
 
     // Destructor
     ~RaspberryPi();
@@ -52,9 +55,21 @@ public:
     // Saves the arguments of the Raspberry Pi
     QString argv;
 
+    // A map for the options of the Raspberry Pi from the testbed configuration
+    QMap<QString, QString> piOptions;
+
+    // Saves the options of the project combined with the options of the Raspberry Pi, passed to the SSH executable
+    QMap<QString, QString> options;
+
     // Save the last error message
     QString error = "";
 
+    // The fingerprint (see the fingerprint command) read when the Raspberry Pi came online, empty if unknown
+    QString fingerprint = "";
+
+    // Set by MainWindow to abort the running build, read by the SSHaction thread while it waits for the build
+    std::atomic<bool> abortBuild = false;
+
     // Save the current status, initialize with checking
     piStatus status = piStatus::checking;
 
@@ -73,6 +88,12 @@ public:
     /// <param name="project_argv">The arguments of the project which may include meta parameters</param>
     void calc_argv(QString project_argv);
 
+    /// <summary>
+    /// Calculate the options from the options of the project and the Raspberry Pi, the latter take precedence
+    /// </summary>
+    /// <param name="project_options">The further options of the project (e.g., workspace)</param>
+    void calc_options(QMap<QString, QString> project_options);
+
 private:
     // Pointers to the different SSH sub-classes
     SSHaction* sshAction;
@@ -88,7 +109,8 @@ signals:
     /// <summary>
     /// Check the status of the Raspberry Pi, signal to SSHstatus
     /// </summary>
-    void SSHgetStatus();
+    /// <param name="withOutput">If true, the last output of the application is read within the same round trip</param>
+    void SSHgetStatus(bool withOutput);
 
     /// <summary>
     /// Save the project of the Raspberry Pi, signal to SSHaction
@@ -96,15 +118,58 @@ signals:
     /// <param name="path2project">Path to the project folder on the disk</param>
     void SSHsave(QString path2project);
 
+    /// <summary>
+    /// Sync the project of the Raspberry Pi and relay it from there to other Raspberry Pis, signal to SSHaction
+    /// </summary>
+    /// <param name="path2project">Path to the project folder on the disk</param>
+    /// <param name="targets">Addresses of the Raspberry Pis which receive the project from this one</param>
+    void SSHrelay(QString path2project, QStringList targets);
+
+    /// <summary>
+    /// Sync and build the project of the Raspberry Pi as a new release while the application keeps running, then restart it, signal to SSHaction
+    /// </summary>
+    /// <param name="path2project">Path to the project folder on the disk</param>
+    void SSHrelease(QString path2project);
+
     /// <summary>
     /// Compile the project of the Raspberry Pi, signal to SSHaction
     /// </summary>
-    void SSHcompile();
+    /// <param name="rebuild">If true, the project is built even if its sources haven't changed since the last build</param>
+    /// <param name="helpers">Addresses of the idle Raspberry Pis to which the compile jobs are distributed, empty to build alone</param>
+    void SSHcompile(bool rebuild, QStringList helpers);
+
+    /// <summary>
+    /// Compile the project of the Raspberry Pi and copy the binary to other Raspberry Pis with the same fingerprint, signal to SSHaction
+    /// </summary>
+    /// <param name="rebuild">If true, the project is built even if its sources haven't changed since the last build</param>
+    /// <param name="targets">Addresses of the Raspberry Pis which receive the binary from this one</param>
+    /// <param name="helpers">Addresses of the idle Raspberry Pis to which the compile jobs are distributed, empty to build alone</param>
+    void SSHcompileShare(bool rebuild, QStringList targets, QStringList helpers);
+
+    /// <summary>
+    /// Collect the results of the project from the Raspberry Pi, signal to SSHaction
+    /// </summary>
+    /// <param name="localDir">Local folder in which the results are saved</param>
+    void SSHcollect(QString localDir);
+
+    /// <summary>
+    /// Run the pipeline of the project on the Raspberry Pi and on other ones, signal to SSHaction
+    /// </summary>
+    /// <param name="path2project">Path to the project folder on the disk</param>
+    /// <param name="pis">Addresses of the other Raspberry Pis on which the stages run as well</param>
+    void SSHpipeline(QString path2project, QStringList pis);
+
+    /// <summary>
+    /// Sync the changed files of the project, rebuild it, and restart the application, signal to SSHaction
+    /// </summary>
+    /// <param name="path2project">Path to the project folder on the disk</param>
+    void SSHupdate(QString path2project);
 
     /// <summary>
     /// Start the project of the Raspberry Pi, signal to SSHaction
     /// </summary>
-    void SSHstart();
+    /// <param name="startAt">Time (milliseconds since the Unix epoch) at which the application should be started, 0 to start immediately</param>
+    void SSHstart(qint64 startAt);
 
     /// <summary>
     /// Stop the project of the Raspberry Pi, signal to SSHaction
@@ -140,6 +205,11 @@ public slots:
     /// </summary>
     void clear();
 
+    /// <summary>
+    /// Checks the status of the Raspberry Pi, also reads the last output if it was offline or unchecked until now
+    /// </summary>
+    void checkStatus();
+
     /// <summary>
     /// Sent after the status of the Raspberry Pi has been checked, response from RaspberryPi
     /// </summary>
@@ -147,4 +217,10 @@ public slots:
     /// <param name="error">The error message, if the Raspberry Pi is offline, else empty</param>
     void SSHgetStatus_finished(piStatus status, QByteArray error);
 
+    /// <summary>
+    /// Sent after the fingerprint of the Raspberry Pi has been read, response from SSHstatus
+    /// </summary>
+    /// <param name="fingerprint">Fingerprint of the Raspberry Pi</param>
+    void SSHfingerprint_finished(QString fingerprint);
+
 };
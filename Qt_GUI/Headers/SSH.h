@@ -24,14 +24,33 @@ protected:
 	// Pointer to a RaspberryPi object
 	RaspberryPi* pi;
 
+	/// <summary>
+	/// Creates the parameters for the SSH executable i.e., the options, address, operation, and project name of the Raspberry Pi
+	/// </summary>
+	/// <param name="operation">Operation be executed (e.g. "save", "compile", ...)</param>
+	/// <param name="options">Optional, further options (--key=value) for this operation only</param>
+	/// <returns>The list of parameters, further arguments may be appended</returns>
+	QStringList createParams(QString operation, QStringList options = {});
+
 	/// <summary>
 	/// Execute an operation the Raspberry Pi project through the SSH executable
 	/// </summary>
 	/// <param name="process">Pointer to a newly created QProcess object. Can be used to retreive the exit code or output</param>
 	/// <param name="operation">Operation be executed (e.g. "save", "compile", ...)</param>
 	/// <param name="args">Optional, arguments to be passed (default: "")</param>
+	/// <param name="options">Optional, further options (--key=value) for this operation only</param>
 	/// <returns>true if the SSH executable was started successfully, false otherwise</returns>
-	bool execSSHexe(QProcess* process, QString operation, QString args = "");
+	bool execSSHexe(QProcess* process, QString operation, QString args = "", QStringList options = {});
+
+	/// <summary>
+	/// Execute an operation the Raspberry Pi project through the SSH executable with multiple arguments
+	/// </summary>
+	/// <param name="process">Pointer to a newly created QProcess object. Can be used to retreive the exit code or output</param>
+	/// <param name="operation">Operation be executed (e.g. "update", ...)</param>
+	/// <param name="args">Arguments to be passed, each as a separate parameter</param>
+	/// <param name="options">Optional, further options (--key=value) for this operation only</param>
+	/// <returns>true if the SSH executable was started successfully, false otherwise</returns>
+	bool execSSHexe(QProcess* process, QString operation, QStringList args, QStringList options = {});
 
 signals:
 	/// <summary>
@@ -41,6 +60,19 @@ signals:
 	/// <param name="success">The error message, if the Raspberry Pi is offline, else empty</param>
 	void SSHcurrStatus(piStatus status, QByteArray error = "");
 
+	/// <summary>
+	/// Sent after output has been read from the project, response to MainWindow
+	/// </summary>
+	/// <param name="pi">Pointer to the RaspberryPi object</param>
+	/// <param name="output">Output from the project</param>
+	void SSHreadOutput_finished(RaspberryPi* pi, QByteArray output);
+
+	/// <summary>
+	/// Sent after the fingerprint of the Raspberry Pi has been read, Raspberry Pis with the same fingerprint build the same binary
+	/// </summary>
+	/// <param name="fingerprint">Fingerprint of the Raspberry Pi</param>
+	void SSHfingerprint_finished(QString fingerprint);
+
 };
 
 /// <summary>
@@ -53,6 +85,25 @@ class SSHaction : public SSH {
 	// Use the base constructor
 	using SSH::SSH;
 
+private:
+	/// <summary>
+	/// Execute an operation and send its output line by line with SSHstream_output while it's running (e.g., compile).
+	/// If abortBuild of the Raspberry Pi is set meanwhile, the SSH executable is asked to abort the build
+	/// </summary>
+	/// <param name="process">Pointer to a newly created QProcess object. Can be used to retreive the exit code</param>
+	/// <param name="operation">The operation to execute</param>
+	/// <param name="args">Additional arguments of the operation</param>
+	/// <param name="options">Further options (--key=value) for the operation</param>
+	/// <returns>true if the SSH executable was started successfully, false otherwise</returns>
+	bool execStreamed(QProcess* process, QString operation, QStringList args, QStringList options);
+
+	/// <summary>
+	/// Execute the update operation (sync, build, and restart the application) and send its result with the given signal
+	/// </summary>
+	/// <param name="path2project">Path to the project folder on the disk</param>
+	/// <param name="finished">Signal which is sent after the operation, SSHsave_finished (release) or SSHupdate_finished (watch mode)</param>
+	void update(QString path2project, void (SSHaction::*finished)(RaspberryPi*, bool, QByteArray));
+
 public slots:
 	/// <summary>
 	/// Save the project of the Raspberry Pi, request from MainWindow
@@ -60,21 +111,66 @@ public slots:
 	/// <param name="path2project">Path to the project folder on the disk</param>
 	void SSHsave(QString path2project);
 
+	/// <summary>
+	/// Sync the project of the Raspberry Pi and relay it from there to other Raspberry Pis, request from MainWindow, answered with SSHrelay_finished
+	/// </summary>
+	/// <param name="path2project">Path to the project folder on the disk</param>
+	/// <param name="targets">Addresses of the Raspberry Pis which receive the project from this one</param>
+	void SSHrelay(QString path2project, QStringList targets);
+
+	/// <summary>
+	/// Sync and build the project of the Raspberry Pi as a new release while the application keeps running, then restart it, request from MainWindow,
+	/// answered with SSHsave_finished
+	/// </summary>
+	/// <param name="path2project">Path to the project folder on the disk</param>
+	void SSHrelease(QString path2project);
+
 	/// <summary>
 	/// Compile the project of the Raspberry Pi, request from MainWindow
 	/// </summary>
-	void SSHcompile();
+	/// <param name="rebuild">If true, the project is built even if its sources haven't changed since the last build</param>
+	/// <param name="helpers">Addresses of the idle Raspberry Pis to which the compile jobs are distributed, empty to build alone</param>
+	void SSHcompile(bool rebuild, QStringList helpers);
+
+	/// <summary>
+	/// Compile the project of the Raspberry Pi and copy the binary to other Raspberry Pis with the same fingerprint, request from MainWindow,
+	/// answered with SSHcompileShare_finished
+	/// </summary>
+	/// <param name="rebuild">If true, the project is built even if its sources haven't changed since the last build</param>
+	/// <param name="targets">Addresses of the Raspberry Pis which receive the binary from this one</param>
+	/// <param name="helpers">Addresses of the idle Raspberry Pis to which the compile jobs are distributed, empty to build alone</param>
+	void SSHcompileShare(bool rebuild, QStringList targets, QStringList helpers);
 
 	/// <summary>
 	/// Start the project of the Raspberry Pi, request from MainWindow
 	/// </summary>
-	void SSHstart();
+	/// <param name="startAt">Time (milliseconds since the Unix epoch) at which the application should be started, 0 to start immediately</param>
+	void SSHstart(qint64 startAt);
 
 	/// <summary>
 	/// Stop the project of the Raspberry Pi, request from MainWindow
 	/// </summary>
 	void SSHstop();
 
+	/// <summary>
+	/// Collect the results of the project from the Raspberry Pi, request from MainWindow
+	/// </summary>
+	/// <param name="localDir">Local folder in which the results are saved</param>
+	void SSHcollect(QString localDir);
+
+	/// <summary>
+	/// Run the pipeline of the project (the stages of its config.txt) on this and other Raspberry Pis, request from MainWindow
+	/// </summary>
+	/// <param name="path2project">Path to the project folder on the disk</param>
+	/// <param name="pis">Addresses of the other Raspberry Pis on which the stages run as well</param>
+	void SSHpipeline(QString path2project, QStringList pis);
+
+	/// <summary>
+	/// Sync the changed files of the project, rebuild it, and restart the application on the Raspberry Pi, request from MainWindow (watch mode)
+	/// </summary>
+	/// <param name="path2project">Path to the project folder on the disk</param>
+	void SSHupdate(QString path2project);
+
 signals:
 	/// <summary>
 	/// Sent after the project has been saved, response to MainWindow
@@ -84,14 +180,41 @@ signals:
 	/// <param name="output">Output from the SSH executable</param>
 	void SSHsave_finished(RaspberryPi* pi, bool success, QByteArray output);
 
+	/// <summary>
+	/// Sent after the project has been synced and relayed to other Raspberry Pis, response to MainWindow
+	/// </summary>
+	/// <param name="pi">Pointer to the RaspberryPi object</param>
+	/// <param name="success">true, if the project was synced and relayed to all targets, else false</param>
+	/// <param name="output">Output from the SSH executable, including the result of every target</param>
+	/// <param name="targets">Addresses of all targets of the relay</param>
+	/// <param name="unrelayed">Addresses of the targets which didn't receive the project, they save it themselves</param>
+	void SSHrelay_finished(RaspberryPi* pi, bool success, QByteArray output, QStringList targets, QStringList unrelayed);
+
+	/// <summary>
+	/// Sent while the project is compiled or its pipeline runs whenever the SSH executable printed new lines, response to MainWindow
+	/// </summary>
+	/// <param name="pi">Pointer to the RaspberryPi object</param>
+	/// <param name="output">The new complete lines from stdout and stderr of the SSH executable</param>
+	void SSHstream_output(RaspberryPi* pi, QByteArray output);
+
 	/// <summary>
 	/// Sent after the project has been compiled, response to MainWindow
 	/// </summary>
 	/// <param name="pi">Pointer to the RaspberryPi object</param>
 	/// <param name="success">true, if the project was compiled successfully, else false</param>
-	/// <param name="output">Output from the SSH executable</param>
+	/// <param name="output">Output from the SSH executable which wasn't sent with SSHstream_output yet</param>
 	void SSHcompile_finished(RaspberryPi* pi, bool success, QByteArray output);
 
+	/// <summary>
+	/// Sent after the project has been compiled and its binary copied to other Raspberry Pis, response to MainWindow
+	/// </summary>
+	/// <param name="pi">Pointer to the RaspberryPi object</param>
+	/// <param name="success">true, if the project was compiled successfully, else false</param>
+	/// <param name="output">Output from the SSH executable, including the result of every target</param>
+	/// <param name="unshared">Addresses of the targets which didn't receive the binary (e.g., because their sources differ)</param>
+	/// <param name="rebuild">The rebuild flag of the request, passed on to the targets which build the project themselves</param>
+	void SSHcompileShare_finished(RaspberryPi* pi, bool success, QByteArray output, QStringList unshared, bool rebuild);
+
 	/// <summary>
 	/// Sent after the project has been started, response to MainWindow
 	/// </summary>
@@ -108,6 +231,30 @@ signals:
 	/// <param name="output">Output from the SSH executable</param>
 	void SSHstop_finished(RaspberryPi* pi, bool success, QByteArray output);
 
+	/// <summary>
+	/// Sent after the results have been collected, response to MainWindow
+	/// </summary>
+	/// <param name="pi">Pointer to the RaspberryPi object</param>
+	/// <param name="success">true, if all results were collected successfully, else false</param>
+	/// <param name="output">Output from the SSH executable</param>
+	void SSHcollect_finished(RaspberryPi* pi, bool success, QByteArray output);
+
+	/// <summary>
+	/// Sent after the pipeline of the project has run, response to MainWindow
+	/// </summary>
+	/// <param name="pi">Pointer to the RaspberryPi object</param>
+	/// <param name="success">true, if all stages succeeded, else false</param>
+	/// <param name="output">Output from the SSH executable which wasn't sent with SSHstream_output yet</param>
+	void SSHpipeline_finished(RaspberryPi* pi, bool success, QByteArray output);
+
+	/// <summary>
+	/// Sent after the project has been synced, rebuilt, and restarted, response to MainWindow
+	/// </summary>
+	/// <param name="pi">Pointer to the RaspberryPi object</param>
+	/// <param name="success">true, if the application is running the changed project, else false</param>
+	/// <param name="output">Output from the SSH executable</param>
+	void SSHupdate_finished(RaspberryPi* pi, bool success, QByteArray output);
+
 };
 
 /// <summary>
@@ -124,7 +271,8 @@ public slots:
 	/// <summary>
 	/// Check the status of the Raspberry Pi, request from RaspberryPi
 	/// </summary>
-	void SSHgetStatus();
+	/// <param name="withOutput">If true, the last output of the application is read within the same round trip if it isn't running</param>
+	void SSHgetStatus(bool withOutput);
 
 };
 
@@ -170,12 +318,4 @@ private slots:
 	/// </summary>
 	void process_finished(int exitCode);
 
-signals:
-	/// <summary>
-	/// Sent after output has been read from the project, response to MainWindow
-	/// </summary>
-	/// <param name="pi">Pointer to the RaspberryPi object</param>
-	/// <param name="output">Output from the project</param>
-	void SSHreadOutput_finished(RaspberryPi* pi, QByteArray output);
-
 };
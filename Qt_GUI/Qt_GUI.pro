@@ -1,7 +1,8 @@
 QT += core gui widgets
 
-HEADERS += Headers/MainWindow.h Headers/qtreewidgetpis.h Headers/RaspberryPi.h Headers/SSH.h
-SOURCES += Sources/MainWindow.cpp Sources/qtreewidgetpis.cpp Sources/RaspberryPi.cpp Sources/SSH.cpp Sources/main.cpp
+HEADERS += Headers/MainWindow.h Headers/qtreewidgetpis.h Headers/RaspberryPi.h Headers/SSH.h ../SSH/DeployIgnore.h
+SOURCES += Sources/MainWindow.cpp Sources/qtreewidgetpis.cpp Sources/RaspberryPi.cpp Sources/SSH.cpp Sources/main.cpp ../SSH/DeployIgnore.cpp
+INCLUDEPATH += ../SSH
 FORMS   += MainWindow.ui
 
 UI_DIR = Headers
@@ -1,11 +1,32 @@
 #include "MainWindow.h"
 #include "RaspberryPi.h"
 
+#include <QApplication>
+#include <QDateTime>
 #include <QDesktopServices>
+#include <QDir>
+#include <QFileDialog>
+#include <QFileInfo>
 #include <QMessageBox>
 #include <QScrollBar>
 #include <QTextStream>
 
+// Milliseconds between clicking start and the synchronized start of the applications on multiple Raspberry Pis
+#define SYNC_START_DELAY 3000
+
+// Milliseconds without further changes of a watched project before it is updated, an editor or build tool often writes several files at once
+#define WATCH_DEBOUNCE 300
+
+// Minimum number of Raspberry Pis of a project for a relay (option relay), the project is sent to RELAY_PIS_PER_SEED of them at most (the seeds)
+// which forward it to the others
+#define RELAY_MIN_PIS 4
+#define RELAY_PIS_PER_SEED 8
+
+// Folder inside the temporary folder in which the SSH executables save the current rates of their transfers (see option bandwidth),
+// and milliseconds between two updates of the shown rates, older rates belong to finished transfers
+#define RATE_FOLDER "pideploy-bandwidth"
+#define RATE_INTERVAL 1000
+
 MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
     ui.setupUi(this);
 
@@ -21,6 +42,9 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
     connect(ui.btn_start, &QPushButton::clicked, this, &MainWindow::btn_start_clicked);
     connect(ui.btn_stop, &QPushButton::clicked, this, &MainWindow::btn_stop_clicked);
     connect(ui.btn_refresh, &QPushButton::clicked, this, &MainWindow::btn_refresh_clicked);
+    connect(ui.btn_collect, &QPushButton::clicked, this, &MainWindow::btn_collect_clicked);
+    connect(ui.btn_pipeline, &QPushButton::clicked, this, &MainWindow::btn_pipeline_clicked);
+    connect(ui.btn_watch, &QPushButton::toggled, this, &MainWindow::btn_watch_toggled);
     connect(ui.btn_collapse, &QPushButton::clicked, ui.tv_files, &QTreeView::collapseAll);
     connect(ui.chbx_selectAll, &QCheckBox::clicked, this, &MainWindow::chbx_selectAll_stateChanged);
 
@@ -32,6 +56,15 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
     // Connect the double-clicked signals of the QTreeView to the corresponding slots
     connect(ui.tv_files, &QTreeView::doubleClicked, this, &MainWindow::tv_files_doubleClicked);
 
+    // Create the watcher for the watch mode, only folders are watched (e.g., new, removed, renamed, or replaced files)
+    watcher = new QFileSystemWatcher(this);
+    connect(watcher, &QFileSystemWatcher::directoryChanged, this, &MainWindow::watcher_pathChanged);
+
+    // Show the current transfer rates periodically
+    rateTimer = new QTimer(this);
+    connect(rateTimer, &QTimer::timeout, this, &MainWindow::show_rates);
+    rateTimer->start(RATE_INTERVAL);
+
     // If new output is available inside the info ListWidget scroll to bottom
     connect(ui.lw_infoOutput->model(), &QAbstractItemModel::rowsInserted, ui.lw_infoOutput, &QListWidget::scrollToBottom);
 
@@ -121,6 +154,9 @@ QList<piConfig> MainWindow::readConfig() {
                                 pi.args[argSplit.at(0)] = argSplit.at(1);
                         }
                     }
+                    else
+                        // Save every other property as an option of the Raspberry Pi
+                        pi.options[prop] = split.at(1);
                 }
 
                 // Read the next line
@@ -135,11 +171,15 @@ QList<piConfig> MainWindow::readConfig() {
             QStringList split = line.split('=');
 
             // If there is only a property and a value
-            if (split.length() == 2)
+            if (split.length() == 2) {
                 // If the property is the project path
                 if (split.at(0) == "projectsPath")
                     // Save the project path
                     projectsPath = split.at(1);
+                else
+                    // Save every other property as a global option (e.g., ignore), overridden by the project and the Raspberry Pi
+                    globalOptions[split.at(0)] = split.at(1);
+            }
         }
     }
 
@@ -171,8 +211,8 @@ bool MainWindow::read_argv(QString projectName, QString projectPath) {
         // Read the next line
         QString line = in.readLine();
 
-        // Ignore comments
-        if (line.startsWith('#'))
+        // Ignore comments and the stages of the pipeline, they are read by the SSH executable
+        if (line.startsWith('#') || line.startsWith("stage."))
             continue;
 
         // Read the next line and split it at the equal sign to get property and value
@@ -187,6 +227,9 @@ bool MainWindow::read_argv(QString projectName, QString projectPath) {
             if (prop == "argv")
                 // Save the argument line of the project
                 projects_argv[projectName] = split.at(1);
+            else
+                // Save every other property as an option of the project
+                projects_options[projectName][prop] = split.at(1);
         }
     }
 
@@ -246,7 +289,8 @@ QMap<QString, QTreeWidgetItem*> MainWindow::getProjects() {
         // Save the QTreeWidgetItem inside the map
         projects[projectName] = item;
 
-        // Get the argument line of the project
+        // Start with the global options, then get the argument line and options of the project
+        projects_options[projectName] = globalOptions;
         read_argv(projectName, projectPath);
     }
 
@@ -354,7 +398,7 @@ void MainWindow::create_piNodes(QList<piConfig> pi_configs, QMap<QString, QTreeW
         ui.tabW_appOutput->addTab(te_appOutput, pi_config.name);
 
         // Create a new RaspberryPi object and add it to the list of Raspberry Pis
-        RaspberryPi* pi = new RaspberryPi(this, pi_config, projects_argv[pi_config.project], item, te_appOutput);
+        RaspberryPi* pi = new RaspberryPi(this, pi_config, projects_argv[pi_config.project], projects_options[pi_config.project], item, te_appOutput);
         pis.push_back(pi);
 
         // Map the QTreeWidgetItem and QTextEdit to the RaspberryPi object
@@ -394,6 +438,10 @@ void MainWindow::writeConfig() {
     // Write the projectsPath to the file
     out << "projectsPath=" << projectsPath << '\n';
 
+    // Write the global options to the file
+    for (QString key : globalOptions.keys())
+        out << key << '=' << globalOptions[key] << '\n';
+
     // Iterate through all Raspberry Pis
     for (RaspberryPi* pi : pis) {
         // Write the name, address, and project to the file
@@ -416,6 +464,10 @@ void MainWindow::writeConfig() {
         }
 
         out << '\n';
+
+        // Write the options of the Raspberry Pi to the file
+        for (QString key : pi->piOptions.keys())
+            out << key << '=' << pi->piOptions[key] << '\n';
     }
 
     // Close the file
@@ -428,7 +480,140 @@ void MainWindow::btns_setEnabled(bool enable) {
     ui.btn_compile->setEnabled(enable);
     ui.btn_start->setEnabled(enable);
     ui.btn_stop->setEnabled(enable);
-    ui.btn_refresh->setEnabled(enable);
+    ui.btn_collect->setEnabled(enable);
+    ui.btn_watch->setEnabled(enable);
+    ui.btn_pipeline->setEnabled(enable);
+
+    // The Raspberry Pis can't be refreshed (i.e., deleted) in watch mode or while they are updated
+    ui.btn_refresh->setEnabled(enable && !ui.btn_watch->isChecked() && watchBusy.isEmpty());
+}
+
+void MainWindow::watch_addPaths(QString project) {
+    QString projectPath = QString("%1/%2").arg(projectsPath, project);
+
+    // (Re)load the ignore patterns the same way as the SSH executable: the option ignore first, then the .deployignore of the project
+    DeployIgnore ignore;
+    for (QString pattern : projects_options[project].value("ignore").split(','))
+        ignore.add(pattern.toStdString());
+
+    ignore.load(QString("%1/%2").arg(projectPath, DEPLOY_IGNORE_FILE).toStdString());
+    watchIgnore[project] = ignore;
+
+    // Collect the project folder and all of its subfolders which aren't ignored. Only folders are watched, a folder watch reports
+    // the changes of the files inside it, and ignored folders (e.g., build outputs) aren't descended into
+    QStringList folders = { projectPath };
+    for (int i = 0; i < folders.size(); i++)
+        for (QFileInfo info : QDir(folders[i]).entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System | QDir::NoSymLinks))
+            if (!watch_ignored(project, info.absoluteFilePath()))
+                folders << info.absoluteFilePath();
+
+    // Save the entries of the folders, so that changes of ignored entries can be told apart
+    for (QString folder : folders)
+        watchEntries[folder] = watch_entries(project, folder);
+
+    // Folders which are already watched
+    QStringList watchedList = watcher->directories();
+    QSet<QString> watched(watchedList.begin(), watchedList.end());
+
+    // Only add the new folders
+    QStringList newFolders;
+    for (QString folder : folders)
+        if (!watched.contains(folder))
+            newFolders << folder;
+
+    if (!newFolders.isEmpty())
+        watcher->addPaths(newFolders);
+}
+
+bool MainWindow::watch_ignored(QString project, QString path) {
+    // Get the path relative to the project folder, the patterns are relative to it
+    QString relativePath = QDir(QString("%1/%2").arg(projectsPath, project)).relativeFilePath(path);
+    if (relativePath == "." || relativePath.startsWith(".."))
+        return false;
+
+    const DeployIgnore& ignore = watchIgnore[project];
+    if (ignore.empty())
+        return false;
+
+    // Check the parent folders first, the files inside an ignored folder are ignored as well
+    QStringList parts = relativePath.split('/');
+    for (int i = 1; i < parts.size(); i++)
+        if (ignore.ignored(parts.mid(0, i).join('/').toStdString(), true))
+            return true;
+
+    return ignore.ignored(relativePath.toStdString(), QFileInfo(path).isDir());
+}
+
+QMap<QString, qint64> MainWindow::watch_entries(QString project, QString folder) {
+    QMap<QString, qint64> entries;
+
+    // Collect the names and modification times of all entries (including hidden ones) which aren't ignored
+    for (QFileInfo info : QDir(folder).entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System))
+        if (!watch_ignored(project, info.absoluteFilePath()))
+            entries[info.fileName()] = info.lastModified().toMSecsSinceEpoch();
+
+    return entries;
+}
+
+void MainWindow::watch_update(QString project) {
+    // Take the time of the first change since the last update
+    qint64 firstChange = watchFirstChange.take(project);
+
+    // Ignore a timer which expired right after the watch mode was stopped
+    if (!ui.btn_watch->isChecked())
+        return;
+
+    // Watch new folders and files of the project
+    watch_addPaths(project);
+
+    // Iterate through all watched Raspberry Pis of the project
+    for (RaspberryPi* pi : watchPis) {
+        // Only update Raspberry Pis which are online, the application may be running or not
+        if (pi->project != project || (pi->status != piStatus::online && pi->status != piStatus::appRunning))
+            continue;
+
+        // If the Raspberry Pi is still updated, update it once more afterwards (keep the time of the earliest change which isn't applied yet)
+        if (watchBusy.contains(pi)) {
+            if (!watchPending.contains(pi))
+                watchPending[pi] = firstChange;
+
+            continue;
+        }
+
+        // Signal to sync, rebuild, and restart the project of the Raspberry Pi, save the time of the change to report the latency
+        watchBusy[pi] = firstChange;
+        pi->SSHupdate(projectsPath);
+    }
+
+    // The Raspberry Pis can't be refreshed while they are updated
+    if (!watchBusy.isEmpty())
+        ui.btn_refresh->setEnabled(false);
+}
+
+void MainWindow::show_rates() {
+    QDir folder(QDir(QDir::tempPath()).filePath(RATE_FOLDER));
+
+    // Iterate through all Raspberry Pis
+    for (RaspberryPi* pi : pis) {
+        QString text = QString("%1 | %2").arg(pi->addr, pi->name);
+
+        // The rate file is named after the address and the port unless it is 22, characters which can't be part of a file name are replaced
+        QString name = pi->addr;
+        if (name.endsWith(":22"))
+            name.chop(3);
+        QFileInfo info(folder.filePath(name.replace('/', '_').replace('\\', '_').replace(':', '_') + ".rate"));
+
+        // If a transfer to the Raspberry Pi is running, append its rate to the text of its item
+        if (info.exists() && info.lastModified().msecsTo(QDateTime::currentDateTime()) < RATE_INTERVAL) {
+            QFile file(info.filePath());
+            if (file.open(QIODevice::ReadOnly))
+                text.append(QString(" | %1/s").arg(locale().formattedDataSize(file.readLine().trimmed().toLongLong())));
+        }
+
+        // Only change the text if needed, a change is signaled as itemChanged
+        if (pi->item->text(0) != text)
+            pi->item->setText(0, text);
+    }
 }
 
 void MainWindow::btn_save_clicked() {
@@ -438,6 +623,9 @@ void MainWindow::btn_save_clicked() {
     // Create an empty string for possible warnings
     QString warnings = "";
 
+    // Maps the projects (and workspaces) to the online Raspberry Pis which receive them through a relay
+    QMap<QString, QList<RaspberryPi*>> relayPis;
+
     // Iterate through all Raspberry Pis
     for (RaspberryPi* pi : pis) {
         // If the checkbox of the Raspberry Pi QTreeWidgetItem is checked
@@ -448,6 +636,12 @@ void MainWindow::btn_save_clicked() {
             switch (pi->status) {
                 // If the Raspberry Pi is online and the application isn't running on it
                 case piStatus::online:
+                    // If the project should be relayed, save it after all Raspberry Pis of the project are known
+                    if (pi->options.value("relay") == "yes") {
+                        relayPis[pi->project + "\n" + pi->options.value("workspace")].append(pi);
+                        break;
+                    }
+
                     // Signal to save the project of the Raspberry Pi
                     pi->SSHsave(projectsPath);
 
@@ -464,6 +658,13 @@ void MainWindow::btn_save_clicked() {
 
                 // If the application is currently running on the Raspberry
                 case piStatus::appRunning:
+                    // With releases, the project is synced and built next to the running application, which is only restarted afterwards
+                    if (pi->options.value("releases", "0").toInt() > 0) {
+                        pi->SSHrelease(projectsPath);
+                        busyPiCount++;
+                        break;
+                    }
+
                     // Show a warning that the application is running on the Raspberry Pi
                     warnings.append(QString("An application is running on %1.\n").arg(pi->name));
                     break;
@@ -477,6 +678,32 @@ void MainWindow::btn_save_clicked() {
         }
     }
 
+    // Iterate through the Raspberry Pis of every relayed project
+    for (QList<RaspberryPi*> group : relayPis) {
+        // Few Raspberry Pis save the project themselves
+        if (group.size() < RELAY_MIN_PIS) {
+            for (RaspberryPi* pi : group) {
+                pi->SSHsave(projectsPath);
+                busyPiCount++;
+            }
+
+            continue;
+        }
+
+        // The project is sent to the seeds, the other Raspberry Pis are distributed evenly among them
+        qsizetype seeds = (group.size() + RELAY_PIS_PER_SEED - 1) / RELAY_PIS_PER_SEED;
+        QList<QStringList> targets(seeds);
+        for (qsizetype i = seeds; i < group.size(); i++)
+            targets[i % seeds].append(group[i]->addr);
+
+        // Signal to relay the project through every seed, its output contains the result of its targets.
+        // The targets are busy as well until the relay has finished
+        for (qsizetype i = 0; i < seeds; i++) {
+            group[i]->SSHrelay(projectsPath, targets[i]);
+            busyPiCount += 1 + targets[i].size();
+        }
+    }
+
     // Check if at least one Raspberry Pi has been selected
     if (!noPiSelected) {
         // Check if the saving operation is executed on at least one Raspberry Pi 
@@ -499,12 +726,34 @@ void MainWindow::btn_save_clicked() {
 }
 
 void MainWindow::btn_compile_clicked() {
+    // If a build is running, the button aborts it on all Raspberry Pis
+    if (building) {
+        // The SSHaction threads ask their SSH executables to stop the build
+        for (RaspberryPi* pi : pis)
+            pi->abortBuild = true;
+
+        // Don't abort twice, the button is re-enabled when the build has finished
+        ui.btn_compile->setEnabled(false);
+        ui.lw_infoOutput->addItem("### Aborting build ###\n");
+        return;
+    }
+
+    // Reset the abort flags of the last build
+    for (RaspberryPi* pi : pis)
+        pi->abortBuild = false;
+
     // Indicates that no Raspberry Pi has been selected from the QTreeWidget
     bool noPiSelected = true;
 
     // Create an empty string for possible warnings
     QString warnings = "";
 
+    // A click with the Shift key builds the projects even if their sources haven't changed since the last build
+    bool rebuild = QApplication::keyboardModifiers() & Qt::ShiftModifier;
+
+    // Maps the projects (and workspaces) and fingerprints to the online Raspberry Pis which build the same binary
+    QMap<QString, QList<RaspberryPi*>> fingerprintPis;
+
     // Iterate through all Raspberry Pis
     for (RaspberryPi* pi : pis) {
         // If the checkbox of the Raspberry Pi QTreeWidgetItem is checked
@@ -515,8 +764,14 @@ void MainWindow::btn_compile_clicked() {
             switch (pi->status) {
                 // If the Raspberry Pi is online and the application isn't running on it
                 case piStatus::online:
+                    // If the fingerprint is known, build the project after all Raspberry Pis with the same fingerprint are known
+                    if (!pi->fingerprint.isEmpty()) {
+                        fingerprintPis[pi->project + "\n" + pi->options.value("workspace") + "\n" + pi->fingerprint].append(pi);
+                        break;
+                    }
+
                     // Signal to build the project of the Raspberry Pi
-                    pi->SSHcompile();
+                    pi->SSHcompile(rebuild, QStringList());
 
                     // Increment the busy Raspberry Pi count
                     busyPiCount++;
@@ -544,6 +799,34 @@ void MainWindow::btn_compile_clicked() {
         }
     }
 
+    // The first Raspberry Pi with the same project and fingerprint builds the project, the others only receive the binary
+    QList<RaspberryPi*> builders;
+    for (QList<RaspberryPi*> group : fingerprintPis)
+        builders.append(group[0]);
+
+    // Iterate through the Raspberry Pis with the same project and fingerprint
+    for (QList<RaspberryPi*> group : fingerprintPis) {
+        // The first Raspberry Pi builds the project and copies the binary to the others, its output contains the result of every target
+        QStringList targets;
+        for (qsizetype i = 1; i < group.size(); i++)
+            targets.append(group[i]->addr);
+
+        // With the option distribute, the idle Raspberry Pis with the same fingerprint (no application running, not building themselves)
+        // compile jobs of the build, the SSH executable only uses those with free CPUs
+        QStringList helpers;
+        if (group[0]->options.value("distribute") == "yes")
+            for (RaspberryPi* helper : pis)
+                if (helper->status == piStatus::online && helper->fingerprint == group[0]->fingerprint && !builders.contains(helper))
+                    helpers.append(helper->addr);
+
+        if (targets.isEmpty())
+            group[0]->SSHcompile(rebuild, helpers);
+        else
+            group[0]->SSHcompileShare(rebuild, targets, helpers);
+
+        busyPiCount++;
+    }
+
     // Check if at least one Raspberry Pi has been selected
     if (!noPiSelected) {
         // Check if the building operation is executed on at least one Raspberry Pi 
@@ -551,6 +834,11 @@ void MainWindow::btn_compile_clicked() {
             // Disable all buttons of the application to not allow another operation during the current building
             btns_setEnabled(false);
 
+            // Except for the build button which aborts the build meanwhile
+            building = true;
+            ui.btn_compile->setText("Abort Build");
+            ui.btn_compile->setEnabled(true);
+
             // Show that the building operation has been started
             ui.lw_infoOutput->addItem("### Build started ###\n");
         }
@@ -572,6 +860,9 @@ void MainWindow::btn_start_clicked() {
     // Create an empty string for possible warnings
     QString warnings = "";
 
+    // Raspberry Pis on which the project will be started
+    QList<RaspberryPi*> startPis;
+
     // Iterate through all Raspberry Pis
     for (RaspberryPi* pi : pis) {
         // If the checkbox of the Raspberry Pi QTreeWidgetItem is checked
@@ -582,12 +873,8 @@ void MainWindow::btn_start_clicked() {
             switch (pi->status) {
                 // If the Raspberry Pi is online and the application isn't running on it
                 case piStatus::online:
-                    // Signal to start the project of the Raspberry Pi
-                    pi->SSHstart();
-
-                    // Increment the busy Raspberry Pi count
-                    busyPiCount++;
-
+                    // Start the project of the Raspberry Pi after the loop
+                    startPis.append(pi);
                     break;
 
                 // If the Raspberry Pi is offline
@@ -611,6 +898,19 @@ void MainWindow::btn_start_clicked() {
         }
     }
 
+    // If the project is started on multiple Raspberry Pis, let all of them start at the same time in the near future
+    // The delay covers the logins and the clock measurements, each Raspberry Pi reports its achieved start skew
+    qint64 startAt = startPis.size() > 1 ? QDateTime::currentMSecsSinceEpoch() + SYNC_START_DELAY : 0;
+
+    // Iterate through the Raspberry Pis on which the project will be started
+    for (RaspberryPi* pi : startPis) {
+        // Signal to start the project of the Raspberry Pi
+        pi->SSHstart(startAt);
+
+        // Increment the busy Raspberry Pi count
+        busyPiCount++;
+    }
+
     // Check if at least one Raspberry Pi has been selected
     if (!noPiSelected) {
         // Check if the starting operation is executed on at least one Raspberry Pi 
@@ -695,9 +995,11 @@ void MainWindow::btn_refresh_clicked() {
     // Signal all RaspberryPi objects to delete themselves
     clearRaspberryPis();
 
-    // Reset the project path and clear the project to arguments map
+    // Reset the project path and clear the global options and the project to arguments and options map
     projectsPath = "";
+    globalOptions.clear();
     projects_argv.clear();
+    projects_options.clear();
 
     // Reset the root path of the FileSystemModel to force a refresh
     fileSystemModel->setRootPath("");
@@ -718,6 +1020,278 @@ void MainWindow::btn_refresh_clicked() {
     refreshTrees();
 }
 
+void MainWindow::btn_collect_clicked() {
+    // Indicates that no Raspberry Pi has been selected from the QTreeWidget
+    bool noPiSelected = true;
+
+    // Check if at least one Raspberry Pi has been selected before asking for the folder
+    for (RaspberryPi* pi : pis)
+        if (pi->item->checkState(0) == Qt::CheckState::Checked)
+            noPiSelected = false;
+
+    // If no Raspberry Pi has been selected show a warning
+    if (noPiSelected) {
+        QMessageBox::warning(this, "Warning", "No Raspberry Pi selected.");
+        return;
+    }
+
+    // Ask for the local folder in which the results are saved, abort if the dialog was canceled
+    QString localDir = QFileDialog::getExistingDirectory(this, "Select the folder for the results");
+    if (localDir.isEmpty())
+        return;
+
+    // Create an empty string for possible warnings
+    QString warnings = "";
+
+    // Iterate through all Raspberry Pis
+    for (RaspberryPi* pi : pis) {
+        // If the checkbox of the Raspberry Pi QTreeWidgetItem is checked
+        if (pi->item->checkState(0) == Qt::CheckState::Checked) {
+            switch (pi->status) {
+                // If the Raspberry Pi is online, the results can also be collected while the application is running
+                case piStatus::online:
+                case piStatus::appRunning:
+                    // Signal to collect the results into a subfolder named after the Raspberry Pi
+                    pi->SSHcollect(QString("%1/%2").arg(localDir, pi->name));
+
+                    // Increment the busy Raspberry Pi count
+                    busyPiCount++;
+
+                    break;
+
+                // If the Raspberry Pi is offline
+                case piStatus::offline:
+                    // Show a warning that the Raspberry Pi isn't connected
+                    warnings.append(QString("%1 is not connected.\n").arg(pi->name));
+                    break;
+
+                // If the status of the Raspberry Pi is still being checked
+                case piStatus::checking:
+                    // Show a warning that the status of the Raspberry Pi is still being checked
+                    warnings.append(QString("Still ckecking the status of %1.\n").arg(pi->name));
+                    break;
+            }
+        }
+    }
+
+    // Check if the collect operation is executed on at least one Raspberry Pi
+    if (busyPiCount > 0) {
+        // Disable all buttons of the application to not allow another operation during the current collecting
+        btns_setEnabled(false);
+
+        // Show that the collect operation has been started
+        ui.lw_infoOutput->addItem("### Collect started ###\n");
+    }
+
+    // If there are warnings
+    if (!warnings.isEmpty())
+        // Show the warnings inside a QMessageBox
+        QMessageBox::warning(this, "Warning(s)", warnings);
+}
+
+void MainWindow::btn_pipeline_clicked() {
+    // Indicates that no Raspberry Pi has been selected from the QTreeWidget
+    bool noPiSelected = true;
+
+    // Create an empty string for possible warnings
+    QString warnings = "";
+
+    // Maps the projects (and options) to the online Raspberry Pis which run the pipeline together
+    QMap<QString, QList<RaspberryPi*>> projectPis;
+
+    // Iterate through all Raspberry Pis
+    for (RaspberryPi* pi : pis) {
+        // If the checkbox of the Raspberry Pi QTreeWidgetItem is checked
+        if (pi->item->checkState(0) == Qt::CheckState::Checked) {
+            // At least one Raspberry Pi has been selected
+            noPiSelected = false;
+
+            switch (pi->status) {
+                // If the Raspberry Pi is online and the application isn't running on it
+                case piStatus::online: {
+                    // The stages run with the options of the first Raspberry Pi, so only Raspberry Pis with the same options run them together
+                    QStringList options;
+                    for (QString key : pi->options.keys())
+                        options.append(QString("%1=%2").arg(key, pi->options.value(key)));
+
+                    projectPis[pi->project + "\n" + options.join('\n')].append(pi);
+                    break;
+                }
+
+                // If the Raspberry Pi is offline
+                case piStatus::offline:
+                    // Show a warning that the Raspberry Pi isn't connected
+                    warnings.append(QString("%1 is not connected.\n").arg(pi->name));
+                    break;
+
+                // If the application is currently running on the Raspberry
+                case piStatus::appRunning:
+                    // Show a warning that the application is running on the Raspberry Pi
+                    warnings.append(QString("An application is running on %1.\n").arg(pi->name));
+                    break;
+
+                // If the status of the Raspberry Pi is still being checked
+                case piStatus::checking:
+                    // Show a warning that the status of the Raspberry Pi is still being checked
+                    warnings.append(QString("Still ckecking the status of %1.\n").arg(pi->name));
+                    break;
+            }
+        }
+    }
+
+    // The first Raspberry Pi of every project runs its pipeline, the stages on all Raspberry Pis also run on the others
+    for (QList<RaspberryPi*> group : projectPis) {
+        QStringList others;
+        for (qsizetype i = 1; i < group.size(); i++)
+            others.append(group[i]->addr);
+
+        // The pipeline can't be aborted like a build, an abort request of the last build must not stop it
+        group[0]->abortBuild = false;
+        group[0]->SSHpipeline(projectsPath, others);
+
+        busyPiCount++;
+    }
+
+    // Check if at least one Raspberry Pi has been selected
+    if (!noPiSelected) {
+        // Check if the pipeline runs on at least one Raspberry Pi
+        if (busyPiCount > 0) {
+            // Disable all buttons of the application to not allow another operation while the pipeline runs
+            btns_setEnabled(false);
+
+            // Show that the pipeline has been started
+            ui.lw_infoOutput->addItem("### Pipeline started ###\n");
+        }
+
+        // If there are warnings
+        if (!warnings.isEmpty())
+            // Show the warnings inside a QMessageBox
+            QMessageBox::warning(this, "Warning(s)", warnings);
+    }
+    else
+        // If no Raspberry Pi has been selected show a warning
+        QMessageBox::warning(this, "Warning", "No Raspberry Pi selected.");
+}
+
+void MainWindow::btn_watch_toggled(bool checked) {
+    // If the watch mode was stopped
+    if (!checked) {
+        // Stop watching all folders and the pending updates, updates which are currently executed finish normally
+        QStringList paths = watcher->directories();
+        if (!paths.isEmpty())
+            watcher->removePaths(paths);
+
+        for (QTimer* timer : watchTimers)
+            timer->stop();
+
+        watchFirstChange.clear();
+        watchIgnore.clear();
+        watchEntries.clear();
+        watchPending.clear();
+        watchPis.clear();
+
+        // Allow refreshing again if no operation is executed anymore
+        ui.btn_refresh->setEnabled(busyPiCount == 0 && watchBusy.isEmpty());
+
+        // Show that the watch mode has been stopped
+        ui.lw_infoOutput->addItem("### Watch stopped ###\n");
+        return;
+    }
+
+    // Indicates that no Raspberry Pi has been selected from the QTreeWidget
+    bool noPiSelected = true;
+
+    // Create an empty string for possible warnings
+    QString warnings = "";
+
+    // Iterate through all Raspberry Pis
+    for (RaspberryPi* pi : pis) {
+        // If the checkbox of the Raspberry Pi QTreeWidgetItem is checked
+        if (pi->item->checkState(0) == Qt::CheckState::Checked) {
+            // At least one Raspberry Pi has been selected
+            noPiSelected = false;
+
+            switch (pi->status) {
+                // If the Raspberry Pi is online, the application may be running or not (it is restarted after every change)
+                case piStatus::online:
+                case piStatus::appRunning:
+                    // Watch the Raspberry Pi and its project
+                    watchPis << pi;
+                    watch_addPaths(pi->project);
+                    break;
+
+                // If the Raspberry Pi is offline
+                case piStatus::offline:
+                    // Show a warning that the Raspberry Pi isn't connected
+                    warnings.append(QString("%1 is not connected.\n").arg(pi->name));
+                    break;
+
+                // If the status of the Raspberry Pi is still being checked
+                case piStatus::checking:
+                    // Show a warning that the status of the Raspberry Pi is still being checked
+                    warnings.append(QString("Still ckecking the status of %1.\n").arg(pi->name));
+                    break;
+            }
+        }
+    }
+
+    // If no Raspberry Pi is watched
+    if (watchPis.isEmpty()) {
+        // Uncheck the button again without stopping the (not started) watch mode
+        QSignalBlocker blocker(ui.btn_watch);
+        ui.btn_watch->setChecked(false);
+    }
+    else {
+        // The Raspberry Pis can't be refreshed (i.e., deleted) in watch mode
+        ui.btn_refresh->setEnabled(false);
+
+        // Show that the watch mode has been started
+        ui.lw_infoOutput->addItem("### Watch started ###\n");
+    }
+
+    // If no Raspberry Pi has been selected show a warning
+    if (noPiSelected)
+        QMessageBox::warning(this, "Warning", "No Raspberry Pi selected.");
+    // If there are warnings
+    else if (!warnings.isEmpty())
+        // Show the warnings inside a QMessageBox
+        QMessageBox::warning(this, "Warning(s)", warnings);
+}
+
+void MainWindow::watcher_pathChanged(QString path) {
+    // Get the project from the path, its first folder relative to the projects path
+    QString project = QDir(projectsPath).relativeFilePath(path).section('/', 0, 0);
+
+    // Skip changes of ignored folders (e.g., build outputs), they aren't deployed anyway
+    if (watch_ignored(project, path))
+        return;
+
+    // Skip a folder change if its entries which aren't ignored and their modification times stayed the same (e.g., an editor
+    // created a swap file inside it), else save the new entries for the next change
+    QMap<QString, qint64> entries = watch_entries(project, path);
+    if (watchEntries.contains(path) && entries == watchEntries[path])
+        return;
+
+    watchEntries[path] = entries;
+
+    // Create the single shot debounce timer of the project on its first change
+    QTimer* timer = watchTimers.value(project, nullptr);
+    if (timer == nullptr) {
+        timer = new QTimer(this);
+        timer->setSingleShot(true);
+        timer->setInterval(WATCH_DEBOUNCE);
+        connect(timer, &QTimer::timeout, this, [this, project]() { watch_update(project); });
+        watchTimers[project] = timer;
+    }
+
+    // Save the time of the first change since the last update, the latency is measured from it
+    if (!watchFirstChange.contains(project))
+        watchFirstChange[project] = QDateTime::currentMSecsSinceEpoch();
+
+    // (Re)start the timer, the project is updated when there were no further changes for WATCH_DEBOUNCE ms
+    timer->start();
+}
+
 void MainWindow::chbx_selectAll_stateChanged(int state) {
     // Iterate through all projects of the QTreeWidget, start at project index i = 1 to ignore the unassigned item
     for (int i = 1; i < ui.tw_pis->topLevelItemCount(); i++)
@@ -783,6 +1357,11 @@ void MainWindow::tw_pis_itemDropped(QTreeWidgetItem*) {
                 // Save the project inside the RaspberryPi object and calculate the new argument line for it
                 pi->project = project;
                 pi->calc_argv(projects_argv[pi->project]);
+                pi->calc_options(projects_options[pi->project]);
+
+                // If the Raspberry Pi is watched, watch its new project as well
+                if (watchPis.contains(pi))
+                    watch_addPaths(pi->project);
 
                 // If the Raspberry Pi hadn't a valid project until now
                 if (!pi->projectValid) {
@@ -898,20 +1477,66 @@ void MainWindow::SSHsave_finished(RaspberryPi* pi, bool, QByteArray output) {
     }
 }
 
+void MainWindow::SSHrelay_finished(RaspberryPi* pi, bool success, QByteArray output, QStringList targets, QStringList unrelayed) {
+    // Finish every target of the relay like a saved Raspberry Pi, the ones which didn't receive the project (e.g., unreachable from the seed) save it themselves
+    for (RaspberryPi* target : pis) {
+        if (target->project != pi->project || !targets.contains(target->addr))
+            continue;
+
+        if (!unrelayed.contains(target->addr))
+            SSHsave_finished(target, true, QString("%1 was relayed from %2.\n").arg(target->project, pi->name).toUtf8());
+        else if (target->status == piStatus::online)
+            target->SSHsave(projectsPath);
+        else
+            SSHsave_finished(target, false, QString("%1 couldn't be relayed from %2.\n").arg(target->project, pi->name).toUtf8());
+    }
+
+    // Show the output of the seed and count it as finished
+    SSHsave_finished(pi, success, output);
+}
+
+void MainWindow::SSHstream_output(RaspberryPi* pi, QByteArray output) {
+    // Add every line of the output with the name of the Raspberry Pi, so that the output of parallel builds can be told apart
+    for (QString line : QString(output).split('\n', Qt::SkipEmptyParts))
+        ui.lw_infoOutput->addItem(QString("[%1] %2").arg(pi->name, line));
+
+    // Follow the output
+    ui.lw_infoOutput->scrollToBottom();
+}
+
 void MainWindow::SSHcompile_finished(RaspberryPi* pi, bool, QByteArray output) {
-    // Add the output of the Raspberry Pi to the info list
-    ui.lw_infoOutput->addItem(QString("%1:\n%2").arg(pi->name, QString(output)));
+    // Add the remaining output of the Raspberry Pi (the build output was already shown line by line) to the info list
+    if (!output.isEmpty())
+        ui.lw_infoOutput->addItem(QString("%1:\n%2").arg(pi->name, QString(output)));
 
     // Decrement the busy Raspberry Pi counter, check if there are no more Raspberry Pis busy
     if (--busyPiCount == 0) {
         // Show that the operation has finished inside the info list
         ui.lw_infoOutput->addItem("### Build finished ###\n");
 
+        // The build button builds again
+        building = false;
+        ui.btn_compile->setText("Build Project");
+
         // Re-enable all buttons
         btns_setEnabled(true);
     }
 }
 
+void MainWindow::SSHcompileShare_finished(RaspberryPi* pi, bool success, QByteArray output, QStringList unshared, bool rebuild) {
+    // The Raspberry Pis which didn't receive the binary (e.g., because their sources differ) build the project themselves
+    // Not if the build was aborted meanwhile
+    for (RaspberryPi* target : pis) {
+        if (unshared.contains(target->addr) && target->status == piStatus::online && !pi->abortBuild) {
+            target->SSHcompile(rebuild, QStringList());
+            busyPiCount++;
+        }
+    }
+
+    // Show the output and count the Raspberry Pi as finished
+    SSHcompile_finished(pi, success, output);
+}
+
 void MainWindow::SSHstart_finished(RaspberryPi* pi, bool started, QByteArray output) {
     // If the application has started successfully
     if (started)
@@ -937,6 +1562,55 @@ void MainWindow::SSHstop_finished(RaspberryPi* pi, bool, QByteArray output) {
         btns_setEnabled(true);
 }
 
+void MainWindow::SSHcollect_finished(RaspberryPi* pi, bool, QByteArray output) {
+    // Add the output of the Raspberry Pi (collected files and throughput) to the info list
+    ui.lw_infoOutput->addItem(QString("%1: %2").arg(pi->name, QString(output)));
+
+    // Decrement the busy Raspberry Pi counter, check if there are no more Raspberry Pis busy
+    if (--busyPiCount == 0)
+        // Re-enable all buttons
+        btns_setEnabled(true);
+}
+
+void MainWindow::SSHpipeline_finished(RaspberryPi* pi, bool, QByteArray output) {
+    // Add the remaining output of the Raspberry Pi (the stages and the timing were already shown line by line) to the info list
+    if (!output.isEmpty())
+        ui.lw_infoOutput->addItem(QString("%1:\n%2").arg(pi->name, QString(output)));
+
+    // Decrement the busy Raspberry Pi counter, check if there are no more Raspberry Pis busy
+    if (--busyPiCount == 0) {
+        // Show that the operation has finished inside the info list
+        ui.lw_infoOutput->addItem("### Pipeline finished ###\n");
+
+        // Re-enable all buttons
+        btns_setEnabled(true);
+    }
+}
+
+void MainWindow::SSHupdate_finished(RaspberryPi* pi, bool success, QByteArray output) {
+    // Time from the first change of the project until the application was running again
+    qint64 latency = QDateTime::currentMSecsSinceEpoch() - watchBusy.take(pi);
+
+    // If the application has been restarted successfully
+    if (success)
+        // Clear the output TextEdit for upcoming output
+        pi->te_output->clear();
+
+    // Add the output of the Raspberry Pi (and the latency on success) to the info list
+    ui.lw_infoOutput->addItem(QString("%1: %2").arg(pi->name, QString(output))
+        + (success ? QString("Running again %1 ms after the edit.\n").arg(latency) : ""));
+
+    // If the project changed again during the update, update the Raspberry Pi once more
+    if (watchPending.contains(pi)) {
+        watchBusy[pi] = watchPending.take(pi);
+        pi->SSHupdate(projectsPath);
+    }
+
+    // Allow refreshing again if no operation is executed anymore and the watch mode was stopped
+    if (watchBusy.isEmpty() && busyPiCount == 0 && !ui.btn_watch->isChecked())
+        ui.btn_refresh->setEnabled(true);
+}
+
 void MainWindow::SSHnewOutput(RaspberryPi* pi, QByteArray output) {
     // Save the pointer to the scrollbar from the QTextEdit of the Raspberry Pi and save the current value of the scrollbar
     QScrollBar* scrollBar = pi->te_output->verticalScrollBar();
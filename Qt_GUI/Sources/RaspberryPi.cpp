@@ -3,12 +3,13 @@
 
 #include <QTimer>
 
-RaspberryPi::RaspberryPi(MainWindow* w, piConfig config, QString project_argv, QTreeWidgetItem* item, QTextEdit* te_output) {
+RaspberryPi::RaspberryPi(MainWindow* w, piConfig config, QString project_argv, QMap<QString, QString> project_options, QTreeWidgetItem* item, QTextEdit* te_output) {
     // Save the values of the config struct
     this->name = config.name;
     this->addr = config.addr;
     this->project = config.project;
     this->args = config.args;
+    this->piOptions = config.options;
     this->projectValid = config.projectValid;
 
     // Save the pointers to the item and text widget of the Raspberry Pi from the GUI/MainWindow
@@ -18,22 +19,37 @@ RaspberryPi::RaspberryPi(MainWindow* w, piConfig config, QString project_argv, Q
     // Calculate the arguments from the (meta) parameters
     calc_argv(project_argv);
 
+    // Calculate the options from the project and Raspberry Pi options
+    calc_options(project_options);
+
     // Create a new SSHaction object, move it to a QThread, and delete it when the QThread finishes/exits
     sshAction = new SSHaction(this);
     sshAction->moveToThread(&sshActionThread);
     connect(&sshActionThread, &QThread::finished, sshAction, &QObject::deleteLater);
 
-    // Connect the save, compile, start, and stop signals of this Raspberry Pi to the corresponding slots of the SSHaction object
+    // Connect the save, relay, release, compile, compileShare, start, stop, collect, pipeline, and update signals of this Raspberry Pi to the corresponding slots of the SSHaction object
     connect(this, &RaspberryPi::SSHsave, sshAction, &SSHaction::SSHsave);
+    connect(this, &RaspberryPi::SSHrelay, sshAction, &SSHaction::SSHrelay);
+    connect(this, &RaspberryPi::SSHrelease, sshAction, &SSHaction::SSHrelease);
     connect(this, &RaspberryPi::SSHcompile, sshAction, &SSHaction::SSHcompile);
+    connect(this, &RaspberryPi::SSHcompileShare, sshAction, &SSHaction::SSHcompileShare);
     connect(this, &RaspberryPi::SSHstart, sshAction, &SSHaction::SSHstart);
     connect(this, &RaspberryPi::SSHstop, sshAction, &SSHaction::SSHstop);
+    connect(this, &RaspberryPi::SSHcollect, sshAction, &SSHaction::SSHcollect);
+    connect(this, &RaspberryPi::SSHpipeline, sshAction, &SSHaction::SSHpipeline);
+    connect(this, &RaspberryPi::SSHupdate, sshAction, &SSHaction::SSHupdate);
 
-    // Connect the finished signals of save, compile, start, and stop from sshAction to the corresponding slots of the GUI/MainWindow
+    // Connect the finished signals of save, relay, compile, compileShare, start, stop, collect, pipeline, and update from sshAction to the corresponding slots of the GUI/MainWindow
     connect(sshAction, &SSHaction::SSHsave_finished, w, &MainWindow::SSHsave_finished);
+    connect(sshAction, &SSHaction::SSHrelay_finished, w, &MainWindow::SSHrelay_finished);
+    connect(sshAction, &SSHaction::SSHstream_output, w, &MainWindow::SSHstream_output);
     connect(sshAction, &SSHaction::SSHcompile_finished, w, &MainWindow::SSHcompile_finished);
+    connect(sshAction, &SSHaction::SSHcompileShare_finished, w, &MainWindow::SSHcompileShare_finished);
     connect(sshAction, &SSHaction::SSHstart_finished, w, &MainWindow::SSHstart_finished);
     connect(sshAction, &SSHaction::SSHstop_finished, w, &MainWindow::SSHstop_finished);
+    connect(sshAction, &SSHaction::SSHcollect_finished, w, &MainWindow::SSHcollect_finished);
+    connect(sshAction, &SSHaction::SSHpipeline_finished, w, &MainWindow::SSHpipeline_finished);
+    connect(sshAction, &SSHaction::SSHupdate_finished, w, &MainWindow::SSHupdate_finished);
 
     // Connect the current status signal from sshAction to the SSHgetStatus_finished slots of this Raspberry Pi
     connect(sshAction, &SSHaction::SSHcurrStatus, this, &RaspberryPi::SSHgetStatus_finished);
@@ -49,6 +65,12 @@ RaspberryPi::RaspberryPi(MainWindow* w, piConfig config, QString project_argv, Q
     // Connect the current status signal from sshStatus to the corresponding slot of this Raspberry Pi
     connect(sshStatus, &SSHstatus::SSHcurrStatus, this, &RaspberryPi::SSHgetStatus_finished);
 
+    // Connect the output read together with the status from sshStatus to the corresponding slot of the GUI/MainWindow
+    connect(sshStatus, &SSHstatus::SSHreadOutput_finished, w, &MainWindow::SSHnewOutput);
+
+    // Connect the fingerprint read after the Raspberry Pi came online from sshStatus to the corresponding slot of this Raspberry Pi
+    connect(sshStatus, &SSHstatus::SSHfingerprint_finished, this, &RaspberryPi::SSHfingerprint_finished);
+
     // Connect the currStatus signal of this Raspberry Pi to the corresponding slot of the GUI/MainWindow
     connect(this, &RaspberryPi::SSHcurrStatus, w, &MainWindow::SSHcurrStatus);
 
@@ -78,12 +100,12 @@ RaspberryPi::RaspberryPi(MainWindow* w, piConfig config, QString project_argv, Q
 
     // Create a new QTimer object, get the status of the Raspberry Pi on a five seconds timeout, and set that it must be re-started manually
     statusTimer = new QTimer(this);
-    connect(statusTimer, &QTimer::timeout, this, &RaspberryPi::SSHgetStatus);
+    connect(statusTimer, &QTimer::timeout, this, &RaspberryPi::checkStatus);
     statusTimer->setInterval(5000);
     statusTimer->setSingleShot(true);
 
     // Get the status of the Raspberry Pi
-    SSHgetStatus();
+    checkStatus();
 }
 
 RaspberryPi::~RaspberryPi() {
@@ -113,6 +135,11 @@ void RaspberryPi::clear() {
     deleteLater();
 }
 
+void RaspberryPi::checkStatus() {
+    // Read the last output within the same round trip if the Raspberry Pi was offline or unchecked until now
+    SSHgetStatus(status == piStatus::checking || status == piStatus::offline);
+}
+
 void RaspberryPi::calc_argv(QString project_argv) {
     // Save the argument string of the project
     QString argv = project_argv;
@@ -135,6 +162,19 @@ void RaspberryPi::calc_argv(QString project_argv) {
     this->argv = argv;
 }
 
+void RaspberryPi::calc_options(QMap<QString, QString> project_options) {
+    // Start with the options of the project
+    QMap<QString, QString> options = project_options;
+
+    // Iterate through all options of the Raspberry Pi
+    for (QString key : piOptions.keys())
+        // Add the option or override the option of the project
+        options[key] = piOptions[key];
+
+    // Save the options inside this Raspberry Pi object
+    this->options = options;
+}
+
 void RaspberryPi::SSHgetStatus_finished(piStatus currStatus, QByteArray error) {
     // Save the previous status of this Raspberry Pi
     piStatus prevStatus = this->status;
@@ -143,12 +183,9 @@ void RaspberryPi::SSHgetStatus_finished(piStatus currStatus, QByteArray error) {
         // If the status was previously checked or the Raspberry Pi was offline
         case piStatus::checking:
         case piStatus::offline:
-            // If the Raspberry Pi is now online
-            if (currStatus == piStatus::online)
-                // Read the output of the Raspberry Pi once
-                SSHreadOutput_once();
+            // If the Raspberry Pi is now online its output was already read together with the status (refresh)
             // If the Raspberry Pi is now online and the application is running
-            else if (currStatus == piStatus::appRunning)
+            if (currStatus == piStatus::appRunning)
                 // Read the output of the Raspberry Pi continuously
                 SSHreadOutput_cont();
             break;
@@ -176,3 +213,8 @@ void RaspberryPi::SSHgetStatus_finished(piStatus currStatus, QByteArray error) {
     // Restart the status timer
     statusTimer->start();
 }
+
+void RaspberryPi::SSHfingerprint_finished(QString fingerprint) {
+    // Save the fingerprint, the Raspberry Pis with the same one share the binary of their project
+    this->fingerprint = fingerprint;
+}
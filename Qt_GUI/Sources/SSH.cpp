@@ -17,10 +17,31 @@ SSH::SSH(RaspberryPi* pi) {
     this->pi = pi;
 }
 
-bool SSH::execSSHexe(QProcess* process, QString operation, QString args) {
-    // Save the address, operation, project name, and additional arguments as parameters
+QStringList SSH::createParams(QString operation, QStringList options) {
     QStringList params;
-    params << pi->addr << operation << pi->project << args;
+
+    // Pass the options of the Raspberry Pi as leading --key=value parameters
+    for (QString key : pi->options.keys())
+        params << QString("--%1=%2").arg(key, pi->options[key]);
+
+    // Append the options of this operation
+    params << options;
+
+    // Append the address, operation, and project name
+    params << pi->addr << operation << pi->project;
+
+    return params;
+}
+
+bool SSH::execSSHexe(QProcess* process, QString operation, QString args, QStringList options) {
+    // Pass the arguments as a single parameter
+    return execSSHexe(process, operation, QStringList{ args }, options);
+}
+
+bool SSH::execSSHexe(QProcess* process, QString operation, QStringList args, QStringList options) {
+    // Save the options, address, operation, project name, and additional arguments as parameters
+    QStringList params = createParams(operation, options);
+    params << args;
 
     // Start the SSH executable with the saved parameters
     process->start(SSH_BIN, params);
@@ -36,27 +57,41 @@ bool SSH::execSSHexe(QProcess* process, QString operation, QString args) {
     return true;
 }
 
-void SSHstatus::SSHgetStatus() {
+void SSHstatus::SSHgetStatus(bool withOutput) {
     // Create a new QProcess object
     QProcess process;
 
     // Execute the status operation to get the current status of the Raspberry Pi
-    if (execSSHexe(&process, "status")) {
+    // or the refresh operation which additionally reads the last output of the application
+    if (execSSHexe(&process, withOutput ? "refresh" : "status")) {
         switch (process.exitCode()) {
             case 1:
-                // The application is running on the Raspberry Pi
+                // The application is running on the Raspberry Pi, its output is read continuously afterwards
                 SSHcurrStatus(piStatus::appRunning);
                 break;
 
             case 2:
                 // The Raspberry Pi is online but the application is not running
                 SSHcurrStatus(piStatus::online);
+
+                // If the output was read too signal it after the status
+                if (withOutput)
+                    SSHreadOutput_finished(pi, process.readAllStandardOutput());
                 break;
 
             default:
                 // The Raspberry Pi is offline (code = 0) or there was an error (code = -1)
                 SSHcurrStatus(piStatus::offline, process.readAllStandardError());
         }
+
+        // If the Raspberry Pi just came online, read its fingerprint once (it only changes with the installed software)
+        if (withOutput && (process.exitCode() == 1 || process.exitCode() == 2)) {
+            QProcess fingerprintProcess;
+            if (execSSHexe(&fingerprintProcess, "fingerprint") && fingerprintProcess.exitCode() == 0)
+                for (QString line : QString(fingerprintProcess.readAllStandardOutput()).split('\n'))
+                    if (line.startsWith("Fingerprint: "))
+                        SSHfingerprint_finished(line.mid(13).trimmed());
+        }
     }
     else
         // If the SSH executable couldn't be started
@@ -81,30 +116,150 @@ void SSHaction::SSHsave(QString path2project) {
         SSHsave_finished(pi, false, "SSH executable couldn't be started.");
 }
 
-void SSHaction::SSHcompile() {
+void SSHaction::SSHrelay(QString path2project, QStringList targets) {
     // Create a new QProcess object
     QProcess process;
 
-    // Execute the compile operation to build the project of the Raspberry Pi
-    if (execSSHexe(&process, "compile")) {
-        if (process.exitCode() == 0)
-            // If the operation was successful read (and return) from stdout
-            SSHcompile_finished(pi, true, process.readAllStandardOutput());
-        else
-            // If the operation was unsuccessful read (and return) from stderr
-            SSHcompile_finished(pi, false, process.readAllStandardError());
+    // Execute the relay operation to sync the project from the given projects path and forward it to the targets
+    if (!execSSHexe(&process, "relay", QStringList{ path2project } + targets)) {
+        // If the SSH executable couldn't be started, the targets save the project themselves
+        SSHrelay_finished(pi, false, "SSH executable couldn't be started.", targets, targets);
+        return;
     }
+
+    // Return stdout (the targets which received the project) together with stderr (the targets which didn't)
+    QByteArray output = process.readAllStandardOutput() + process.readAllStandardError();
+
+    // The targets which didn't receive the project save it themselves
+    QStringList unrelayed;
+    for (QString addr : targets)
+        if (!output.contains(QString(" was relayed to %1.\n").arg(addr).toUtf8()))
+            unrelayed.append(addr);
+
+    SSHrelay_finished(pi, process.exitCode() == 0, output, targets, unrelayed);
+}
+
+void SSHaction::SSHrelease(QString path2project) {
+    // The update operation with the option releases stages the release before the application is restarted, it answers like a save
+    update(path2project, &SSHaction::SSHsave_finished);
+}
+
+bool SSHaction::execStreamed(QProcess* process, QString operation, QStringList args, QStringList options) {
+    // Start the SSH executable with the operation and its arguments
+    process->start(SSH_BIN, createParams(operation, options) << args);
+
+    // Wait for the process to be started
+    if (!process->waitForStarted())
+        // If the process couldn't start (e.g., SSH executable missing)
+        return false;
+
+    // The incomplete last lines of stdout and stderr, sent when they are complete
+    QByteArray lines[2];
+    bool aborted = false;
+
+    // Until the process exits, check every 100 ms for new output and if the build should be aborted
+    bool finished = false;
+    while (!finished) {
+        finished = process->waitForFinished(100) || process->state() == QProcess::NotRunning;
+
+        // Read the new output of stdout and stderr, send all complete lines (or everything when the process has finished)
+        for (int channel = 0; channel < 2; channel++) {
+            process->setReadChannel(channel == 0 ? QProcess::StandardOutput : QProcess::StandardError);
+            lines[channel] += process->readAll();
+
+            qsizetype end = finished ? lines[channel].size() : lines[channel].lastIndexOf('\n') + 1;
+            if (end > 0) {
+                SSHstream_output(pi, lines[channel].left(end));
+                lines[channel].remove(0, end);
+            }
+        }
+
+        // Write some character to the process' stdin so that it stops the build on the Raspberry Pi and exits
+        if (!finished && !aborted && pi->abortBuild) {
+            process->write("q");
+            aborted = true;
+        }
+    }
+
+    return true;
+}
+
+void SSHaction::SSHcompile(bool rebuild, QStringList helpers) {
+    // Create a new QProcess object
+    QProcess process;
+
+    // If the build shouldn't be skipped when the sources haven't changed
+    QStringList options;
+    if (rebuild)
+        options << "--rebuild=yes";
+
+    // If the compile jobs should be distributed to other Raspberry Pis
+    if (!helpers.isEmpty())
+        options << QString("--helpers=%1").arg(helpers.join(','));
+
+    // Execute the compile operation to build the project of the Raspberry Pi, its output was already sent line by line
+    if (execStreamed(&process, "compile", QStringList(), options))
+        SSHcompile_finished(pi, process.exitCode() == 0, "");
     else
         // If the SSH executable couldn't be started
         SSHcompile_finished(pi, false, "SSH executable couldn't be started.");
 }
 
-void SSHaction::SSHstart() {
+void SSHaction::SSHcompileShare(bool rebuild, QStringList targets, QStringList helpers) {
+    // Create a new QProcess object
+    QProcess process;
+
+    // If the build shouldn't be skipped when the sources haven't changed
+    QStringList options;
+    if (rebuild)
+        options << "--rebuild=yes";
+
+    // If the compile jobs should be distributed to other Raspberry Pis
+    if (!helpers.isEmpty())
+        options << QString("--helpers=%1").arg(helpers.join(','));
+
+    // Execute the compile operation to build the project of the Raspberry Pi, its output is sent line by line
+    if (!execStreamed(&process, "compile", QStringList(), options)) {
+        // If the SSH executable couldn't be started
+        SSHcompileShare_finished(pi, false, "SSH executable couldn't be started.", QStringList(), rebuild);
+        return;
+    }
+
+    // If the build failed, the targets would fail the same way and aren't built
+    if (process.exitCode() != 0) {
+        SSHcompileShare_finished(pi, false, QString("Not built on %1 other Raspberry Pi(s) with the same fingerprint.\n")
+            .arg(targets.size()).toUtf8(), QStringList(), rebuild);
+        return;
+    }
+
+    QByteArray output;
+
+    // Execute the share operation to copy the binary to the targets, its output contains the result of every target
+    QProcess shareProcess;
+    QStringList unshared;
+    bool started = execSSHexe(&shareProcess, "share", targets);
+    if (started)
+        output += shareProcess.readAllStandardOutput() + shareProcess.readAllStandardError();
+
+    // The targets which didn't receive the binary build the project themselves
+    for (QString addr : targets)
+        if (!started || !output.contains(QString("was copied to %1.\n").arg(addr).toUtf8()))
+            unshared.append(addr);
+
+    SSHcompileShare_finished(pi, true, output, unshared, rebuild);
+}
+
+void SSHaction::SSHstart(qint64 startAt) {
     // Create a new QProcess object
     QProcess process;
 
+    // If the start is synchronized with other Raspberry Pis pass the start time
+    QStringList options;
+    if (startAt != 0)
+        options << QString("--startAt=%1").arg(startAt);
+
     // Execute the start operation to start the project of the Raspberry Pi with the given arguments
-    if (execSSHexe(&process, "start", pi->argv)) {
+    if (execSSHexe(&process, "start", pi->argv, options)) {
         if (process.exitCode() == 0) {
             // If the operation was successful read (and return) from stdout
             SSHstart_finished(pi, true, process.readAllStandardOutput());
@@ -143,6 +298,64 @@ void SSHaction::SSHstop() {
         SSHstop_finished(pi, false, "SSH executable couldn't be started.");
 }
 
+void SSHaction::SSHcollect(QString localDir) {
+    // Create a new QProcess object
+    QProcess process;
+
+    // Execute the collect operation to download the results of the project into the given folder
+    if (execSSHexe(&process, "collect", localDir))
+        // Return stdout (the collected files and the throughput) together with stderr (results which couldn't be collected)
+        SSHcollect_finished(pi, process.exitCode() == 0, process.readAllStandardOutput() + process.readAllStandardError());
+    else
+        // If the SSH executable couldn't be started
+        SSHcollect_finished(pi, false, "SSH executable couldn't be started.");
+}
+
+void SSHaction::SSHpipeline(QString path2project, QStringList pis) {
+    // Create a new QProcess object
+    QProcess process;
+
+    // The stages which run on all Raspberry Pis run on the other ones as well
+    QStringList options;
+    if (!pis.isEmpty())
+        options << QString("--pipelinePis=%1").arg(pis.join(','));
+
+    // Execute the pipeline operation, its output (the stages and the timing) is sent line by line
+    if (execStreamed(&process, "pipeline", QStringList{ path2project }, options))
+        SSHpipeline_finished(pi, process.exitCode() == 0, "");
+    else
+        // If the SSH executable couldn't be started
+        SSHpipeline_finished(pi, false, "SSH executable couldn't be started.");
+}
+
+void SSHaction::SSHupdate(QString path2project) {
+    // Sync the changed files, rebuild, and restart the application (watch mode)
+    update(path2project, &SSHaction::SSHupdate_finished);
+}
+
+void SSHaction::update(QString path2project, void (SSHaction::*finished)(RaspberryPi*, bool, QByteArray)) {
+    // Create a new QProcess object
+    QProcess process;
+
+    // Execute the update operation to sync the changed files from the given projects path, rebuild, and restart the application with its arguments
+    if (execSSHexe(&process, "update", QStringList{ path2project, pi->argv })) {
+        if (process.exitCode() == 0) {
+            // If the operation was successful read (and return) from stdout
+            (this->*finished)(pi, true, process.readAllStandardOutput());
+
+            // The application was restarted, signal a stop and a start so that the output of the new run is read from the beginning
+            SSHcurrStatus(piStatus::online);
+            SSHcurrStatus(piStatus::appRunning);
+        }
+        else
+            // If the operation was unsuccessful read (and return) from stdout (the steps which succeeded) and stderr (e.g., the compiler errors)
+            (this->*finished)(pi, false, process.readAllStandardOutput() + process.readAllStandardError());
+    }
+    else
+        // If the SSH executable couldn't be started
+        (this->*finished)(pi, false, "SSH executable couldn't be started.");
+}
+
 void SSHoutput::SSHreadOutput_once() {
     // Create a new QProcess object
     QProcess process;
@@ -159,9 +372,8 @@ void SSHoutput::SSHreadOutput_once() {
 }
 
 void SSHoutput::SSHreadOutput_cont() {
-    // Save the address, operation, and project name as parameters
-    QStringList params;
-    params << pi->addr << "readOutput_cont" << pi->project;
+    // Save the options, address, operation, and project name as parameters
+    QStringList params = createParams("readOutput_cont");
 
     // Create a new QProcess object, save the pointer
     process = new QProcess();
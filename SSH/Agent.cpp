@@ -0,0 +1,182 @@
+#include "Agent.h"
+#include "SSH.h"
+
+#include <iostream>
+
+#include <libssh/libssh.h>
+
+// Constructor
+Agent::Agent(ssh_session session) {
+    // Save the session handle to open the channel later
+    this->session = session;
+}
+
+// Destructor
+Agent::~Agent() {
+    // Close the channel to the agent
+    close();
+}
+
+int Agent::open(const char* socketPath) {
+    // Close a previously opened channel
+    close();
+
+    // Allocate a new channel
+    channel = ssh_channel_new(session);
+
+    // If there was an allocation error
+    if (channel == nullptr)
+        return SSH_ERROR;
+
+    // Let the SSH server connect the channel to the Unix socket of the agent (direct-streamlocal) ...
+    // If the socket doesn't exist or the forwarding isn't allowed
+    if (ssh_channel_open_forward_unix(channel, socketPath, "localhost", 22) != SSH_OK) {
+        // Free the channel
+        ssh_channel_free(channel);
+        channel = nullptr;
+
+        return SSH_ERROR;
+    }
+
+    // Send our protocol version
+    std::string hello, response;
+    agent::put_u32(&hello, AGENT_PROTOCOL_VERSION);
+
+    // Check that the agent answers with the same protocol version
+    size_t pos = 0;
+    uint32_t version;
+    if (request(AGENT_HELLO, hello, &response) != SSH_OK || !agent::get_u32(response, &pos, &version) || version != AGENT_PROTOCOL_VERSION) {
+        // Close the channel, the agent can't be used
+        close();
+
+        return SSH_ERROR;
+    }
+
+    return SSH_OK;
+}
+
+void Agent::close() {
+    // Only close if the channel is open
+    if (channel != nullptr) {
+        // Send an end of file, close and free the channel
+        ssh_channel_send_eof(channel);
+        ssh_channel_close(channel);
+        ssh_channel_free(channel);
+        channel = nullptr;
+    }
+
+    // Drop the responses which weren't received
+    responses.clear();
+}
+
+bool Agent::isOpen() {
+    return channel != nullptr;
+}
+
+bool Agent::read_exact(char* buffer, size_t count) {
+    while (count > 0) {
+        // Read the remaining Bytes from the channel
+        int nbytes = ssh_channel_read(channel, buffer, (uint32_t)count, 0);
+
+        // End of file or error
+        if (nbytes <= 0)
+            return false;
+
+        buffer += nbytes;
+        count -= nbytes;
+    }
+
+    return true;
+}
+
+uint32_t Agent::send(uint8_t type, const std::string& payload) {
+    // If there is no channel to the agent
+    if (channel == nullptr)
+        return 0;
+
+    // Take the next request ID, skip 0 after an overflow
+    uint32_t id = nextId++;
+    if (nextId == 0)
+        nextId = 1;
+
+    // Create and write the whole frame
+    std::string frame = agent::frame(id, type, payload);
+    if (ssh_channel_write(channel, frame.data(), (uint32_t)frame.size()) != (int)frame.size()) {
+        // Print the error message
+        std::cerr << "Error sending agent request: " << ssh_get_error(session) << std::endl;
+
+        // The channel is unusable afterwards
+        close();
+
+        return 0;
+    }
+
+    return id;
+}
+
+int Agent::receive(uint32_t id, std::string* payload) {
+    // Read frames until the response of the request arrived
+    while (responses.count(id) == 0) {
+        // If there is no channel to the agent
+        if (channel == nullptr)
+            return SSH_ERROR;
+
+        // Read the length of the frame
+        std::string header(AGENT_HEADER_SIZE, '\0');
+        if (!read_exact(&header[0], AGENT_HEADER_SIZE)) {
+            // Print an error message
+            std::cerr << "The connection to the agent was lost." << std::endl;
+            close();
+
+            return SSH_ERROR;
+        }
+
+        // Decode the header
+        size_t pos = 0;
+        uint32_t length, responseId;
+        uint8_t type;
+        agent::get_u32(header, &pos, &length);
+        agent::get_u32(header, &pos, &responseId);
+        agent::get_u8(header, &pos, &type);
+
+        // Reject frames which are too short or too long
+        if (length < AGENT_HEADER_SIZE - 4 || length > AGENT_MAX_FRAME) {
+            // Print an error message
+            std::cerr << "Invalid frame received from the agent." << std::endl;
+            close();
+
+            return SSH_ERROR;
+        }
+
+        // Read the payload and save the response
+        std::string data(length - (AGENT_HEADER_SIZE - 4), '\0');
+        if (!data.empty() && !read_exact(&data[0], data.size())) {
+            // Print an error message
+            std::cerr << "The connection to the agent was lost." << std::endl;
+            close();
+
+            return SSH_ERROR;
+        }
+
+        responses[responseId] = { type, std::move(data) };
+    }
+
+    // Take the response out of the buffered ones
+    auto response = responses.extract(id);
+    *payload = std::move(response.mapped().second);
+
+    // Return if the agent could process the request
+    return response.mapped().first == AGENT_OK ? SSH_OK : SSH_CMD_ERROR;
+}
+
+int Agent::request(uint8_t type, const std::string& payload, std::string* response) {
+    // Send the request
+    uint32_t id = send(type, payload);
+
+    // If the request couldn't be sent
+    if (id == 0)
+        return SSH_ERROR;
+
+    // Wait for the response
+    return receive(id, response);
+}
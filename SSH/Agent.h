@@ -0,0 +1,98 @@
+#pragma once
+
+#include "Agent/protocol.h"
+
+#include <map>
+#include <string>
+
+typedef struct ssh_session_struct*  ssh_session;
+typedef struct ssh_channel_struct*	ssh_channel;
+
+/// <summary>
+/// Client for the agent on the SSH client (see Agent/agent.cpp), connected through a forwarded Unix socket
+/// so that no new process has to be spawned on the SSH client per request
+/// </summary>
+class Agent {
+
+public:
+	/// <summary>
+	/// Constructor for initialization
+	/// </summary>
+	/// <param name="session">The connected SSH session used to open the channel</param>
+	Agent(ssh_session session);
+
+	/// <summary>
+	/// Destructor automatically closes the channel
+	/// </summary>
+	~Agent();
+
+	/// <summary>
+	/// Opens a channel to the Unix socket of a running agent and checks the protocol version
+	/// </summary>
+	/// <param name="socketPath">Absolute path of the socket on the SSH client</param>
+	/// <returns>SSH_OK on success, SSH_ERROR if there is no (compatible) agent listening</returns>
+	int open(const char* socketPath);
+
+	/// <summary>
+	/// Closes the channel to the agent
+	/// </summary>
+	void close();
+
+	/// <summary>
+	/// Returns if the channel to the agent is open
+	/// </summary>
+	bool isOpen();
+
+	/// <summary>
+	/// Sends a request without waiting for the response, so that multiple requests can be pipelined
+	/// </summary>
+	/// <param name="type">Type of the request (e.g., AGENT_STATUS)</param>
+	/// <param name="payload">Encoded payload of the request</param>
+	/// <returns>The ID of the request on success, 0 on error</returns>
+	uint32_t send(uint8_t type, const std::string& payload);
+
+	/// <summary>
+	/// Waits for the response of a previously sent request, responses of other requests are buffered meanwhile
+	/// </summary>
+	/// <param name="id">ID of the request returned by send</param>
+	/// <param name="payload">Pointer to the string in which the payload of the response is saved</param>
+	/// <returns>SSH_OK if the agent returned AGENT_OK, SSH_CMD_ERROR if it returned AGENT_FAILED, SSH_ERROR on connection error</returns>
+	int receive(uint32_t id, std::string* payload);
+
+	/// <summary>
+	/// Sends a request and waits for its response
+	/// </summary>
+	/// <param name="type">Type of the request (e.g., AGENT_STATUS)</param>
+	/// <param name="payload">Encoded payload of the request</param>
+	/// <param name="response">Pointer to the string in which the payload of the response is saved</param>
+	/// <returns>SSH_OK if the agent returned AGENT_OK, SSH_CMD_ERROR if it returned AGENT_FAILED, SSH_ERROR on connection error</returns>
+	int request(uint8_t type, const std::string& payload, std::string* response);
+
+private:
+	/// <summary>
+	/// SSH session handle
+	/// </summary>
+	ssh_session session;
+
+	/// <summary>
+	/// Channel to the socket of the agent, nullptr if not open
+	/// </summary>
+	ssh_channel channel = nullptr;
+
+	/// <summary>
+	/// ID of the next request, 0 is reserved for errors
+	/// </summary>
+	uint32_t nextId = 1;
+
+	/// <summary>
+	/// Responses which were received while waiting for another one, saved by their request ID
+	/// </summary>
+	std::map<uint32_t, std::pair<uint8_t, std::string>> responses;
+
+	/// <summary>
+	/// Reads exactly count Bytes from the channel
+	/// </summary>
+	/// <returns>true on success, false on error or end of file</returns>
+	bool read_exact(char* buffer, size_t count);
+
+};
@@ -0,0 +1,844 @@
+// Persistent agent which runs on the Raspberry Pi
+// It listens on a Unix socket which the SSH executable connects to through SSH (direct-streamlocal forwarding)
+// and answers the requests of the framed binary protocol (see protocol.h),
+// so that status checks, output reads, etc. don't need to spawn a shell and several processes each time
+//
+// It is uploaded and built by the SSH executable itself (g++ -O2 -std=c++17 -o agent agent.cpp)
+// Usage: agent --listen <socket>   Serve connections on the socket, exits after AGENT_IDLE_TIMEOUT seconds without any
+//        agent                     Serve a single connection on stdin/stdout
+
+#include "hash.h"
+#include "protocol.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+
+// Files inside the Debug folder of a project, must be equal to SSH_PID_FILE and SSH_EXIT_FILE of the SSH executable
+#define PID_FILE	"app.pid"
+#define EXIT_FILE	"app.exit"
+
+// Seconds without a new connection after which the listening agent exits
+#define AGENT_IDLE_TIMEOUT	600
+
+// Suffix of the temporary file into which a patched file is written before it replaces the original
+#define PATCH_SUFFIX		".pideploy-patch"
+
+// Suffix of the temporary hard link which replaces a file
+#define LINK_SUFFIX			".pideploy-link"
+
+// Bytes of stdout resp. stderr of an executed command which are returned, both together stay below the maximum frame size
+#define EXEC_MAX_OUTPUT		(AGENT_MAX_FRAME / 4)
+
+// Line which replaces the output of an executed command beyond EXEC_MAX_OUTPUT
+#define EXEC_TRUNCATED		"\n[output truncated]\n"
+
+// Reads exactly count Bytes from the file descriptor, returns false on error or end of file
+static bool read_exact(int fd, char* buffer, size_t count) {
+    while (count > 0) {
+        ssize_t nbytes = read(fd, buffer, count);
+
+        // Retry if interrupted by a signal
+        if (nbytes < 0 && errno == EINTR)
+            continue;
+
+        // End of file or error
+        if (nbytes <= 0)
+            return false;
+
+        buffer += nbytes;
+        count -= nbytes;
+    }
+
+    return true;
+}
+
+// Writes all Bytes of the data to the file descriptor, returns false on error
+static bool write_all(int fd, const std::string& data) {
+    size_t written = 0;
+
+    while (written < data.size()) {
+        ssize_t nbytes = write(fd, data.data() + written, data.size() - written);
+
+        // Retry if interrupted by a signal
+        if (nbytes < 0 && errno == EINTR)
+            continue;
+
+        if (nbytes <= 0)
+            return false;
+
+        written += nbytes;
+    }
+
+    return true;
+}
+
+// Reads a whole (small) file into the string, returns false if it couldn't be opened
+static bool read_file(const std::string& path, std::string* content) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    char buffer[4096];
+    ssize_t nbytes;
+    while ((nbytes = read(fd, buffer, sizeof(buffer))) > 0)
+        content->append(buffer, nbytes);
+
+    close(fd);
+    return true;
+}
+
+// Writes the string to the file, creates or truncates it
+static void write_file(const std::string& path, const std::string& content, int flags = O_TRUNC) {
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | flags, 0644);
+    if (fd < 0)
+        return;
+
+    write_all(fd, content);
+    close(fd);
+}
+
+// Returns the start time (field 22 of /proc/<pid>/stat) of the process, or an empty string if it doesn't exist
+static std::string process_start_time(long pid) {
+    std::string stat;
+    if (!read_file("/proc/" + std::to_string(pid) + "/stat", &stat))
+        return "";
+
+    // The fields start after the name of the process which is enclosed in parentheses (and may contain spaces)
+    size_t pos = stat.rfind(')');
+    if (pos == std::string::npos)
+        return "";
+
+    // Skip the fields 3 (state) to 21
+    pos += 2;
+    for (int field = 3; field < 22; field++) {
+        pos = stat.find(' ', pos);
+        if (pos == std::string::npos)
+            return "";
+        pos++;
+    }
+
+    return stat.substr(pos, stat.find(' ', pos) - pos);
+}
+
+// Checks if the application of the last start is still running, same as SSH::app_running_condition
+// On success the process group of the application is saved
+static bool app_running(const std::string& debugDir, long* pgid) {
+    // Read the PID, start time, and process group
+    std::string content;
+    if (!read_file(debugDir + "/" PID_FILE, &content))
+        return false;
+
+    long pid, group;
+    char start[32];
+    if (sscanf(content.c_str(), "%ld %31s %ld", &pid, start, &group) != 3)
+        return false;
+
+    // The application has exited if there is an exit file
+    if (access((debugDir + "/" EXIT_FILE).c_str(), F_OK) == 0)
+        return false;
+
+    // Compare the start time, else the PID was reused by another process
+    if (process_start_time(pid) != start)
+        return false;
+
+    *pgid = group;
+    return true;
+}
+
+// Runs the command through bash and saves its exit code, stdout, and stderr
+static int exec_command(const std::string& cmd, std::string* out, std::string* err) {
+    int outPipe[2], errPipe[2];
+    if (pipe(outPipe) != 0)
+        return -1;
+    if (pipe(errPipe) != 0) {
+        close(outPipe[0]);
+        close(outPipe[1]);
+        return -1;
+    }
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(outPipe[0]);
+        close(outPipe[1]);
+        close(errPipe[0]);
+        close(errPipe[1]);
+        return -1;
+    }
+
+    if (pid == 0) {
+        // Child: read from /dev/null, write to the pipes so that the protocol on stdin/stdout isn't disturbed
+        int null = open("/dev/null", O_RDONLY);
+        dup2(null, STDIN_FILENO);
+        dup2(outPipe[1], STDOUT_FILENO);
+        dup2(errPipe[1], STDERR_FILENO);
+        close(null);
+        close(outPipe[0]);
+        close(outPipe[1]);
+        close(errPipe[0]);
+        close(errPipe[1]);
+
+        // Restore the default, an ignored SIGPIPE would be inherited by the command (and the application it starts)
+        signal(SIGPIPE, SIG_DFL);
+
+        execl("/bin/bash", "bash", "-c", cmd.c_str(), (char*)nullptr);
+        _exit(127);
+    }
+
+    close(outPipe[1]);
+    close(errPipe[1]);
+
+    // Read stdout and stderr at the same time until both are closed
+    struct pollfd fds[2] = { { outPipe[0], POLLIN, 0 }, { errPipe[0], POLLIN, 0 } };
+    std::string* targets[2] = { out, err };
+    int open_fds = 2;
+
+    while (open_fds > 0) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+
+        for (int i = 0; i < 2; i++) {
+            if (fds[i].fd < 0 || fds[i].revents == 0)
+                continue;
+
+            // Keep reading beyond the maximum, so that the command doesn't block, but drop the rest so that the response can be received
+            char buffer[4096];
+            ssize_t nbytes = read(fds[i].fd, buffer, sizeof(buffer));
+            if (nbytes > 0) {
+                if (targets[i]->size() < EXEC_MAX_OUTPUT)
+                    targets[i]->append(buffer, std::min<size_t>(nbytes, EXEC_MAX_OUTPUT - targets[i]->size()));
+                else if (targets[i]->size() == EXEC_MAX_OUTPUT)
+                    targets[i]->append(EXEC_TRUNCATED);
+            }
+            else {
+                close(fds[i].fd);
+                fds[i].fd = -1;
+                open_fds--;
+            }
+        }
+    }
+
+    int status;
+    waitpid(pid, &status, 0);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+}
+
+// Stops the application like SSH::stop, returns its exit code or -1 if it isn't running
+// The cleanup command is run inside the Debug folder if the application had to be killed
+static int stop_app(const std::string& debugDir, uint32_t timeout_ms, const std::string& cleanup) {
+    long pgid;
+    if (!app_running(debugDir, &pgid))
+        return -1;
+
+    std::string exitFile = debugDir + "/" EXIT_FILE;
+
+    // Send SIGTERM to the whole process group
+    kill(-pgid, SIGTERM);
+
+    // Wait until the exit file was written or the timeout elapsed
+    for (uint32_t waited = 0; waited < timeout_ms && access(exitFile.c_str(), F_OK) != 0; waited += 100)
+        usleep(100 * 1000);
+
+    // If the application is still running send SIGKILL to the whole process group
+    if (access(exitFile.c_str(), F_OK) != 0) {
+        kill(-pgid, SIGKILL);
+
+        // The launcher was killed as well, so let the cleanup command do its remaining work (e.g., restoring the CPU governors)
+        std::string out, err;
+        exec_command("cd " + debugDir + " && " + cleanup, &out, &err);
+
+        write_file(exitFile, "137\n");
+        write_file(debugDir + "/output.txt", "\nThe Process was killed\n", O_APPEND);
+    }
+
+    // Read the exit code
+    std::string content;
+    read_file(exitFile, &content);
+    return atoi(content.c_str());
+}
+
+// Returns information about the file
+static agent::Stat stat_file(const std::string& path) {
+    agent::Stat result;
+    struct stat st;
+
+    if (stat(path.c_str(), &st) != 0)
+        return result;
+
+    result.type = S_ISREG(st.st_mode) ? AGENT_TYPE_FILE : S_ISDIR(st.st_mode) ? AGENT_TYPE_DIR : AGENT_TYPE_OTHER;
+    result.mode = st.st_mode;
+    result.size = st.st_size;
+    result.inode = st.st_ino;
+    result.mtime_ns = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+    return result;
+}
+
+// Reads the last nbytes Bytes of the file, returns false if it couldn't be opened
+static bool tail_file(const std::string& path, uint32_t nbytes, std::string* content) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > (off_t)nbytes)
+        lseek(fd, st.st_size - nbytes, SEEK_SET);
+
+    char buffer[4096];
+    ssize_t n;
+    while (content->size() < nbytes && (n = read(fd, buffer, sizeof(buffer))) > 0)
+        content->append(buffer, n);
+
+    close(fd);
+    return true;
+}
+
+// Computes the weak (rolling) and strong checksum of every block of the file, returns false if it couldn't be read
+static bool block_sums(const std::string& path, uint32_t blockSize, std::string* response) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        errno = EINVAL;
+        return false;
+    }
+
+    // The last block may be shorter
+    uint64_t size = st.st_size;
+    uint32_t count = (uint32_t)((size + blockSize - 1) / blockSize);
+    agent::put_u64(response, size);
+    agent::put_u32(response, count);
+
+    // Read the file block by block
+    std::string block(blockSize, '\0');
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t nbytes = (uint32_t)std::min<uint64_t>(blockSize, size - (uint64_t)i * blockSize);
+        if (!read_exact(fd, &block[0], nbytes)) {
+            close(fd);
+            return false;
+        }
+
+        agent::RollingSum sum;
+        sum.init(block.data(), nbytes);
+        agent::put_u32(response, sum.digest());
+        agent::put_u64(response, agent::hash64(block.data(), nbytes));
+    }
+
+    close(fd);
+    return true;
+}
+
+// Hashes the first length Bytes of the file (all if it is shorter), saves the size of the file, returns false if it couldn't be read.
+// If sync is set, the file is written to the storage and dropped from the page cache first, so that it is read back from the storage
+static bool hash_file(const std::string& path, uint64_t length, bool sync, uint64_t* size, uint64_t* hash) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return false;
+    }
+
+    *size = st.st_size;
+    length = std::min(length, *size);
+
+    if (sync && (fdatasync(fd) != 0 || posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) != 0)) {
+        close(fd);
+        return false;
+    }
+
+    // Map the file instead of reading it into a buffer, an empty mapping isn't allowed
+    void* data = nullptr;
+    if (length > 0 && (data = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0)) == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+
+    *hash = agent::hash64(data, length);
+
+    if (data != nullptr)
+        munmap(data, length);
+    close(fd);
+    return true;
+}
+
+// Replaces the file atomically by a hard link to the object, which gets the given read-only mode first so that it can't be changed through one of its links,
+// returns false and saves an error message on error
+static bool link_file(const std::string& object, const std::string& path, mode_t mode, std::string* error) {
+    if (chmod(object.c_str(), mode) != 0) {
+        *error = "Cannot change the mode of " + object + ": " + strerror(errno);
+        return false;
+    }
+
+    // Nothing to do if the file already is a link to the object (rename wouldn't remove the temporary link then)
+    struct stat objectStat, pathStat;
+    if (stat(object.c_str(), &objectStat) == 0 && stat(path.c_str(), &pathStat) == 0
+        && objectStat.st_dev == pathStat.st_dev && objectStat.st_ino == pathStat.st_ino)
+        return true;
+
+    // Link the object under a temporary name next to the file, then rename it over the file
+    std::string tmpPath = path + LINK_SUFFIX;
+    unlink(tmpPath.c_str());
+
+    if (link(object.c_str(), tmpPath.c_str()) != 0) {
+        *error = "Cannot link " + object + " to " + tmpPath + ": " + strerror(errno);
+        return false;
+    }
+
+    if (rename(tmpPath.c_str(), path.c_str()) != 0) {
+        *error = "Cannot rename " + tmpPath + " to " + path + ": " + strerror(errno);
+        unlink(tmpPath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+// Rebuilds the file from its blocks and the literal data of the delta operations in a temporary file,
+// which replaces the file atomically if it has the expected size and hash, returns false and saves an error message else
+static bool patch_file(const std::string& path, uint32_t blockSize, uint64_t size, uint64_t hash, const std::string& payload, size_t pos, std::string* error) {
+    int base = open(path.c_str(), O_RDONLY);
+    struct stat st;
+    if (base < 0 || fstat(base, &st) != 0) {
+        *error = "Cannot open " + path + ": " + strerror(errno);
+        if (base >= 0)
+            close(base);
+        return false;
+    }
+
+    // Create the temporary file next to the original with the same permissions, so that it can be renamed
+    std::string tmpPath = path + PATCH_SUFFIX;
+    int out = open(tmpPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, st.st_mode & 07777);
+    if (out < 0) {
+        *error = "Cannot create " + tmpPath + ": " + strerror(errno);
+        close(base);
+        return false;
+    }
+
+    // Apply the operations
+    uint32_t count;
+    bool ok = agent::get_u32(payload, &pos, &count);
+    uint64_t written = 0;
+    std::string buffer;
+
+    for (uint32_t i = 0; ok && i < count; i++) {
+        uint8_t op;
+        ok = agent::get_u8(payload, &pos, &op);
+
+        if (ok && op == AGENT_DELTA_COPY) {
+            // Copy a run of blocks of the original file
+            uint32_t first, nblocks;
+            ok = agent::get_u32(payload, &pos, &first) && agent::get_u32(payload, &pos, &nblocks);
+
+            uint64_t offset = (uint64_t)first * blockSize;
+            uint64_t end = std::min<uint64_t>(offset + (uint64_t)nblocks * blockSize, st.st_size);
+            ok = ok && offset < end;
+
+            while (ok && offset < end) {
+                buffer.resize(std::min<uint64_t>(end - offset, 1 << 20));
+                ssize_t nbytes = pread(base, &buffer[0], buffer.size(), offset);
+                if (nbytes < 0 && errno == EINTR)
+                    continue;
+
+                buffer.resize(nbytes > 0 ? nbytes : 0);
+                ok = nbytes > 0 && write_all(out, buffer);
+                offset += buffer.size();
+                written += buffer.size();
+            }
+        }
+        else if (ok && op == AGENT_DELTA_DATA) {
+            // Append literal data
+            ok = agent::get_string(payload, &pos, &buffer) && write_all(out, buffer);
+            written += buffer.size();
+        }
+        else
+            ok = false;
+    }
+
+    close(base);
+
+    if (!ok)
+        *error = "Invalid delta for " + path;
+    else if (written != size) {
+        *error = "Patched " + path + " has " + std::to_string(written) + " instead of " + std::to_string(size) + " Bytes";
+        ok = false;
+    }
+    else {
+        // Check the content of the result before it replaces the original
+        void* data = size > 0 ? mmap(nullptr, size, PROT_READ, MAP_SHARED, out, 0) : nullptr;
+        if (data == MAP_FAILED || agent::hash64(data, size) != hash) {
+            *error = "Patched " + path + " has a different hash";
+            ok = false;
+        }
+
+        if (data != nullptr && data != MAP_FAILED)
+            munmap(data, size);
+    }
+
+    // Write the result to the disk before it is renamed, so that the file is either old or new after a power loss
+    if (ok && fsync(out) != 0) {
+        *error = "Cannot write " + tmpPath + ": " + strerror(errno);
+        ok = false;
+    }
+
+    close(out);
+
+    if (ok && rename(tmpPath.c_str(), path.c_str()) != 0) {
+        *error = "Cannot rename " + tmpPath + ": " + strerror(errno);
+        ok = false;
+    }
+
+    if (!ok)
+        unlink(tmpPath.c_str());
+
+    return ok;
+}
+
+// Handles a single request, saves the response type and payload
+static void handle(uint8_t type, const std::string& payload, uint8_t* responseType, std::string* response) {
+    size_t pos = 0;
+    *responseType = AGENT_OK;
+
+    switch (type) {
+        case AGENT_HELLO: {
+            uint32_t version;
+            if (!agent::get_u32(payload, &pos, &version))
+                break;
+
+            agent::put_u32(response, AGENT_PROTOCOL_VERSION);
+            return;
+        }
+
+        case AGENT_EXEC: {
+            std::string cmd, out, err;
+            if (!agent::get_string(payload, &pos, &cmd))
+                break;
+
+            int rc = exec_command(cmd, &out, &err);
+            agent::put_u32(response, (uint32_t)rc);
+            agent::put_string(response, out);
+            agent::put_string(response, err);
+            return;
+        }
+
+        case AGENT_STATUS: {
+            std::string debugDir;
+            if (!agent::get_string(payload, &pos, &debugDir))
+                break;
+
+            long pgid;
+            agent::put_u8(response, app_running(debugDir, &pgid) ? 1 : 0);
+            return;
+        }
+
+        case AGENT_STOP: {
+            std::string debugDir, cleanup;
+            uint32_t timeout_ms;
+            if (!agent::get_string(payload, &pos, &debugDir) || !agent::get_u32(payload, &pos, &timeout_ms) || !agent::get_string(payload, &pos, &cleanup))
+                break;
+
+            int rc = stop_app(debugDir, timeout_ms, cleanup);
+            if (rc < 0) {
+                *responseType = AGENT_FAILED;
+                agent::put_string(response, "Are you sure that the Application is running?");
+            }
+            else
+                agent::put_u32(response, (uint32_t)rc);
+            return;
+        }
+
+        case AGENT_STAT: {
+            uint32_t count;
+            if (!agent::get_u32(payload, &pos, &count))
+                break;
+
+            std::string entries;
+            uint32_t i = 0;
+            for (std::string path; i < count && agent::get_string(payload, &pos, &path); i++)
+                agent::put_stat(&entries, stat_file(path));
+
+            if (i != count)
+                break;
+
+            agent::put_u32(response, count);
+            response->append(entries);
+            return;
+        }
+
+        case AGENT_OUTPUT: {
+            std::string path, content;
+            uint32_t nbytes;
+            if (!agent::get_string(payload, &pos, &path) || !agent::get_u32(payload, &pos, &nbytes))
+                break;
+
+            if (!tail_file(path, nbytes, &content)) {
+                *responseType = AGENT_FAILED;
+                agent::put_string(response, "Cannot open " + path + ": " + strerror(errno));
+            }
+            else
+                agent::put_string(response, content);
+            return;
+        }
+
+        case AGENT_TIME: {
+            // Read the clock as late as possible
+            struct timespec now;
+            clock_gettime(CLOCK_REALTIME, &now);
+
+            agent::put_u64(response, (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec);
+            return;
+        }
+
+        case AGENT_BLOCKSUMS: {
+            std::string path;
+            uint32_t blockSize;
+            if (!agent::get_string(payload, &pos, &path) || !agent::get_u32(payload, &pos, &blockSize) || blockSize == 0)
+                break;
+
+            if (!block_sums(path, blockSize, response)) {
+                *responseType = AGENT_FAILED;
+                response->clear();
+                agent::put_string(response, "Cannot read " + path + ": " + strerror(errno));
+            }
+            return;
+        }
+
+        case AGENT_HASH: {
+            uint8_t flags;
+            uint32_t count;
+            if (!agent::get_u8(payload, &pos, &flags) || !agent::get_u32(payload, &pos, &count))
+                break;
+
+            // A missing or unreadable file is reported with ok = 0 instead of failing the whole request
+            std::string entries;
+            uint32_t i = 0;
+            std::string path;
+            uint64_t length;
+            for (; i < count && agent::get_string(payload, &pos, &path) && agent::get_u64(payload, &pos, &length); i++) {
+                uint64_t size = 0, hash = 0;
+                bool ok = hash_file(path, length, flags & AGENT_HASH_SYNC, &size, &hash);
+                agent::put_u8(&entries, ok);
+                agent::put_u64(&entries, size);
+                agent::put_u64(&entries, hash);
+            }
+
+            if (i != count)
+                break;
+
+            agent::put_u32(response, count);
+            response->append(entries);
+            return;
+        }
+
+        case AGENT_PATCH: {
+            std::string path, error;
+            uint32_t blockSize;
+            uint64_t size, hash;
+            if (!agent::get_string(payload, &pos, &path) || !agent::get_u32(payload, &pos, &blockSize) || blockSize == 0
+                || !agent::get_u64(payload, &pos, &size) || !agent::get_u64(payload, &pos, &hash))
+                break;
+
+            if (!patch_file(path, blockSize, size, hash, payload, pos, &error)) {
+                *responseType = AGENT_FAILED;
+                agent::put_string(response, error);
+            }
+            return;
+        }
+
+        case AGENT_LINK: {
+            uint32_t count;
+            if (!agent::get_u32(payload, &pos, &count))
+                break;
+
+            // Stop at the first file which couldn't be linked
+            std::string object, path, error;
+            uint32_t mode;
+            uint32_t i = 0;
+            for (; i < count && agent::get_string(payload, &pos, &object) && agent::get_string(payload, &pos, &path) && agent::get_u32(payload, &pos, &mode); i++) {
+                if (!link_file(object, path, (mode_t)mode, &error)) {
+                    *responseType = AGENT_FAILED;
+                    agent::put_string(response, error);
+                    return;
+                }
+            }
+
+            if (i != count)
+                break;
+
+            return;
+        }
+
+        default:
+            *responseType = AGENT_FAILED;
+            agent::put_string(response, "Unknown request type " + std::to_string(type));
+            return;
+    }
+
+    // If the payload couldn't be decoded
+    *responseType = AGENT_FAILED;
+    response->clear();
+    agent::put_string(response, "Invalid payload");
+}
+
+// Handles requests from the input until it is closed, writes the responses to the output
+static void serve(int in, int out) {
+    while (true) {
+        // Read the length of the frame
+        std::string header(4, '\0');
+        if (!read_exact(in, &header[0], 4))
+            return;
+
+        size_t pos = 0;
+        uint32_t length = 0;
+        agent::get_u32(header, &pos, &length);
+
+        // Reject frames which are too short or too long
+        if (length < AGENT_HEADER_SIZE - 4 || length > AGENT_MAX_FRAME)
+            return;
+
+        // Read the rest of the frame
+        std::string frame(length, '\0');
+        if (!read_exact(in, &frame[0], length))
+            return;
+
+        pos = 0;
+        uint32_t id = 0;
+        uint8_t type = 0;
+        agent::get_u32(frame, &pos, &id);
+        agent::get_u8(frame, &pos, &type);
+
+        // Handle the request and send the response with the same ID
+        uint8_t responseType;
+        std::string response;
+        handle(type, frame.substr(pos), &responseType, &response);
+
+        if (!write_all(out, agent::frame(id, responseType, response)))
+            return;
+    }
+}
+
+// Listens on the Unix socket and serves every connection inside its own child process
+static int listen_socket(const char* path) {
+    struct sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Socket path too long: %s\n", path);
+        return EXIT_FAILURE;
+    }
+    strcpy(addr.sun_path, path);
+
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server < 0) {
+        perror("socket");
+        return EXIT_FAILURE;
+    }
+
+    // The folder of the socket must only be changeable by the user, else another user could listen on the socket first
+    std::string folder = path;
+    size_t slash = folder.rfind('/');
+    folder = slash == std::string::npos ? "." : slash == 0 ? "/" : folder.substr(0, slash);
+
+    struct stat st;
+    if (lstat(folder.c_str(), &st) != 0 || !S_ISDIR(st.st_mode) || st.st_uid != getuid() || (st.st_mode & (S_IWGRP | S_IWOTH)) != 0) {
+        fprintf(stderr, "The folder of the socket %s has to belong to the user and must not be writable by others\n", path);
+        close(server);
+        return EXIT_FAILURE;
+    }
+
+    // If another agent of the user already listens on the socket there is nothing to do
+    if (connect(server, (struct sockaddr*)&addr, sizeof(addr)) == 0) {
+        struct ucred peer;
+        socklen_t length = sizeof(peer);
+        bool own = getsockopt(server, SOL_SOCKET, SO_PEERCRED, &peer, &length) == 0 && peer.uid == getuid();
+        close(server);
+
+        if (own)
+            return EXIT_SUCCESS;
+
+        fprintf(stderr, "Another user listens on the socket %s\n", path);
+        return EXIT_FAILURE;
+    }
+
+    // Remove a stale socket of an exited agent, only the owner may connect
+    unlink(path);
+    umask(0077);
+
+    if (bind(server, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(server, 16) != 0) {
+        perror(path);
+        return EXIT_FAILURE;
+    }
+
+    // Reap the child processes automatically
+    signal(SIGCHLD, SIG_IGN);
+
+    // Accept connections until no new one arrived within the idle timeout
+    struct pollfd fds = { server, POLLIN, 0 };
+    while (true) {
+        int ready = poll(&fds, 1, AGENT_IDLE_TIMEOUT * 1000);
+        if (ready < 0 && errno == EINTR)
+            continue;
+        if (ready <= 0)
+            break;
+
+        int client = accept(server, nullptr, nullptr);
+        if (client < 0)
+            continue;
+
+        if (fork() == 0) {
+            // Child: restore the default, so that the exit code of executed commands can be waited for
+            signal(SIGCHLD, SIG_DFL);
+            close(server);
+
+            serve(client, client);
+            _exit(EXIT_SUCCESS);
+        }
+
+        close(client);
+    }
+
+    // Remove the socket so that the next SSH executable starts a new agent
+    unlink(path);
+    close(server);
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char* argv[]) {
+    // Print the protocol version, used to check a built agent
+    if (argc > 1 && strcmp(argv[1], "--version") == 0) {
+        printf("%d\n", AGENT_PROTOCOL_VERSION);
+        return EXIT_SUCCESS;
+    }
+
+    // Don't terminate if the SSH executable closes the connection while a response is written
+    signal(SIGPIPE, SIG_IGN);
+
+    // Serve connections on the given socket
+    if (argc > 2 && strcmp(argv[1], "--listen") == 0)
+        return listen_socket(argv[2]);
+
+    // Else serve a single connection on stdin/stdout
+    serve(STDIN_FILENO, STDOUT_FILENO);
+    return EXIT_SUCCESS;
+}
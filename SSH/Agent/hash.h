@@ -0,0 +1,152 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Primes of XXH64
+#define AGENT_HASH_PRIME1		0x9E3779B185EBCA87ULL
+#define AGENT_HASH_PRIME2		0xC2B2AE3D27D4EB4FULL
+#define AGENT_HASH_PRIME3		0x165667B19E3779F9ULL
+#define AGENT_HASH_PRIME4		0x85EBCA77C2B2AE63ULL
+#define AGENT_HASH_PRIME5		0x27D4EB2F165667C5ULL
+
+/// <summary>
+/// Content hash of files (XXH64), used by the SSH executable and the agent so that both sides compute the same value without further libraries.
+/// The four independent lanes of the main loop keep all execution units of the CPU busy, the hash runs at several GB/s and is limited by the disk
+/// </summary>
+namespace agent {
+
+	/// <summary>
+	/// Rotates the value left by the given number of bits
+	/// </summary>
+	inline uint64_t hash_rotl(uint64_t value, int bits) {
+		return (value << bits) | (value >> (64 - bits));
+	}
+
+	/// <summary>
+	/// Reads 8 resp. 4 Bytes (little endian, like the host and the Raspberry Pi) from an unaligned address
+	/// </summary>
+	inline uint64_t hash_read64(const uint8_t* p) { uint64_t value; memcpy(&value, p, 8); return value; }
+	inline uint32_t hash_read32(const uint8_t* p) { uint32_t value; memcpy(&value, p, 4); return value; }
+
+	/// <summary>
+	/// Mixes 8 Bytes of input into one lane
+	/// </summary>
+	inline uint64_t hash_round(uint64_t acc, uint64_t input) {
+		acc += input * AGENT_HASH_PRIME2;
+		acc = hash_rotl(acc, 31);
+		return acc * AGENT_HASH_PRIME1;
+	}
+
+	/// <summary>
+	/// Merges one lane into the hash
+	/// </summary>
+	inline uint64_t hash_merge(uint64_t hash, uint64_t lane) {
+		hash ^= hash_round(0, lane);
+		return hash * AGENT_HASH_PRIME1 + AGENT_HASH_PRIME4;
+	}
+
+	/// <summary>
+	/// Hashes count Bytes of the data (XXH64)
+	/// </summary>
+	/// <param name="data">Pointer to the data, may be nullptr if count is 0</param>
+	/// <param name="count">Number of Bytes</param>
+	/// <param name="seed">Optional, seed of the hash (default: 0)</param>
+	/// <returns>The 64 bit hash</returns>
+	inline uint64_t hash64(const void* data, size_t count, uint64_t seed = 0) {
+		const uint8_t* p = (const uint8_t*)data;
+		const uint8_t* end = p + count;
+		uint64_t hash;
+
+		if (count >= 32) {
+			// Four lanes which are processed independently, one 8 Byte word each per 32 Byte stripe
+			uint64_t v1 = seed + AGENT_HASH_PRIME1 + AGENT_HASH_PRIME2;
+			uint64_t v2 = seed + AGENT_HASH_PRIME2;
+			uint64_t v3 = seed;
+			uint64_t v4 = seed - AGENT_HASH_PRIME1;
+
+			for (const uint8_t* limit = end - 32; p <= limit; p += 32) {
+				v1 = hash_round(v1, hash_read64(p));
+				v2 = hash_round(v2, hash_read64(p + 8));
+				v3 = hash_round(v3, hash_read64(p + 16));
+				v4 = hash_round(v4, hash_read64(p + 24));
+			}
+
+			// Combine the lanes
+			hash = hash_rotl(v1, 1) + hash_rotl(v2, 7) + hash_rotl(v3, 12) + hash_rotl(v4, 18);
+			hash = hash_merge(hash, v1);
+			hash = hash_merge(hash, v2);
+			hash = hash_merge(hash, v3);
+			hash = hash_merge(hash, v4);
+		}
+		else
+			hash = seed + AGENT_HASH_PRIME5;
+
+		hash += (uint64_t)count;
+
+		// Mix in the remaining Bytes, 8, 4, and 1 at a time
+		for (; p + 8 <= end; p += 8)
+			hash = hash_rotl(hash ^ hash_round(0, hash_read64(p)), 27) * AGENT_HASH_PRIME1 + AGENT_HASH_PRIME4;
+
+		if (p + 4 <= end) {
+			hash = hash_rotl(hash ^ (hash_read32(p) * AGENT_HASH_PRIME1), 23) * AGENT_HASH_PRIME2 + AGENT_HASH_PRIME3;
+			p += 4;
+		}
+
+		for (; p < end; p++)
+			hash = hash_rotl(hash ^ (*p * AGENT_HASH_PRIME5), 11) * AGENT_HASH_PRIME1;
+
+		// Final avalanche so that every input bit affects every output bit
+		hash ^= hash >> 33;
+		hash *= AGENT_HASH_PRIME2;
+		hash ^= hash >> 29;
+		hash *= AGENT_HASH_PRIME3;
+		hash ^= hash >> 32;
+
+		return hash;
+	}
+
+	/// <summary>
+	/// Weak rolling checksum of a block (like rsync): the sum of the Bytes and the sum of the prefix sums, 16 bits each.
+	/// It can be moved forward by one Byte in constant time, so that a block can be searched at every offset of a file
+	/// </summary>
+	struct RollingSum {
+		uint32_t a = 0, b = 0;
+		uint32_t length = 0;
+
+		/// <summary>
+		/// Computes the checksum of a block
+		/// </summary>
+		/// <param name="data">Pointer to the block</param>
+		/// <param name="count">Number of Bytes of the block</param>
+		void init(const void* data, uint32_t count) {
+			const uint8_t* p = (const uint8_t*)data;
+			a = b = 0;
+			length = count;
+
+			for (uint32_t i = 0; i < count; i++) {
+				a += p[i];
+				b += (count - i) * (uint32_t)p[i];
+			}
+		}
+
+		/// <summary>
+		/// Moves the block forward by one Byte
+		/// </summary>
+		/// <param name="out">The first Byte of the block, which is removed</param>
+		/// <param name="in">The Byte after the block, which is appended</param>
+		void roll(uint8_t out, uint8_t in) {
+			a += in - out;
+			b += a - length * out;
+		}
+
+		/// <summary>
+		/// Returns the checksum, the lower 16 bits of both sums
+		/// </summary>
+		uint32_t digest() const {
+			return (a & 0xFFFF) | (b << 16);
+		}
+	};
+
+}
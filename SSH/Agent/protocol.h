@@ -0,0 +1,173 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+
+// Version of the protocol, must be equal for the SSH executable and the agent
+#define AGENT_PROTOCOL_VERSION	8
+
+// Request types sent by the SSH executable
+#define AGENT_HELLO				0x01	// Payload: u32 protocol version					Response: u32 protocol version
+#define AGENT_EXEC				0x02	// Payload: string command						Response: i32 exit code, string stdout, string stderr
+#define AGENT_STATUS			0x03	// Payload: string Debug folder					Response: u8 running
+#define AGENT_STOP				0x04	// Payload: string Debug folder, u32 timeout (ms),	Response: i32 exit code of the application
+										//			string command run in the Debug folder after SIGKILL
+#define AGENT_STAT				0x05	// Payload: u32 count, count * string path		Response: u32 count, count * stat entry (see put_stat)
+#define AGENT_OUTPUT			0x06	// Payload: string file, u32 nbytes				Response: string last nbytes Bytes of the file
+#define AGENT_TIME				0x07	// Payload: none									Response: u64 time (ns since the Unix epoch)
+#define AGENT_BLOCKSUMS			0x08	// Payload: string path, u32 block size			Response: u64 file size, u32 count, count * (u32 weak, u64 strong) checksum
+#define AGENT_PATCH				0x09	// Payload: string path, u32 block size,			Response: none, the file is replaced atomically if the result has the size and hash
+										//			u64 size, u64 hash, u32 count, count * delta operation (see below)
+#define AGENT_HASH				0x0A	// Payload: u8 flags, u32 count, count * (string path,	Response: u32 count, count * (u8 ok, u64 file size, u64 hash of the prefix)
+										//			u64 length of the prefix, UINT64_MAX for the whole file)
+#define AGENT_LINK				0x0B	// Payload: u32 count, count * (string object,		Response: none, every path is replaced atomically by a hard link to its object
+										//			string path, u32 mode of the object)
+
+// Response types sent by the agent
+#define AGENT_OK				0x80	// Payload depends on the request
+#define AGENT_FAILED			0x81	// Payload: string error message
+
+// Size of the frame header: length (4 Bytes), request ID (4 Bytes), and type (1 Byte)
+// The length counts the Bytes after the length field i.e., request ID, type, and payload
+#define AGENT_HEADER_SIZE		9
+
+// Maximum length of a frame, longer frames are treated as protocol error
+#define AGENT_MAX_FRAME			(64u * 1024u * 1024u)
+
+// Operations of a delta (AGENT_PATCH), the new file is the concatenation of the operations
+#define AGENT_DELTA_COPY		0		// Payload: u32 first block, u32 number of blocks of the old file
+#define AGENT_DELTA_DATA		1		// Payload: string literal data
+
+// Flags of AGENT_HASH: write the files to the storage and drop them from the page cache first, so that the hash is computed from what was stored
+#define AGENT_HASH_SYNC			0x01
+
+// File types of a stat entry
+#define AGENT_TYPE_MISSING		0
+#define AGENT_TYPE_FILE			1
+#define AGENT_TYPE_DIR			2
+#define AGENT_TYPE_OTHER		3
+
+/// <summary>
+/// Functions to encode and decode frames and their payload (little endian), used by the SSH executable and the agent
+/// </summary>
+namespace agent {
+
+	/// <summary>
+	/// Information about a file, payload of a stat entry
+	/// </summary>
+	struct Stat {
+		uint8_t type = AGENT_TYPE_MISSING;
+		uint32_t mode = 0;
+		uint64_t size = 0, inode = 0;
+		int64_t mtime_ns = 0;
+	};
+
+	/// <summary>
+	/// Appends an unsigned integer with the given number of Bytes to the data
+	/// </summary>
+	inline void put_uint(std::string* data, uint64_t value, int nbytes) {
+		for (int i = 0; i < nbytes; i++)
+			data->push_back((char)((value >> (8 * i)) & 0xFF));
+	}
+
+	inline void put_u8(std::string* data, uint8_t value)	{ put_uint(data, value, 1); }
+	inline void put_u32(std::string* data, uint32_t value)	{ put_uint(data, value, 4); }
+	inline void put_u64(std::string* data, uint64_t value)	{ put_uint(data, value, 8); }
+
+	/// <summary>
+	/// Appends a string with its length (u32) to the data
+	/// </summary>
+	inline void put_string(std::string* data, const std::string& value) {
+		put_u32(data, (uint32_t)value.size());
+		data->append(value);
+	}
+
+	/// <summary>
+	/// Appends a stat entry: u8 type, u32 mode, u64 size, u64 inode, u64 mtime (ns)
+	/// </summary>
+	inline void put_stat(std::string* data, const Stat& stat) {
+		put_u8(data, stat.type);
+		put_u32(data, stat.mode);
+		put_u64(data, stat.size);
+		put_u64(data, stat.inode);
+		put_u64(data, (uint64_t)stat.mtime_ns);
+	}
+
+	/// <summary>
+	/// Reads an unsigned integer with the given number of Bytes at the position, advances the position
+	/// </summary>
+	/// <returns>true on success, false if the data is too short</returns>
+	inline bool get_uint(const std::string& data, size_t* pos, uint64_t* value, int nbytes) {
+		if (*pos + nbytes > data.size())
+			return false;
+
+		*value = 0;
+		for (int i = 0; i < nbytes; i++)
+			*value |= (uint64_t)(unsigned char)data[*pos + i] << (8 * i);
+
+		*pos += nbytes;
+		return true;
+	}
+
+	inline bool get_u8(const std::string& data, size_t* pos, uint8_t* value) {
+		uint64_t v;
+		if (!get_uint(data, pos, &v, 1))
+			return false;
+		*value = (uint8_t)v;
+		return true;
+	}
+
+	inline bool get_u32(const std::string& data, size_t* pos, uint32_t* value) {
+		uint64_t v;
+		if (!get_uint(data, pos, &v, 4))
+			return false;
+		*value = (uint32_t)v;
+		return true;
+	}
+
+	inline bool get_u64(const std::string& data, size_t* pos, uint64_t* value) {
+		return get_uint(data, pos, value, 8);
+	}
+
+	/// <summary>
+	/// Reads a string with its length (u32) at the position, advances the position
+	/// </summary>
+	/// <returns>true on success, false if the data is too short</returns>
+	inline bool get_string(const std::string& data, size_t* pos, std::string* value) {
+		uint32_t length;
+		if (!get_u32(data, pos, &length) || *pos + length > data.size())
+			return false;
+
+		value->assign(data, *pos, length);
+		*pos += length;
+		return true;
+	}
+
+	/// <summary>
+	/// Reads a stat entry at the position, advances the position
+	/// </summary>
+	/// <returns>true on success, false if the data is too short</returns>
+	inline bool get_stat(const std::string& data, size_t* pos, Stat* stat) {
+		uint64_t mtime;
+		if (!get_u8(data, pos, &stat->type) || !get_u32(data, pos, &stat->mode) || !get_u64(data, pos, &stat->size)
+			|| !get_u64(data, pos, &stat->inode) || !get_u64(data, pos, &mtime))
+			return false;
+
+		stat->mtime_ns = (int64_t)mtime;
+		return true;
+	}
+
+	/// <summary>
+	/// Creates a frame from the request ID, type, and payload
+	/// </summary>
+	inline std::string frame(uint32_t id, uint8_t type, const std::string& payload) {
+		std::string data;
+		put_u32(&data, (uint32_t)(AGENT_HEADER_SIZE - 4 + payload.size()));
+		put_u32(&data, id);
+		put_u8(&data, type);
+		data.append(payload);
+		return data;
+	}
+
+}
@@ -0,0 +1,209 @@
+#include "Bandwidth.h"
+
+// When compiling on Windows
+#ifdef WIN32
+    #include <fcntl.h>
+    #include <io.h>
+    #include <sys/stat.h>
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+    #include <windows.h>
+#else
+    #include <arpa/inet.h>
+    #include <fcntl.h>
+    #include <netdb.h>
+    #include <sys/file.h>
+    #include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <system_error>
+#include <thread>
+
+// Returns the current time of the steady clock in nanoseconds, only used for the intervals of this process
+static int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Returns the current time of the system clock in nanoseconds, the shared buckets keep it because it stays valid across reboots
+static int64_t wall_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Locks or unlocks the file of a shared bucket exclusively, waits until the lock is free
+static bool lock_file(int fd, bool lock) {
+#ifdef WIN32
+    HANDLE handle = (HANDLE)_get_osfhandle(fd);
+    OVERLAPPED overlapped = {};
+    return lock ? LockFileEx(handle, LOCKFILE_EXCLUSIVE_LOCK, 0, 1, 0, &overlapped) : UnlockFileEx(handle, 0, 1, 0, &overlapped);
+#else
+    return flock(fd, lock ? LOCK_EX : LOCK_UN) == 0;
+#endif
+}
+
+// Reads the time at which a shared bucket is empty again, a new (empty) file is an empty bucket
+static int64_t read_full(int fd) {
+    int64_t full = 0;
+#ifdef WIN32
+    if (_lseek(fd, 0, SEEK_SET) != 0 || _read(fd, &full, sizeof(full)) != sizeof(full))
+#else
+    if (pread(fd, &full, sizeof(full), 0) != sizeof(full))
+#endif
+        return 0;
+
+    return full;
+}
+
+// Writes the time at which a shared bucket is empty again
+static void write_full(int fd, int64_t full) {
+#ifdef WIN32
+    if (_lseek(fd, 0, SEEK_SET) == 0)
+        _write(fd, &full, sizeof(full));
+#else
+    if (pwrite(fd, &full, sizeof(full), 0) != sizeof(full))
+        return;
+#endif
+}
+
+// Returns the name of the /24 subnet of an address (e.g., 192.168.1.0-24), the address itself if it can't be resolved to IPv4
+static std::string subnet_of(const std::string& addr) {
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+
+    addrinfo* result = nullptr;
+    if (getaddrinfo(addr.c_str(), nullptr, &hints, &result) != 0 || result == nullptr)
+        return addr;
+
+    uint32_t ip = ntohl(((sockaddr_in*)result->ai_addr)->sin_addr.s_addr);
+    freeaddrinfo(result);
+
+    return std::format("{}.{}.{}.0-24", ip >> 24, (ip >> 16) & 0xFF, (ip >> 8) & 0xFF);
+}
+
+// Destructor
+Bandwidth::~Bandwidth() {
+    // Close the buckets and remove the rate file
+    close();
+}
+
+bool Bandwidth::open(const std::string& addr, unsigned int port, uint64_t globalRate, uint64_t subnetRate, uint64_t hostRate) {
+    // Close previously opened buckets
+    close();
+
+    std::error_code ec;
+    std::filesystem::path folder = std::filesystem::temp_directory_path(ec) / BANDWIDTH_FOLDER;
+    std::filesystem::create_directories(folder, ec);
+
+    // The rate is shown by the GUI even if the transfers aren't limited, it is named like the GUI names the Raspberry Pi (the port only if it isn't 22),
+    // characters which can't be part of a file name are replaced
+    std::string name = port == 22 ? addr : std::format("{}:{}", addr, port);
+    std::replace_if(name.begin(), name.end(), [](char c) { return c == '/' || c == '\\' || c == ':'; }, '_');
+    rateFile = (folder / (name + ".rate")).string();
+    intervalBegin = now_ns();
+    intervalBytes = 0;
+
+    // Open the shared buckets in a fixed order (global, then subnet), so that processes which lock both can't deadlock
+    bool success = true;
+    if (globalRate > 0)
+        success &= open_shared("global.bucket", globalRate);
+
+    if (subnetRate > 0)
+        success &= open_shared(std::format("subnet-{}.bucket", subnet_of(addr)), subnetRate);
+
+    // The bucket of the SSH client only limits this process
+    if (hostRate > 0)
+        buckets.push_back({ hostRate, 0, -1 });
+
+    return success;
+}
+
+bool Bandwidth::open_shared(const std::string& name, uint64_t rate) {
+    std::error_code ec;
+    std::string path = (std::filesystem::temp_directory_path(ec) / BANDWIDTH_FOLDER / name).string();
+
+    // Open the file of the bucket, the first process creates it (an empty file is an empty bucket)
+#ifdef WIN32
+    int fd = _open(path.c_str(), _O_RDWR | _O_CREAT | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0666);
+#endif
+    if (fd < 0)
+        return false;
+
+    buckets.push_back({ rate, 0, fd });
+    return true;
+}
+
+void Bandwidth::close() {
+    // Close the files of the shared buckets
+    for (Bucket& bucket : buckets)
+        if (bucket.fd >= 0)
+#ifdef WIN32
+            _close(bucket.fd);
+#else
+            ::close(bucket.fd);
+#endif
+
+    buckets.clear();
+
+    // The transfers are finished, remove the rate from the GUI
+    if (!rateFile.empty()) {
+        std::error_code ec;
+        std::filesystem::remove(rateFile, ec);
+        rateFile.clear();
+    }
+}
+
+void Bandwidth::acquire(size_t nbytes) {
+    if (!buckets.empty()) {
+        // Lock the shared buckets and read how full they are, a time too far ahead is stale (e.g., the clock was set back) and the bucket is reset
+        int64_t now = wall_ns();
+        for (Bucket& bucket : buckets) {
+            if (bucket.fd >= 0) {
+                lock_file(bucket.fd, true);
+                bucket.full = read_full(bucket.fd);
+                if (bucket.full > now + BANDWIDTH_MAX_WAIT_MS * 1000000LL)
+                    bucket.full = now;
+            }
+        }
+
+        // The transfer may start when every bucket has room for it, an unused bucket may be ahead by the burst
+        int64_t start = now;
+        for (const Bucket& bucket : buckets)
+            start = std::max<int64_t>(start, bucket.full - BANDWIDTH_BURST_MS * 1000000LL);
+
+        // Reserve the Bytes in all buckets, then let the other processes reserve theirs behind them
+        for (Bucket& bucket : buckets) {
+            bucket.full = std::max<int64_t>(bucket.full, start) + (int64_t)(nbytes * 1000000000.0 / bucket.rate);
+
+            if (bucket.fd >= 0) {
+                write_full(bucket.fd, bucket.full);
+                lock_file(bucket.fd, false);
+            }
+        }
+
+        // Wait until the reserved time
+        if (start > now)
+            std::this_thread::sleep_for(std::chrono::nanoseconds(start - now));
+    }
+
+    // Save the rate of the last interval for the GUI, through a temporary file so that it is never read half-written
+    intervalBytes += nbytes;
+    int64_t now = now_ns();
+    if (!rateFile.empty() && now - intervalBegin >= BANDWIDTH_RATE_INTERVAL * 1000000LL) {
+        uint64_t rate = (uint64_t)(intervalBytes * 1000000000.0 / (now - intervalBegin));
+
+        std::string tmpFile = rateFile + ".tmp";
+        std::ofstream(tmpFile) << rate << std::endl;
+
+        std::error_code ec;
+        std::filesystem::rename(tmpFile, rateFile, ec);
+
+        intervalBegin = now;
+        intervalBytes = 0;
+    }
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+// Name of the folder inside the temporary folder which holds the shared token buckets and the current rates of the transfers
+#define BANDWIDTH_FOLDER		"pideploy-bandwidth"
+
+// Milliseconds of transfer at the full rate which a bucket may save up while it isn't used (burst)
+#define BANDWIDTH_BURST_MS		100
+
+// Milliseconds which a shared bucket may be reserved ahead, a later time is left over from a clock which was set back and is reset
+#define BANDWIDTH_MAX_WAIT_MS	60000
+
+// Milliseconds between two updates of the rate file of a transfer, the GUI ignores rate files older than two intervals
+#define BANDWIDTH_RATE_INTERVAL	500
+
+/// <summary>
+/// Limits the rate of the transfers to an SSH client with token buckets. The global bucket and the bucket of the subnet (/24) are files
+/// shared by all SSH processes on the host, the bucket of the SSH client belongs to this process. The buckets are kept as the time
+/// at which they are empty again (GCRA), a transfer reserves its Bytes in all buckets at once and waits until the fullest one allows it.
+/// The reservations are served in the order of their requests, so that concurrent uploads which send chunks of the same size share the rate fairly,
+/// and the rate left by an upload with a lower cap is used by the others
+/// </summary>
+class Bandwidth {
+
+public:
+	/// <summary>
+	/// Constructor for initialization, doesn't limit anything yet
+	/// </summary>
+	Bandwidth() = default;
+
+	/// <summary>
+	/// Destructor automatically closes the buckets and removes the rate file
+	/// </summary>
+	~Bandwidth();
+
+	// The buckets can't be copied, their files would be closed twice
+	Bandwidth(const Bandwidth&) = delete;
+	Bandwidth& operator=(const Bandwidth&) = delete;
+
+	/// <summary>
+	/// Opens the buckets for the transfers to an SSH client, previously opened buckets are closed before
+	/// </summary>
+	/// <param name="addr">Address of the SSH client, its subnet and the name of its rate file are derived from it</param>
+	/// <param name="port">Port of the SSH client, part of the name of the rate file unless it is 22</param>
+	/// <param name="globalRate">Rate of all transfers of the host in Bytes per second, 0 for unlimited</param>
+	/// <param name="subnetRate">Rate of all transfers of the host to the subnet of the SSH client in Bytes per second, 0 for unlimited</param>
+	/// <param name="hostRate">Rate of the transfers to the SSH client in Bytes per second, 0 for unlimited</param>
+	/// <returns>true on success, false if a shared bucket couldn't be opened (the transfers aren't limited by it then)</returns>
+	bool open(const std::string& addr, unsigned int port, uint64_t globalRate, uint64_t subnetRate, uint64_t hostRate);
+
+	/// <summary>
+	/// Closes the buckets and removes the rate file
+	/// </summary>
+	void close();
+
+	/// <summary>
+	/// Waits until the given number of Bytes may be transferred and counts them for the current rate
+	/// </summary>
+	/// <param name="nbytes">Number of Bytes which are about to be sent or received</param>
+	void acquire(size_t nbytes);
+
+private:
+	/// <summary>
+	/// Token bucket with the time (nanoseconds of the system clock) at which it is empty again
+	/// </summary>
+	struct Bucket {
+		uint64_t rate = 0;
+		int64_t full = 0;
+
+		// File of a shared bucket, -1 for the bucket of this process
+		int fd = -1;
+	};
+
+	/// <summary>
+	/// Buckets which limit the transfers, the shared ones first in the order in which they are locked
+	/// </summary>
+	std::vector<Bucket> buckets;
+
+	/// <summary>
+	/// Path of the file in which the current rate is saved for the GUI, empty if no bucket is opened
+	/// </summary>
+	std::string rateFile;
+
+	/// <summary>
+	/// Begin (nanoseconds of the steady clock) and number of Bytes of the current interval of the rate
+	/// </summary>
+	int64_t intervalBegin = 0;
+	uint64_t intervalBytes = 0;
+
+	/// <summary>
+	/// Opens (or creates) the file of a shared bucket
+	/// </summary>
+	/// <param name="name">Name of the bucket file inside the bandwidth folder</param>
+	/// <param name="rate">Rate of the bucket in Bytes per second</param>
+	/// <returns>true on success, false if the file couldn't be opened</returns>
+	bool open_shared(const std::string& name, uint64_t rate);
+
+};
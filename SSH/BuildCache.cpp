@@ -0,0 +1,204 @@
+#include "BuildCache.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <random>
+#include <system_error>
+#include <tuple>
+#include <vector>
+
+#include <libssh/libssh.h>
+
+// Milliseconds to wait for the next Bytes of a request, a stuck compiler's request is closed afterwards
+#define BUILD_CACHE_TIMEOUT 10000
+
+// Returns the current time of the steady clock in milliseconds, for the timeouts of the requests
+static int64_t now_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Writes the whole data to the channel
+static bool write_all(ssh_channel channel, const std::string& data) {
+    return ssh_channel_write(channel, data.data(), (uint32_t)data.size()) == (int)data.size();
+}
+
+bool BuildCache::open(const std::string& folder, uint64_t maxSize) {
+    this->folder = folder;
+    this->maxSize = maxSize;
+
+    // Close the requests of the last build and create the token of this one, so that only its compilers are answered
+    discard();
+    std::random_device random;
+    buildToken = std::format("{:08x}{:08x}{:08x}{:08x}", random(), random(), random(), random());
+
+    // Reset the statistics of the last build
+    hits = misses = stored = 0;
+    servedBytes = 0;
+
+    // Create the folder, it may already exist
+    std::error_code ec;
+    std::filesystem::create_directories(folder, ec);
+
+    return std::filesystem::is_directory(folder, ec);
+}
+
+std::string BuildCache::object_path(const std::string& key) const {
+    // Only accept hashes, so that a key can't name a file outside of the cache
+    if (key.length() != 32 || !std::all_of(key.begin(), key.end(), [](char c) { return isdigit(c) || (c >= 'a' && c <= 'f'); }))
+        return "";
+
+    return (std::filesystem::path(folder) / key.substr(0, 2) / key).string();
+}
+
+void BuildCache::accept(ssh_channel channel) {
+    // The request is read by serve, the compiler has to send its next Bytes within the timeout
+    requests.push_back({ channel, "", now_ms() + BUILD_CACHE_TIMEOUT });
+}
+
+void BuildCache::serve() {
+    char buffer[65536];
+    int64_t now = now_ms();
+
+    for (size_t i = 0; i < requests.size();) {
+        Request& request = requests[i];
+
+        // Read what the compiler sent meanwhile without waiting for more
+        int nbytes;
+        while ((nbytes = ssh_channel_read_nonblocking(request.channel, buffer, sizeof(buffer), 0)) > 0) {
+            request.data.append(buffer, nbytes);
+            request.deadline = now + BUILD_CACHE_TIMEOUT;
+        }
+        bool closed = nbytes < 0 || ssh_channel_is_eof(request.channel);
+
+        // The request line ends with a newline, a PUT is followed by the object file
+        size_t newline = request.data.find('\n');
+        uint64_t size = 0;
+        char commandText[8] = "", tokenText[40] = "", keyText[40] = "", sizeText[32] = "";
+        if (newline != std::string::npos && sscanf(request.data.substr(0, newline).c_str(), "%7s %39s %39s %31s", commandText, tokenText, keyText, sizeText) >= 3)
+            size = strtoull(sizeText, nullptr, 10);
+
+        // Wait for the rest of the request, unless the compiler closed the connection or is stuck, or the request line is too long
+        bool complete = newline != std::string::npos && (strcmp(commandText, "PUT") != 0 || size > BUILD_CACHE_MAX_OBJECT ||
+            request.data.size() - newline - 1 >= size);
+        if (!complete && !closed && now < request.deadline && (newline != std::string::npos || request.data.size() < 4096)) {
+            i++;
+            continue;
+        }
+
+        // Answer a complete request of a compiler of this build
+        if (complete && buildToken == tokenText)
+            answer(request.channel, commandText, keyText, size, request.data.substr(newline + 1));
+
+        // Send an end of file, close and free the channel, the compiler treats every other answer as a miss
+        ssh_channel_send_eof(request.channel);
+        ssh_channel_close(request.channel);
+        ssh_channel_free(request.channel);
+        requests.erase(requests.begin() + i);
+    }
+}
+
+void BuildCache::discard() {
+    // Close and free the channels of the requests which weren't answered
+    for (Request& request : requests) {
+        ssh_channel_close(request.channel);
+        ssh_channel_free(request.channel);
+    }
+
+    requests.clear();
+}
+
+void BuildCache::answer(ssh_channel channel, const std::string& command, const std::string& key, uint64_t size, const std::string& object) {
+    std::string path = object_path(key);
+
+    // If the compiler asks for an object file
+    if (command == "GET" && !path.empty()) {
+        // Read the object file, a missing or unreadable file is a miss
+        std::ifstream file(path, std::ifstream::binary);
+        std::string object;
+        if (file.is_open())
+            object.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+        if (file.is_open() && !file.bad()) {
+            // Send the size and the object file
+            if (write_all(channel, std::format("HIT {}\n", object.size())) && write_all(channel, object)) {
+                hits++;
+                servedBytes += object.size();
+            }
+
+            // Mark the object file as recently used, so that prune keeps it
+            std::error_code ec;
+            std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+        }
+        else {
+            write_all(channel, "MISS\n");
+            misses++;
+        }
+    }
+    // If the compiler stores a new object file
+    else if (command == "PUT" && !path.empty() && size > 0 && size <= BUILD_CACHE_MAX_OBJECT && object.size() == size) {
+        // Write it under a temporary name and rename it, so that other SSH processes never read it half-written
+        std::error_code ec;
+        std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+
+        std::random_device random;
+        std::string tmpPath = std::format("{}.tmp{:08x}", path, random());
+        std::ofstream(tmpPath, std::ofstream::binary).write(object.data(), object.size());
+
+        if (std::filesystem::file_size(tmpPath, ec) == size) {
+            std::filesystem::rename(tmpPath, path, ec);
+            if (!ec) {
+                write_all(channel, "OK\n");
+                stored++;
+            }
+        }
+
+        std::filesystem::remove(tmpPath, ec);
+    }
+}
+
+std::string BuildCache::token() const {
+    return buildToken;
+}
+
+void BuildCache::prune() {
+    // Collect the object files with their last use and size, temporary files are still written by other SSH processes
+    std::vector<std::tuple<std::filesystem::file_time_type, uint64_t, std::filesystem::path>> objects;
+    uint64_t total = 0;
+
+    std::error_code ec;
+    for (auto it = std::filesystem::recursive_directory_iterator(folder, ec); !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+        if (!it->is_regular_file(ec) || it->path().filename().string().find(".tmp") != std::string::npos)
+            continue;
+
+        uint64_t size = it->file_size(ec);
+        objects.emplace_back(it->last_write_time(ec), size, it->path());
+        total += size;
+    }
+
+    // Remove the least recently used object files until the cache fits, a file which is in use by another process may remain
+    std::sort(objects.begin(), objects.end());
+    for (auto& [time, size, path] : objects) {
+        if (total <= maxSize)
+            break;
+
+        if (std::filesystem::remove(path, ec))
+            total -= size;
+    }
+}
+
+std::string BuildCache::statistics() const {
+    // No statistics if no compile job asked the cache (e.g., the build was skipped)
+    if (hits + misses == 0)
+        return "";
+
+    return std::format("Compiler cache: {} hit(s), {} miss(es) ({}% hit rate), {} object file(s) stored, {:.1f} KiB served.",
+        hits, misses, hits * 100 / (hits + misses), stored, servedBytes / 1024.0);
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+typedef struct ssh_channel_struct*	ssh_channel;
+
+// Name of the folder inside the temporary folder which holds the compiler cache with the option cache=yes
+#define BUILD_CACHE_FOLDER		"pideploy-cache"
+
+// Default size of the compiler cache in MiB, can be changed with the option cacheSize
+#define BUILD_CACHE_SIZE		1024
+
+// Largest object file in Bytes which is accepted into the compiler cache
+#define BUILD_CACHE_MAX_OBJECT	(256 * 1024 * 1024)
+
+/// <summary>
+/// Compiler cache on the host which is shared by all Raspberry Pis, every SSH process of the host uses the same folder. The compiler on the
+/// Raspberry Pi connects to it through a port which the SSH client forwards to the host, and sends one request per connection:
+/// "GET token key" is answered with "HIT size" and the object file or with "MISS", "PUT token key size" followed by the object file is answered with "OK".
+/// The token is created for every build and only passed to its compilers, requests with another token aren't answered.
+/// The key is the hash of the fingerprint of the Raspberry Pi, the compiler and its flags, and the preprocessed source,
+/// so that only compatible Raspberry Pis get the same object file
+/// </summary>
+class BuildCache {
+
+public:
+	/// <summary>
+	/// Constructor for initialization, the cache isn't usable until it's opened
+	/// </summary>
+	BuildCache() = default;
+
+	/// <summary>
+	/// Opens the folder of the cache (it's created if needed) and resets the statistics
+	/// </summary>
+	/// <param name="folder">Path of the folder on the host</param>
+	/// <param name="maxSize">Size in Bytes above which the least recently used object files are removed by prune</param>
+	/// <returns>true on success, false if the folder couldn't be created</returns>
+	bool open(const std::string& folder, uint64_t maxSize);
+
+	/// <summary>
+	/// Adds a connection of a compiler on the SSH client, its request is answered by serve as soon as it's complete
+	/// </summary>
+	/// <param name="channel">Forwarded channel of the connection to the cache, it's closed and freed by serve or discard</param>
+	void accept(ssh_channel channel);
+
+	/// <summary>
+	/// Reads what the compilers sent meanwhile without waiting, answers the complete requests, and closes the connections which were answered,
+	/// closed by the compiler, or idle longer than the timeout
+	/// </summary>
+	void serve();
+
+	/// <summary>
+	/// Closes the connections whose requests weren't answered (e.g., after the build finished)
+	/// </summary>
+	void discard();
+
+	/// <summary>
+	/// Returns the token of the current build, which its compilers send with every request
+	/// </summary>
+	std::string token() const;
+
+	/// <summary>
+	/// Removes the least recently used object files until the cache isn't larger than its maximum size
+	/// </summary>
+	void prune();
+
+	/// <summary>
+	/// Returns the statistics since the cache was opened (hits, misses, stored object files, and served Bytes) as a line of text,
+	/// empty if there were no requests
+	/// </summary>
+	std::string statistics() const;
+
+private:
+	/// <summary>
+	/// Folder of the cache, contains one folder per first two characters of the keys
+	/// </summary>
+	std::string folder;
+
+	/// <summary>
+	/// Size in Bytes above which prune removes object files
+	/// </summary>
+	uint64_t maxSize = 0;
+
+	/// <summary>
+	/// Statistics since the cache was opened
+	/// </summary>
+	size_t hits = 0, misses = 0, stored = 0;
+	uint64_t servedBytes = 0;
+
+	/// <summary>
+	/// Random token of the current build, created by open
+	/// </summary>
+	std::string buildToken;
+
+	/// <summary>
+	/// Connection of a compiler with the Bytes of its request read so far and the time (milliseconds of the steady clock) at which it is closed
+	/// if no further Bytes arrive
+	/// </summary>
+	struct Request {
+		ssh_channel channel;
+		std::string data;
+		int64_t deadline;
+	};
+
+	/// <summary>
+	/// Connections whose requests weren't answered yet
+	/// </summary>
+	std::vector<Request> requests;
+
+	/// <summary>
+	/// Answers a complete request of a compiler
+	/// </summary>
+	/// <param name="channel">Channel of the connection to the compiler</param>
+	/// <param name="command">Command of the request, GET or PUT</param>
+	/// <param name="key">Key of the object file</param>
+	/// <param name="size">Size of the object file of a PUT</param>
+	/// <param name="object">Object file of a PUT</param>
+	void answer(ssh_channel channel, const std::string& command, const std::string& key, uint64_t size, const std::string& object);
+
+	/// <summary>
+	/// Returns the path of the object file with the given key, empty if the key isn't a hash (32 hexadecimal characters)
+	/// </summary>
+	std::string object_path(const std::string& key) const;
+
+};
@@ -0,0 +1,133 @@
+#include "Delta.h"
+#include "Agent/hash.h"
+#include "Agent/protocol.h"
+
+#include <math.h>
+
+#include <algorithm>
+#include <unordered_map>
+
+uint32_t Delta::block_size(uint64_t size) {
+    // About the square root of the size, a multiple of 8 Bytes
+    uint32_t blockSize = (uint32_t)sqrt((double)size) & ~7u;
+    return std::clamp(blockSize, (uint32_t)DELTA_MIN_BLOCK, (uint32_t)DELTA_MAX_BLOCK);
+}
+
+bool Delta::parse_sums(const std::string& response, uint64_t* size, std::vector<BlockSum>* sums) {
+    size_t pos = 0;
+    uint32_t count;
+    if (!agent::get_u64(response, &pos, size) || !agent::get_u32(response, &pos, &count))
+        return false;
+
+    // Every checksum has 12 Bytes, check the count before allocating
+    if (response.size() - pos != (size_t)count * 12)
+        return false;
+
+    sums->resize(count);
+    for (BlockSum& sum : *sums)
+        if (!agent::get_u32(response, &pos, &sum.weak) || !agent::get_u64(response, &pos, &sum.strong))
+            return false;
+
+    return true;
+}
+
+uint32_t Delta::encode(const char* data, size_t size, uint32_t blockSize, uint64_t baseSize, const std::vector<BlockSum>& sums, std::string* ops, uint64_t* literalBytes) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    uint32_t count = 0;
+    *literalBytes = 0;
+
+    // Index the complete blocks of the old file by their weak checksum, blocks with the same checksum are chained
+    uint32_t nblocks = (uint32_t)std::min<uint64_t>(baseSize / blockSize, sums.size());
+    std::unordered_map<uint32_t, uint32_t> first;
+    std::vector<uint32_t> next(nblocks, UINT32_MAX);
+    first.reserve(nblocks);
+
+    for (uint32_t i = nblocks; i-- > 0; ) {
+        auto [it, inserted] = first.try_emplace(sums[i].weak, i);
+        if (!inserted) {
+            next[i] = it->second;
+            it->second = i;
+        }
+    }
+
+    // Run of copied blocks which isn't encoded yet, consecutive blocks are merged into one operation
+    uint32_t runFirst = 0, runCount = 0;
+
+    auto flush_run = [&]() {
+        if (runCount > 0) {
+            agent::put_u8(ops, AGENT_DELTA_COPY);
+            agent::put_u32(ops, runFirst);
+            agent::put_u32(ops, runCount);
+            count++;
+            runCount = 0;
+        }
+    };
+
+    auto put_literal = [&](size_t begin, size_t end) {
+        if (begin < end) {
+            flush_run();
+            agent::put_u8(ops, AGENT_DELTA_DATA);
+            agent::put_string(ops, std::string(data + begin, end - begin));
+            *literalBytes += end - begin;
+            count++;
+        }
+    };
+
+    // Start of the data which wasn't found in the old file yet
+    size_t literal = 0;
+    size_t pos = 0;
+
+    agent::RollingSum sum;
+    if (nblocks > 0 && size >= blockSize)
+        sum.init(bytes, blockSize);
+
+    while (nblocks > 0 && pos + blockSize <= size) {
+        // Search a block with the same weak checksum, compare the strong checksum only then
+        uint32_t found = UINT32_MAX;
+        auto it = first.find(sum.digest());
+        if (it != first.end()) {
+            uint64_t strong = agent::hash64(bytes + pos, blockSize);
+
+            // Prefer the block after the current run, so that the run continues
+            for (uint32_t i = it->second; i != UINT32_MAX; i = next[i]) {
+                if (sums[i].strong == strong) {
+                    found = i;
+                    if (runCount == 0 || i == runFirst + runCount)
+                        break;
+                }
+            }
+        }
+
+        // If the block was found, send the data before it literally and copy the block, then continue after it
+        if (found != UINT32_MAX) {
+            put_literal(literal, pos);
+
+            if (runCount > 0 && found != runFirst + runCount)
+                flush_run();
+
+            if (runCount == 0)
+                runFirst = found;
+            runCount++;
+
+            pos += blockSize;
+            literal = pos;
+
+            if (pos + blockSize <= size)
+                sum.init(bytes + pos, blockSize);
+
+            continue;
+        }
+
+        // Else move the window forward by one Byte
+        if (pos + blockSize < size)
+            sum.roll(bytes[pos], bytes[pos + blockSize]);
+
+        pos++;
+    }
+
+    // Send the remaining data literally
+    put_literal(literal, size);
+    flush_run();
+
+    return count;
+}
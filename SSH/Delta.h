@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+// Files smaller than this many Bytes are always sent completely, can be changed with the option deltaMinSize
+#define DELTA_MIN_SIZE		(1024 * 1024)
+
+// Number of files whose checksums are requested ahead while the delta of a file is created
+#define DELTA_PIPELINE		4
+
+// Smallest and largest block size of a delta
+#define DELTA_MIN_BLOCK		2048
+#define DELTA_MAX_BLOCK		(128 * 1024)
+
+/// <summary>
+/// Weak (rolling) and strong checksum of a block of the old file, computed by the agent (AGENT_BLOCKSUMS)
+/// </summary>
+struct BlockSum {
+	uint32_t weak = 0;
+	uint64_t strong = 0;
+};
+
+/// <summary>
+/// Block-level delta of a file against its old version on the SSH client (like rsync): the agent sends the checksums of the blocks
+/// of its copy, the new file is searched for these blocks at every offset with a rolling checksum, and only the operations
+/// to copy the found blocks plus the literal data in between are sent (AGENT_PATCH)
+/// </summary>
+class Delta {
+
+public:
+	/// <summary>
+	/// Returns the block size for a file, about the square root of its size (fewer checksums for large files, finer blocks for small ones)
+	/// </summary>
+	/// <param name="size">Size of the old file in Bytes</param>
+	static uint32_t block_size(uint64_t size);
+
+	/// <summary>
+	/// Decodes the response of AGENT_BLOCKSUMS
+	/// </summary>
+	/// <param name="response">Payload of the response</param>
+	/// <param name="size">Pointer in which the size of the old file is saved</param>
+	/// <param name="sums">Pointer to the vector in which the checksums of the blocks are saved</param>
+	/// <returns>true on success, false if the response is invalid</returns>
+	static bool parse_sums(const std::string& response, uint64_t* size, std::vector<BlockSum>* sums);
+
+	/// <summary>
+	/// Creates the operations which rebuild the new file from the blocks of the old file and literal data
+	/// </summary>
+	/// <param name="data">Pointer to the new file</param>
+	/// <param name="size">Size of the new file in Bytes</param>
+	/// <param name="blockSize">Block size of the checksums</param>
+	/// <param name="baseSize">Size of the old file in Bytes, only its complete blocks are searched</param>
+	/// <param name="sums">Checksums of the blocks of the old file</param>
+	/// <param name="ops">Pointer to the string to which the encoded operations are appended (see AGENT_PATCH)</param>
+	/// <param name="literalBytes">Pointer in which the number of Bytes which have to be sent literally is saved</param>
+	/// <returns>The number of operations</returns>
+	static uint32_t encode(const char* data, size_t size, uint32_t blockSize, uint64_t baseSize, const std::vector<BlockSum>& sums, std::string* ops, uint64_t* literalBytes);
+
+};
@@ -0,0 +1,193 @@
+#include "DeployIgnore.h"
+
+#include <fstream>
+
+void DeployIgnore::add(std::string line) {
+    // Remove a carriage return (Windows line ending) and trailing spaces unless they are escaped with a backslash
+    if (!line.empty() && line.back() == '\r')
+        line.pop_back();
+
+    while (!line.empty() && line.back() == ' ' && !(line.length() >= 2 && line[line.length() - 2] == '\\'))
+        line.pop_back();
+
+    // Skip empty lines and comments
+    if (line.empty() || line.front() == '#')
+        return;
+
+    Rule rule;
+
+    // A leading '!' re-includes, a leading backslash escapes a literal '#' or '!'
+    if (line.front() == '!') {
+        rule.negate = true;
+        line.erase(0, 1);
+    }
+    else if (line.front() == '\\' && line.length() >= 2 && (line[1] == '#' || line[1] == '!'))
+        line.erase(0, 1);
+
+    // A trailing '/' only matches folders
+    if (!line.empty() && line.back() == '/') {
+        rule.dirOnly = true;
+        line.pop_back();
+    }
+
+    // A pattern with a leading or inner '/' matches the whole path relative to the project folder, else the name at any depth
+    if (!line.empty() && line.front() == '/') {
+        rule.anchored = true;
+        line.erase(0, 1);
+    }
+    else
+        rule.anchored = line.find('/') != std::string::npos;
+
+    // Nothing left to match (e.g., a single '/')
+    if (line.empty())
+        return;
+
+    rule.pattern = line;
+    rules.push_back(rule);
+}
+
+bool DeployIgnore::load(const std::string& path) {
+    // Open the file, most projects don't have one
+    std::ifstream file(path);
+    if (!file.is_open())
+        return false;
+
+    // Add every line as pattern
+    std::string line;
+    while (std::getline(file, line))
+        add(line);
+
+    return true;
+}
+
+bool DeployIgnore::ignored(const std::string& path, bool isDir) const {
+    // Name of the folder or file, matched by patterns without a '/'
+    size_t slash = path.rfind('/');
+    const char* name = path.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+
+    bool result = false;
+    for (const Rule& rule : rules) {
+        // Skip patterns which wouldn't change the result and patterns for folders if it is a file
+        if (rule.negate != result || (rule.dirOnly && !isDir))
+            continue;
+
+        // The last matching pattern decides
+        if (match(rule.pattern.c_str(), rule.anchored ? path.c_str() : name))
+            result = !rule.negate;
+    }
+
+    return result;
+}
+
+bool DeployIgnore::empty() const {
+    return rules.empty();
+}
+
+bool DeployIgnore::match(const char* pattern, const char* text) {
+    while (*pattern != '\0') {
+        switch (*pattern) {
+            case '*':
+                // "**" followed by a '/' or at the end matches any number of folders
+                if (pattern[1] == '*' && (pattern[2] == '/' || pattern[2] == '\0')) {
+                    // A trailing "**" matches everything
+                    if (pattern[2] == '\0')
+                        return true;
+
+                    // "**/" matches zero or more folders, try the rest of the pattern after every '/'
+                    for (const char* start = text; ; start++) {
+                        if (start == text || start[-1] == '/')
+                            if (match(pattern + 3, start))
+                                return true;
+
+                        if (*start == '\0')
+                            return false;
+                    }
+                }
+
+                // '*' (and other "**") matches any number of characters except '/', try the rest of the pattern at every position
+                while (*pattern == '*')
+                    pattern++;
+
+                for (const char* start = text; ; start++) {
+                    if (match(pattern, start))
+                        return true;
+
+                    if (*start == '\0' || *start == '/')
+                        return false;
+                }
+
+            case '?':
+                // '?' matches any single character except '/'
+                if (*text == '\0' || *text == '/')
+                    return false;
+
+                pattern++;
+                text++;
+                break;
+
+            case '[': {
+                // A character class, a ']' right after the '[' (and the negation) is a literal
+                const char* end = pattern + 1;
+                bool negate = *end == '!' || *end == '^';
+                if (negate)
+                    end++;
+
+                if (*end == ']')
+                    end++;
+
+                while (*end != '\0' && *end != ']')
+                    end++;
+
+                // Without a closing ']' the '[' is a literal
+                if (*end == '\0') {
+                    if (*text != '[')
+                        return false;
+
+                    pattern++;
+                    text++;
+                    break;
+                }
+
+                // A class never matches a '/'
+                if (*text == '\0' || *text == '/')
+                    return false;
+
+                // Check the characters and ranges (e.g., a-z) of the class
+                bool found = false;
+                for (const char* c = pattern + 1 + negate; c < end; c++) {
+                    if (c + 2 < end && c[1] == '-') {
+                        found |= *text >= c[0] && *text <= c[2];
+                        c += 2;
+                    }
+                    else
+                        found |= *text == *c;
+                }
+
+                if (found == negate)
+                    return false;
+
+                pattern = end + 1;
+                text++;
+                break;
+            }
+
+            case '\\':
+                // A backslash escapes the next character
+                if (pattern[1] != '\0')
+                    pattern++;
+
+                [[fallthrough]];
+
+            default:
+                // Every other character matches itself
+                if (*pattern != *text)
+                    return false;
+
+                pattern++;
+                text++;
+        }
+    }
+
+    // The whole text has to be matched
+    return *text == '\0';
+}
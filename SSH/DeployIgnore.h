@@ -0,0 +1,68 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Name of the file inside a project which lists the folders and files that aren't deployed (gitignore syntax)
+#define DEPLOY_IGNORE_FILE	".deployignore"
+
+/// <summary>
+/// Patterns of folders and files which aren't deployed, in the syntax of .gitignore: '*', '?', '[...]', and '**' wildcards,
+/// '!' re-includes, a trailing '/' only matches folders, and a pattern with a '/' (other than a trailing one) is relative to the project folder.
+/// The last matching pattern decides, a file inside an ignored folder can't be re-included because the folder isn't walked at all
+/// </summary>
+class DeployIgnore {
+
+public:
+	/// <summary>
+	/// Adds a single pattern, empty lines and comments (starting with '#') are skipped
+	/// </summary>
+	/// <param name="line">The pattern</param>
+	void add(std::string line);
+
+	/// <summary>
+	/// Adds the patterns of a .deployignore file
+	/// </summary>
+	/// <param name="path">Path of the file</param>
+	/// <returns>true if the file was read, false if it doesn't exist</returns>
+	bool load(const std::string& path);
+
+	/// <summary>
+	/// Checks if a folder or file is ignored
+	/// </summary>
+	/// <param name="path">Path relative to the project folder, with forward slashes</param>
+	/// <param name="isDir">true if the path is a folder</param>
+	/// <returns>true if the folder or file isn't deployed</returns>
+	bool ignored(const std::string& path, bool isDir) const;
+
+	/// <summary>
+	/// Returns true if there are no patterns, i.e., nothing is ignored
+	/// </summary>
+	bool empty() const;
+
+private:
+	/// <summary>
+	/// A single parsed pattern
+	/// </summary>
+	struct Rule {
+		// The pattern without the leading '!' and '/' and the trailing '/'
+		std::string pattern;
+
+		// Re-includes instead of ignoring, only matches folders, matches the whole path instead of the name
+		bool negate = false, dirOnly = false, anchored = false;
+	};
+
+	/// <summary>
+	/// Patterns in the order they were added, the last matching one decides
+	/// </summary>
+	std::vector<Rule> rules;
+
+	/// <summary>
+	/// Matches the text against a pattern, '*' and '?' don't match a '/' but "**/" and a trailing "**" match any number of folders
+	/// </summary>
+	/// <param name="pattern">Pointer to the (remaining) pattern</param>
+	/// <param name="text">Pointer to the (remaining) text</param>
+	/// <returns>true if the whole text matches</returns>
+	static bool match(const char* pattern, const char* text);
+
+};
@@ -0,0 +1,408 @@
+#include "Manifest.h"
+#include "MappedFile.h"
+#include "SSH.h"
+#include "Agent/hash.h"
+
+#include <sys/stat.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+
+int Manifest::scan(const char* project, const char* path2project, unsigned int threads) {
+    // Forget the previous scan
+    this->path2project = path2project;
+    dirs.clear();
+    files.clear();
+    ignoredFiles = ignoredDirs = 0;
+    ignoredBytes = 0;
+
+    // The ignore patterns are the given ones followed by the ones of the project, so that the latter take precedence
+    DeployIgnore rules = ignore;
+    rules.load(std::format("{}/{}/{}", path2project, project, DEPLOY_IGNORE_FILE));
+
+    // Length of the project folder in front of the paths, the patterns are relative to it
+    size_t prefix = strlen(project) + 1;
+
+    // Save when the scan started, files modified shortly before aren't trusted by the next cache
+    scanTime_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+    // Folders which still have to be read, relative to path2project, start with the project folder itself
+    std::vector<std::string> queue = { project };
+
+    // Number of folders which are currently read by a thread, the walk is finished if none is read and the queue is empty
+    size_t active = 0;
+
+    // First error message, the walk is aborted if set
+    std::string error;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+
+    // Function executed by every thread
+    auto worker = [&]() {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        while (true) {
+            // Wait until there is a folder to read or the walk is finished
+            cv.wait(lock, [&]() { return !queue.empty() || active == 0 || !error.empty(); });
+            if (queue.empty() || !error.empty())
+                break;
+
+            // Take the next folder
+            std::string dir = std::move(queue.back());
+            queue.pop_back();
+            active++;
+            lock.unlock();
+
+            // Folders and files found inside the current folder, added to the results all at once
+            std::vector<std::string> subdirs, foundDirs;
+            std::vector<ManifestEntry> foundFiles;
+            std::string dirError;
+
+            // Ignored files and folders inside the current folder
+            size_t skippedFiles = 0, skippedDirs = 0;
+            uint64_t skippedBytes = 0;
+
+            try {
+                // Iterate through all entries of the folder (not recursively, the subfolders are read by any thread)
+                for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(std::format("{}/{}", path2project, dir))) {
+                    // Path relative to path2project
+                    std::string path = std::format("{}/{}", dir, entry.path().filename().generic_string());
+                    bool isDir = entry.is_directory();
+
+                    // Skip ignored folders (without walking them) and files
+                    if (!rules.empty() && rules.ignored(path.substr(prefix), isDir)) {
+                        if (isDir)
+                            skippedDirs++;
+                        else {
+                            skippedFiles++;
+
+                            std::error_code ec;
+                            uintmax_t size = entry.file_size(ec);
+                            if (!ec)
+                                skippedBytes += size;
+                        }
+
+                        continue;
+                    }
+
+                    // Folders (symbolic links to folders are listed but not followed, like before)
+                    if (isDir) {
+                        if (!entry.is_symlink())
+                            subdirs.push_back(path);
+
+                        foundDirs.push_back(path);
+                        continue;
+                    }
+
+                    // Files, save their size, modification time, and inode
+                    ManifestEntry file = { path };
+                    struct stat st;
+                    if (stat(entry.path().string().c_str(), &st) == 0) {
+                        file.size = (uint64_t)st.st_size;
+                        file.inode = (uint64_t)st.st_ino;
+#ifdef WIN32
+                        file.mtime_ns = (int64_t)st.st_mtime * 1000000000;
+#else
+                        file.mtime_ns = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+                    }
+
+                    foundFiles.push_back(file);
+                }
+            }
+            // If an error, exception occured (e.g., The project is missing and/or path2project is invalid)
+            catch (const std::filesystem::filesystem_error& err) {
+                dirError = err.what();
+            }
+
+            lock.lock();
+
+            // Save the results
+            dirs.insert(dirs.end(), foundDirs.begin(), foundDirs.end());
+            files.insert(files.end(), foundFiles.begin(), foundFiles.end());
+            ignoredFiles += skippedFiles;
+            ignoredDirs += skippedDirs;
+            ignoredBytes += skippedBytes;
+
+            // Queue the subfolders and save the first error
+            queue.insert(queue.end(), subdirs.begin(), subdirs.end());
+            if (error.empty())
+                error = dirError;
+
+            // Wake up the other threads, there may be new folders or the walk is finished
+            active--;
+            cv.notify_all();
+        }
+    };
+
+    // Start the threads and wait for them
+    std::vector<std::thread> pool;
+    for (unsigned int i = 1; i < thread_count(threads); i++)
+        pool.emplace_back(worker);
+
+    worker();
+    for (std::thread& thread : pool)
+        thread.join();
+
+    // If an error occured
+    if (!error.empty()) {
+        // Print the exception message to stderr
+        std::cerr << error << std::endl;
+
+        return SSH_ERROR;
+    }
+
+    // Sort the folders and files so that the result doesn't depend on the order of the threads
+    std::sort(dirs.begin(), dirs.end());
+    std::sort(files.begin(), files.end(), [](const ManifestEntry& a, const ManifestEntry& b) { return a.path < b.path; });
+
+    return SSH_OK;
+}
+
+int Manifest::hash(unsigned int threads) {
+    // Files which have to be read
+    std::vector<ManifestEntry*> order;
+    cached = 0;
+
+    for (ManifestEntry& file : files) {
+        // Take the hash from the cache if the file is unchanged, i.e., it has still the same inode, size, and modification time
+        // and wasn't modified shortly before the cache was created (it may have been changed again afterwards without a new modification time)
+        auto it = cache.find(file.path);
+        if (it != cache.end() && it->second.inode == file.inode && it->second.size == file.size && it->second.mtime_ns == file.mtime_ns
+            && file.mtime_ns < cacheTime_ns - MANIFEST_RACY_NS) {
+            file.hash = it->second.hash;
+            cached++;
+        }
+        else
+            order.push_back(&file);
+    }
+
+    // Hash the largest files first, so that no thread ends up alone with a large file at the end
+    std::sort(order.begin(), order.end(), [](const ManifestEntry* a, const ManifestEntry* b) { return a->size > b->size; });
+
+    // Index of the next file to hash, shared by all threads
+    std::atomic<size_t> next = 0;
+
+    // Set if a file couldn't be read
+    std::atomic<bool> failed = false;
+    std::mutex errorMutex;
+
+    // Function executed by every thread
+    auto worker = [&]() {
+        // Map every file and hash its content
+        for (size_t i = next++; i < order.size() && !failed; i = next++) {
+            MappedFile mapping;
+            std::string localPath = std::format("{}/{}", path2project, order[i]->path);
+
+            // If the file couldn't be opened or mapped
+            if (!mapping.open(localPath)) {
+                // Print an error message to stderr (once per file, not interleaved)
+                std::lock_guard<std::mutex> lock(errorMutex);
+                std::cerr << "Can't open local file " << localPath << std::endl;
+
+                failed = true;
+                break;
+            }
+
+            // The size is updated, the file may have changed since the scan
+            order[i]->size = mapping.size();
+            order[i]->hash = agent::hash64(mapping.data(), mapping.size());
+        }
+    };
+
+    // Start the threads and wait for them
+    std::vector<std::thread> pool;
+    for (unsigned int i = 1; i < std::min(thread_count(threads), (unsigned int)std::max(order.size(), (size_t)1)); i++)
+        pool.emplace_back(worker);
+
+    worker();
+    for (std::thread& thread : pool)
+        thread.join();
+
+    return failed ? SSH_ERROR : SSH_OK;
+}
+
+int Manifest::build(const char* project, const char* path2project, unsigned int threads, bool useCache) {
+    // Scan the project
+    int rc = scan(project, path2project, threads);
+    if (rc != SSH_OK)
+        return rc;
+
+    // Without the cache only hash the files
+    if (!useCache)
+        return hash(threads);
+
+    // Load the cache, hash the changed files, and save the new hashes for the next build
+    std::string cachePath = cache_path(project, path2project);
+    load_cache(cachePath);
+
+    rc = hash(threads);
+    if (rc == SSH_OK)
+        // The cache only speeds up the next build, the manifest is valid without it
+        save_cache(cachePath);
+
+    return rc;
+}
+
+bool Manifest::load_cache(const std::string& path) {
+    // Forget a previously loaded cache
+    cache.clear();
+    cacheTime_ns = 0;
+
+    // Open the cache, it is missing before the first build
+    std::ifstream file(path, std::ifstream::binary);
+    if (!file.is_open())
+        return false;
+
+    // Read and parse the whole cache, an invalid cache is treated as empty
+    std::string data(std::istreambuf_iterator<char>(file), {});
+    if (!parse(data, &cache, &cacheTime_ns)) {
+        cache.clear();
+        cacheTime_ns = 0;
+
+        return false;
+    }
+
+    return true;
+}
+
+int Manifest::save_cache(const std::string& path) const {
+    // Write into a temporary file with a random suffix, multiple SSH processes may build the manifest of the same project at once
+    std::string tmpPath = std::format("{}.{:08x}.tmp", path, std::random_device()());
+
+    {
+        std::ofstream file(tmpPath, std::ofstream::trunc);
+        if (!file.is_open()) {
+            // Print an error message to stderr
+            std::cerr << "Can't write the manifest cache " << tmpPath << std::endl;
+
+            return SSH_ERROR;
+        }
+
+        // Write the manifest
+        file << serialize();
+
+        // If not all Bytes could be written (e.g., the disk is full)
+        if (!file.flush()) {
+            file.close();
+            std::filesystem::remove(tmpPath);
+
+            // Print an error message to stderr
+            std::cerr << "Can't write the manifest cache " << tmpPath << std::endl;
+
+            return SSH_ERROR;
+        }
+    }
+
+    // Replace the old cache atomically
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, path, ec);
+    if (ec) {
+        std::filesystem::remove(tmpPath, ec);
+
+        // Print an error message to stderr
+        std::cerr << "Can't write the manifest cache " << path << std::endl;
+
+        return SSH_ERROR;
+    }
+
+    return SSH_OK;
+}
+
+std::string Manifest::serialize() const {
+    // The header contains the version of the format and when the scan started
+    std::string data = std::format("pideploy-manifest {} {}\n", MANIFEST_CACHE_VERSION, scanTime_ns);
+
+    // One line per file, paths with a line break can't be saved (they are treated as changed every time)
+    for (const ManifestEntry& entry : files)
+        if (entry.path.find('\n') == std::string::npos)
+            data.append(std::format("{:016x} {} {} {} {}\n", entry.hash, entry.size, entry.mtime_ns, entry.inode, entry.path));
+
+    return data;
+}
+
+bool Manifest::parse(const std::string& data, std::unordered_map<std::string, ManifestEntry>* entries, int64_t* time_ns) {
+    // Split the data into lines, the header comes first
+    size_t pos = 0, end;
+    bool header = true;
+
+    for (; (end = data.find('\n', pos)) != std::string::npos; pos = end + 1) {
+        std::string line = data.substr(pos, end - pos);
+
+        // The header contains the version of the format and when the scan started
+        if (header) {
+            unsigned int version;
+            if (sscanf(line.c_str(), "pideploy-manifest %u %" SCNd64, &version, time_ns) != 2 || version != MANIFEST_CACHE_VERSION)
+                return false;
+
+            header = false;
+            continue;
+        }
+
+        // Every following line contains the hash, size, modification time, and inode of a file, followed by its path
+        ManifestEntry entry;
+        int pathStart = 0;
+
+        // An invalid line invalidates the whole manifest, it may have been written by something else
+        if (sscanf(line.c_str(), "%" SCNx64 " %" SCNu64 " %" SCNd64 " %" SCNu64 " %n", &entry.hash, &entry.size, &entry.mtime_ns, &entry.inode, &pathStart) != 4 || pathStart == 0)
+            return false;
+
+        entry.path = line.substr(pathStart);
+        (*entries)[entry.path] = entry;
+    }
+
+    // The header is required and the last line must be complete, else the manifest was truncated
+    return !header && pos == data.size();
+}
+
+std::string Manifest::cache_path(const char* project, const char* path2project) {
+    return std::format("{}/.{}.manifest", path2project, project);
+}
+
+const ManifestEntry* Manifest::find(const std::string& path) const {
+    // The files are sorted by their path, search binary
+    auto it = std::lower_bound(files.begin(), files.end(), path, [](const ManifestEntry& entry, const std::string& path) { return entry.path < path; });
+    return it != files.end() && it->path == path ? &*it : nullptr;
+}
+
+uint64_t Manifest::project_hash() const {
+    // Hash the paths together with the content hashes (and the folders, so that empty folders count as well)
+    std::string data;
+    for (const std::string& dir : dirs)
+        data.append(dir).push_back('\0');
+
+    for (const ManifestEntry& file : files)
+        data.append(std::format("{}\n{:016x}\n", file.path, file.hash));
+
+    return agent::hash64(data.data(), data.size());
+}
+
+uint64_t Manifest::total_size() const {
+    uint64_t size = 0;
+    for (const ManifestEntry& file : files)
+        size += file.size;
+
+    return size;
+}
+
+unsigned int Manifest::thread_count(unsigned int threads) {
+    // One thread per CPU core if not specified, hardware_concurrency may return 0 if unknown
+    if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+
+    return std::max(threads, 1u);
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "DeployIgnore.h"
+
+#include <stdint.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Version of the format of the manifest cache, a cache with another version is ignored
+#define MANIFEST_CACHE_VERSION	1
+
+// Files modified less than this many nanoseconds before a scan started aren't trusted from the cache,
+// their modification time may not change with the next write if it happens within the timestamp resolution (2 s on FAT)
+#define MANIFEST_RACY_NS		2000000000LL
+
+/// <summary>
+/// A single file of a manifest
+/// </summary>
+struct ManifestEntry {
+	// Path of the file relative to path2project (i.e., starting with the project name), with forward slashes
+	std::string path;
+
+	// Size in Bytes, modification time (ns since the Unix epoch), and inode of the file
+	uint64_t size = 0;
+	int64_t mtime_ns = 0;
+	uint64_t inode = 0;
+
+	// Content hash of the file (see Agent/hash.h), only valid if the manifest was hashed
+	uint64_t hash = 0;
+};
+
+/// <summary>
+/// List of all folders and files of a project together with the content hashes of the files.
+/// The tree is walked and the files are hashed by one thread per CPU core, unchanged files (same path, inode, size, and modification time)
+/// take their hash from a cache next to the project instead of being read again
+/// </summary>
+class Manifest {
+
+public:
+	/// <summary>
+	/// Folders of the project relative to path2project, sorted (parents before their children)
+	/// </summary>
+	std::vector<std::string> dirs;
+
+	/// <summary>
+	/// Files of the project, sorted by their path
+	/// </summary>
+	std::vector<ManifestEntry> files;
+
+	/// <summary>
+	/// Number of files whose hash was taken from the cache by the last call of hash
+	/// </summary>
+	size_t cached = 0;
+
+	/// <summary>
+	/// Patterns of folders and files which aren't part of the manifest (e.g., global ones), scan adds the .deployignore of the project to them
+	/// </summary>
+	DeployIgnore ignore;
+
+	/// <summary>
+	/// Number and total size of the files which were ignored by the last scan, and number of the ignored folders (which aren't walked)
+	/// </summary>
+	size_t ignoredFiles = 0, ignoredDirs = 0;
+	uint64_t ignoredBytes = 0;
+
+	/// <summary>
+	/// Walks the folder tree of the project in parallel and saves all folders and files (without hashes), ignored folders are pruned
+	/// </summary>
+	/// <param name="project">Name of the project</param>
+	/// <param name="path2project">Path to the project on the host disk</param>
+	/// <param name="threads">Optional, number of threads, 0 for one per CPU core (default: 0)</param>
+	/// <returns>SSH_OK on success, SSH_ERROR if the tree couldn't be read</returns>
+	int scan(const char* project, const char* path2project, unsigned int threads = 0);
+
+	/// <summary>
+	/// Hashes the content of all files of the last scan in parallel, files which are unchanged since the loaded cache aren't read
+	/// </summary>
+	/// <param name="threads">Optional, number of threads, 0 for one per CPU core (default: 0)</param>
+	/// <returns>SSH_OK on success, SSH_ERROR if a file couldn't be read</returns>
+	int hash(unsigned int threads = 0);
+
+	/// <summary>
+	/// Scans the project and hashes all of its files
+	/// </summary>
+	/// <param name="project">Name of the project</param>
+	/// <param name="path2project">Path to the project on the host disk</param>
+	/// <param name="threads">Optional, number of threads, 0 for one per CPU core (default: 0)</param>
+	/// <param name="useCache">Optional, if true the cache of the project (see cache_path) is loaded before and saved after hashing (default: true)</param>
+	/// <returns>SSH_OK on success, SSH_ERROR on error</returns>
+	int build(const char* project, const char* path2project, unsigned int threads = 0, bool useCache = true);
+
+	/// <summary>
+	/// Loads the hashes of a previous build, a missing or invalid cache is treated as empty
+	/// </summary>
+	/// <param name="path">Path of the cache file</param>
+	/// <returns>true if the cache was loaded, false if it is missing or invalid</returns>
+	bool load_cache(const std::string& path);
+
+	/// <summary>
+	/// Saves the hashes of the files atomically (written to a temporary file which is renamed), so that concurrent builds never read a partial cache
+	/// </summary>
+	/// <param name="path">Path of the cache file</param>
+	/// <returns>SSH_OK on success, SSH_ERROR on error</returns>
+	int save_cache(const std::string& path) const;
+
+	/// <summary>
+	/// Returns the manifest in the format of the cache: a header line followed by one line per file with its hash, size, modification time, inode, and path
+	/// </summary>
+	std::string serialize() const;
+
+	/// <summary>
+	/// Parses a manifest created by serialize
+	/// </summary>
+	/// <param name="data">The serialized manifest</param>
+	/// <param name="entries">Pointer to the map in which the files are saved by their path</param>
+	/// <param name="time_ns">Pointer in which the time when the scan of the manifest started is saved</param>
+	/// <returns>true on success, false if the data isn't a complete manifest of the current version</returns>
+	static bool parse(const std::string& data, std::unordered_map<std::string, ManifestEntry>* entries, int64_t* time_ns);
+
+	/// <summary>
+	/// Returns the path of the cache of a project, a hidden file next to the project folder so that it isn't part of the project itself
+	/// </summary>
+	/// <param name="project">Name of the project</param>
+	/// <param name="path2project">Path to the project on the host disk</param>
+	static std::string cache_path(const char* project, const char* path2project);
+
+	/// <summary>
+	/// Searches a file by its path
+	/// </summary>
+	/// <param name="path">Path of the file relative to path2project</param>
+	/// <returns>Pointer to the entry, nullptr if the file isn't part of the manifest</returns>
+	const ManifestEntry* find(const std::string& path) const;
+
+	/// <summary>
+	/// Combined hash of all paths and content hashes, changes if any file is added, removed, renamed, or changed
+	/// </summary>
+	uint64_t project_hash() const;
+
+	/// <summary>
+	/// Returns the total size of all files in Bytes
+	/// </summary>
+	uint64_t total_size() const;
+
+	/// <summary>
+	/// Returns the number of threads to use for the given request, 0 means one per CPU core
+	/// </summary>
+	static unsigned int thread_count(unsigned int threads);
+
+private:
+	/// <summary>
+	/// Path to the project on the host disk of the last scan
+	/// </summary>
+	std::string path2project;
+
+	/// <summary>
+	/// Time (ns since the Unix epoch) when the last scan started
+	/// </summary>
+	int64_t scanTime_ns = 0;
+
+	/// <summary>
+	/// Entries of the loaded cache by their path, and the time when the scan which created the cache started
+	/// </summary>
+	std::unordered_map<std::string, ManifestEntry> cache;
+	int64_t cacheTime_ns = 0;
+
+};
@@ -0,0 +1,156 @@
+#include "MappedFile.h"
+
+// When compiling on Windows
+#ifdef WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <time.h>
+    #include <unistd.h>
+#endif
+
+// Destructor
+MappedFile::~MappedFile() {
+    // Unmap the file
+    close();
+}
+
+bool MappedFile::open(const std::string& path) {
+    // Unmap a previously mapped file
+    close();
+
+#ifdef WIN32
+    // Open the file for reading, allow others to read it meanwhile
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    // Get the size of the file
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        return false;
+    }
+
+    // An empty file can't be mapped, there is nothing to send anyway
+    length = (size_t)fileSize.QuadPart;
+    if (length == 0) {
+        CloseHandle(file);
+        return true;
+    }
+
+    // Create a read-only mapping object and map the whole file, the handles aren't needed anymore afterwards
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping != nullptr) {
+        address = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+    }
+
+    CloseHandle(file);
+#else
+    // Open the file for reading
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+
+    // Get the size of the file, only regular files can be mapped
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        ::close(fd);
+        return false;
+    }
+
+    // An empty file can't be mapped, there is nothing to send anyway
+    length = (size_t)st.st_size;
+    if (length == 0) {
+        ::close(fd);
+        return true;
+    }
+
+    // If the file is small or was modified recently (e.g., saved by an editor while watching), read it into a buffer instead of mapping it
+    if (length < MAPPED_FILE_COPY_SIZE || time(nullptr) - st.st_mtime < MAPPED_FILE_SETTLE_TIME) {
+        copy.resize(length);
+
+        // Read until the end, the file may have become shorter meanwhile
+        size_t nread = 0;
+        ssize_t nbytes;
+        while (nread < length && (nbytes = read(fd, &copy[nread], length - nread)) > 0)
+            nread += nbytes;
+
+        ::close(fd);
+
+        copy.resize(nread);
+        length = nread;
+        address = copy.data();
+
+        return true;
+    }
+
+    // Map the whole file read-only and privately, the pages of the page cache are used directly as long as nothing writes to them.
+    // The file descriptor is kept to check whether the file is truncated meanwhile
+    void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    if (mapping != MAP_FAILED) {
+        // The file is read once from the beginning to the end, let the kernel read ahead aggressively
+        madvise(mapping, length, MADV_SEQUENTIAL);
+        address = (const char*)mapping;
+        descriptor = fd;
+    }
+    else
+        ::close(fd);
+#endif
+
+    // If the mapping failed
+    if (address == nullptr) {
+        length = 0;
+        return false;
+    }
+
+    return true;
+}
+
+void MappedFile::close() {
+    // Only unmap if something is mapped, a read file is only freed
+    if (address != nullptr && address != copy.data()) {
+#ifdef WIN32
+        UnmapViewOfFile(address);
+#else
+        munmap((void*)address, length);
+#endif
+    }
+
+#ifndef WIN32
+    // Close the file descriptor of a mapped file
+    if (descriptor >= 0)
+        ::close(descriptor);
+#endif
+
+    address = nullptr;
+    descriptor = -1;
+    copy.clear();
+    length = 0;
+}
+
+const char* MappedFile::data() const {
+    return address;
+}
+
+size_t MappedFile::size() const {
+    return length;
+}
+
+bool MappedFile::truncated() const {
+#ifdef WIN32
+    // A mapped file can't be truncated on Windows
+    return false;
+#else
+    // A read file can't change anymore
+    if (descriptor < 0)
+        return false;
+
+    struct stat st;
+    return fstat(descriptor, &st) != 0 || (size_t)st.st_size < length;
+#endif
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <string>
+
+// Files smaller than this are read into a buffer instead of mapped, mapping them saves little and a truncated mapped file can't be read anymore
+#define MAPPED_FILE_COPY_SIZE	(1024 * 1024)
+
+// Files modified within this number of seconds are read into a buffer instead of mapped, an editor may still be writing (and truncating) them
+#define MAPPED_FILE_SETTLE_TIME	2
+
+/// <summary>
+/// Read-only memory mapping of a local file, so that it can be sent without copying it into a buffer first.
+/// The mapping uses the page cache, i.e., multiple SSH processes uploading the same file to different SSH clients share the same pages.
+/// Small and recently modified files are read into a buffer instead, so that an editor truncating them meanwhile can't make a read fail
+/// </summary>
+class MappedFile {
+
+public:
+	/// <summary>
+	/// Constructor for initialization, doesn't map anything yet
+	/// </summary>
+	MappedFile() = default;
+
+	/// <summary>
+	/// Destructor automatically unmaps the file
+	/// </summary>
+	~MappedFile();
+
+	// A mapping can't be copied, it would be unmapped twice
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	/// <summary>
+	/// Maps (or reads) the whole file read-only into memory, a previously mapped file is unmapped before
+	/// </summary>
+	/// <param name="path">Path of the local file</param>
+	/// <returns>true on success, false if the file couldn't be opened or mapped</returns>
+	bool open(const std::string& path);
+
+	/// <summary>
+	/// Unmaps the file
+	/// </summary>
+	void close();
+
+	/// <summary>
+	/// Returns a pointer to the first Byte of the file, nullptr if the file is empty or not mapped
+	/// </summary>
+	const char* data() const;
+
+	/// <summary>
+	/// Returns the size of the file in Bytes
+	/// </summary>
+	size_t size() const;
+
+	/// <summary>
+	/// Returns true if the mapped file became shorter since it was opened, its pages behind the new end can't be read anymore
+	/// </summary>
+	bool truncated() const;
+
+private:
+	/// <summary>
+	/// Address of the mapping, nullptr if nothing is mapped (e.g., empty files can't be mapped)
+	/// </summary>
+	const char* address = nullptr;
+
+	/// <summary>
+	/// Size of the mapped file in Bytes
+	/// </summary>
+	size_t length = 0;
+
+	/// <summary>
+	/// Content of a file which was read instead of mapped
+	/// </summary>
+	std::string copy;
+
+	/// <summary>
+	/// File descriptor of the mapped file to check its size, -1 if the file was read or isn't open
+	/// </summary>
+	int descriptor = -1;
+
+};
@@ -0,0 +1,477 @@
+#include "Pipeline.h"
+#include "DeployIgnore.h"
+#include "Manifest.h"
+#include "Agent/hash.h"
+
+#include <ctype.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+// Built-in operations of the SSH executable which a stage can run instead of a shell command
+static const char* const builtins[] = { "@sync", "@compile", "@collect" };
+
+// Splits a comma-separated list and removes the spaces around the items, empty items are skipped
+static std::vector<std::string> split_list(const std::string& list) {
+    std::vector<std::string> items;
+    std::istringstream stream(list);
+    for (std::string item; std::getline(stream, item, ','); ) {
+        item.erase(0, item.find_first_not_of(' '));
+        item.erase(item.find_last_not_of(' ') + 1);
+        if (!item.empty())
+            items.push_back(item);
+    }
+
+    return items;
+}
+
+bool Pipeline::load(const std::string& path) {
+    // Open the configuration file of the project
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Can't read the configuration file " << path << "." << std::endl;
+        return false;
+    }
+
+    stages.clear();
+
+    for (std::string line; std::getline(file, line); ) {
+        // Remove a carriage return (Windows line ending)
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+
+        // Only the lines which define stages are read, the arguments and options are read by the GUI
+        size_t equal = line.find('=');
+        if (!line.starts_with(PIPELINE_STAGE_PREFIX) || equal == std::string::npos)
+            continue;
+
+        // Split stage.<name>[.<attribute>]=<value>, the value may contain further equal signs
+        std::string key = line.substr(strlen(PIPELINE_STAGE_PREFIX), equal - strlen(PIPELINE_STAGE_PREFIX)), value = line.substr(equal + 1);
+        size_t dot = key.find('.');
+        std::string name = key.substr(0, dot), attribute = dot == std::string::npos ? "" : key.substr(dot + 1);
+
+        // Names are used in the output and in after, so they are restricted to letters, digits, '-', and '_'
+        if (name.empty() || !std::all_of(name.begin(), name.end(), [](char c) { return isalnum((unsigned char)c) || c == '-' || c == '_'; })) {
+            std::cerr << "Invalid stage name: " << line << std::endl;
+            return false;
+        }
+
+        // The attributes of a stage may come in any order, the stage is created by its first line
+        auto stage = std::find_if(stages.begin(), stages.end(), [&](const PipelineStage& s) { return s.name == name; });
+        if (stage == stages.end()) {
+            stages.push_back({ name });
+            stage = stages.end() - 1;
+        }
+
+        if (attribute.empty())
+            stage->command = value;
+        else if (attribute == "on") {
+            // Only the host, any Raspberry Pi, or all Raspberry Pis
+            if (value == "host")
+                stage->target = StageTarget::host;
+            else if (value == "any")
+                stage->target = StageTarget::any;
+            else if (value == "all")
+                stage->target = StageTarget::all;
+            else {
+                std::cerr << std::format("Invalid value for {}.on: {}, expected host, any, or all", name, value) << std::endl;
+                return false;
+            }
+        }
+        else if (attribute == "after")
+            stage->after = split_list(value);
+        else if (attribute == "inputs")
+            stage->inputs = split_list(value);
+        else {
+            std::cerr << "Unknown stage attribute: " << line << std::endl;
+            return false;
+        }
+    }
+
+    for (const PipelineStage& stage : stages) {
+        // Every stage needs something to run
+        if (stage.command.empty()) {
+            std::cerr << std::format("Stage {} has no command.", stage.name) << std::endl;
+            return false;
+        }
+
+        // Built-in operations need a Raspberry Pi
+        if (stage.command.starts_with('@')) {
+            if (std::find(std::begin(builtins), std::end(builtins), stage.command) == std::end(builtins)) {
+                std::cerr << std::format("Unknown operation {} of stage {}, expected @sync, @compile, or @collect.", stage.command, stage.name) << std::endl;
+                return false;
+            }
+
+            if (stage.target == StageTarget::host) {
+                std::cerr << std::format("Stage {} can't run {} on the host.", stage.name, stage.command) << std::endl;
+                return false;
+            }
+        }
+
+        // Every stage in after has to exist
+        for (const std::string& dep : stage.after) {
+            if (std::none_of(stages.begin(), stages.end(), [&](const PipelineStage& s) { return s.name == dep; })) {
+                std::cerr << std::format("Stage {} runs after the unknown stage {}.", stage.name, dep) << std::endl;
+                return false;
+            }
+        }
+    }
+
+    // Search for a cycle with a depth-first search, 1 marks the stages on the current path, 2 the finished ones
+    std::unordered_map<std::string, int> marks;
+    std::function<bool(const PipelineStage&)> acyclic = [&](const PipelineStage& stage) {
+        int& mark = marks[stage.name];
+        if (mark == 1) {
+            std::cerr << std::format("Stage {} depends on itself.", stage.name) << std::endl;
+            return false;
+        }
+        if (mark == 2)
+            return true;
+
+        mark = 1;
+        for (const std::string& dep : stage.after)
+            if (!acyclic(*std::find_if(stages.begin(), stages.end(), [&](const PipelineStage& s) { return s.name == dep; })))
+                return false;
+
+        mark = 2;
+        return true;
+    };
+
+    for (const PipelineStage& stage : stages)
+        if (!acyclic(stage))
+            return false;
+
+    return true;
+}
+
+bool Pipeline::plan(const std::vector<std::string>& names, const std::vector<std::string>& pis) {
+    this->pis = pis;
+    tasks.clear();
+
+    // Indices of the stages by their name
+    std::unordered_map<std::string, size_t> indices;
+    for (size_t i = 0; i < stages.size(); i++)
+        indices[stages[i].name] = i;
+
+    // Indices of the tasks of every stage, a stage is planned after the stages it depends on
+    std::map<size_t, std::vector<size_t>> stageTasks;
+    std::function<void(size_t)> add = [&](size_t s) {
+        if (stageTasks.contains(s))
+            return;
+
+        for (const std::string& dep : stages[s].after)
+            add(indices[dep]);
+
+        // One task on the host resp. on any Raspberry Pi (chosen when it starts), or one per Raspberry Pi
+        std::vector<std::string> addrs = stages[s].target == StageTarget::all ? pis : std::vector<std::string>{ "" };
+        for (const std::string& addr : addrs) {
+            PipelineTask task;
+            task.stage = s;
+            task.addr = addr;
+
+            // A task on all Raspberry Pis only waits for the tasks of the same Raspberry Pi if the other stage also runs on all of them,
+            // so that a slow Raspberry Pi doesn't hold back the others. Else it waits for all tasks of the other stage
+            for (const std::string& dep : stages[s].after)
+                for (size_t t : stageTasks[indices[dep]])
+                    if (stages[s].target != StageTarget::all || stages[indices[dep]].target != StageTarget::all || tasks[t].addr == addr)
+                        task.deps.push_back(t);
+
+            stageTasks[s].push_back(tasks.size());
+            tasks.push_back(task);
+        }
+    };
+
+    // All stages if none are given, else the given ones
+    if (names.empty())
+        for (size_t s = 0; s < stages.size(); s++)
+            add(s);
+
+    for (const std::string& name : names) {
+        if (!indices.contains(name)) {
+            std::cerr << "Unknown stage: " << name << std::endl;
+            return false;
+        }
+
+        add(indices[name]);
+    }
+
+    return true;
+}
+
+std::string Pipeline::label(const PipelineTask& task) const {
+    const PipelineStage& stage = stages[task.stage];
+    if (stage.target == StageTarget::host)
+        return stage.name + "@host";
+
+    return std::format("{}@{}", stage.name, task.addr.empty() ? "any" : task.addr);
+}
+
+uint64_t Pipeline::task_key(const PipelineTask& task, const Manifest& manifest) const {
+    const PipelineStage& stage = stages[task.stage];
+
+    // The inputs are patterns like in .deployignore, a file matches if itself or one of its folders matches
+    DeployIgnore inputs;
+    for (const std::string& pattern : stage.inputs)
+        inputs.add(pattern);
+
+    // The stage and where it runs, a task on any Raspberry Pi gets the same key on all of them
+    std::string data = std::format("{}\n{}\n{}\n{}\n", stage.name, stage.command, (int)stage.target, stage.target == StageTarget::all ? task.addr : "");
+
+    // The content hashes of the inputs, the paths of the manifest start with the project folder
+    for (const ManifestEntry& file : manifest.files) {
+        std::string path = file.path.substr(file.path.find('/') + 1);
+
+        bool input = inputs.ignored(path, false);
+        for (size_t slash = path.find('/'); !input && slash != std::string::npos; slash = path.find('/', slash + 1))
+            input = inputs.ignored(path.substr(0, slash), true);
+
+        if (input)
+            data += std::format("{:016x} {}\n", file.hash, path);
+    }
+
+    // The keys of the cached tasks it depends on, so that a changed input of an earlier stage also runs the later ones
+    for (size_t dep : task.deps)
+        data += std::format("{:016x}\n", tasks[dep].key);
+
+    // 0 means "no inputs", so it's never used as a key
+    return std::max<uint64_t>(agent::hash64(data.data(), data.size()), 1);
+}
+
+bool Pipeline::run(const std::string& statePath, bool force, const Scanner& scan, const Executor& execute) {
+    // Load the keys of the tasks which succeeded before, one line per task with the key and the task's name
+    std::map<std::string, uint64_t> saved;
+    std::ifstream stateFile(statePath);
+    for (std::string line; std::getline(stateFile, line); ) {
+        uint64_t key;
+        char name[256];
+        if (sscanf(line.c_str(), "%" SCNx64 " %255s", &key, name) == 2)
+            saved[name] = key;
+    }
+    stateFile.close();
+
+    // Running tasks per Raspberry Pi, a task on any Raspberry Pi starts on the least busy one
+    std::map<std::string, int> busy;
+    for (const std::string& addr : pis)
+        busy[addr] = 0;
+
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::vector<std::thread> threads;
+    size_t running = 0;
+
+    // The local project is scanned again after a task has finished, because a stage may have changed its files
+    std::unique_ptr<Manifest> manifest;
+
+    auto begin = std::chrono::steady_clock::now();
+    auto now = [&]() { return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count(); };
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        // Start every waiting task whose dependencies have finished, until no more tasks can be started
+        bool progress = true;
+        while (progress) {
+            progress = false;
+
+            for (size_t i = 0; i < tasks.size(); i++) {
+                PipelineTask& task = tasks[i];
+                const PipelineStage& stage = stages[task.stage];
+                if (task.state != PipelineTask::State::waiting)
+                    continue;
+
+                // A task whose dependency failed (or was skipped) is skipped, a task whose dependency is still running waits.
+                // A dependency which ran (e.g., a stage without inputs) may have changed what the task works on, so the task runs as well
+                bool ready = true, failed = false, changed = false;
+                for (size_t dep : task.deps) {
+                    PipelineTask::State state = tasks[dep].state;
+                    ready &= state == PipelineTask::State::succeeded || state == PipelineTask::State::cached;
+                    failed |= state == PipelineTask::State::failed || state == PipelineTask::State::skipped;
+                    changed |= state == PipelineTask::State::succeeded;
+                }
+
+                if (failed) {
+                    task.state = PipelineTask::State::skipped;
+                    std::cout << std::format("[{}] skipped, a stage before it failed.", label(task)) << std::endl;
+                    progress = true;
+                    continue;
+                }
+
+                if (!ready)
+                    continue;
+
+                // Compute the key from the current content of the inputs
+                if (!stage.inputs.empty()) {
+                    if (!manifest) {
+                        manifest = std::make_unique<Manifest>();
+                        if (!scan(manifest.get())) {
+                            // Without the hashes, the task runs like a task without inputs
+                            std::cerr << "Can't hash the inputs of the stages." << std::endl;
+                            manifest->files.clear();
+                        }
+                    }
+
+                    task.key = task_key(task, *manifest);
+                }
+
+                // Skip the task if it succeeded before with the same inputs and all its dependencies were up to date as well
+                std::string name = stage.target == StageTarget::any ? stage.name + "@any" : label(task);
+                if (task.key != 0 && !force && !changed && saved.contains(name) && saved[name] == task.key) {
+                    task.state = PipelineTask::State::cached;
+                    task.start = task.end = now();
+                    std::cout << std::format("[{}] is up to date.", name) << std::endl;
+                    progress = true;
+                    continue;
+                }
+
+                // Choose the least busy Raspberry Pi for a task on any of them
+                if (stage.target == StageTarget::any)
+                    task.addr = *std::min_element(pis.begin(), pis.end(), [&](const std::string& a, const std::string& b) { return busy[a] < busy[b]; });
+
+                task.state = PipelineTask::State::running;
+                task.start = now();
+                busy[task.addr]++;
+                running++;
+                std::cout << std::format("[{}] started.", label(task)) << std::endl;
+
+                // Run the task in its own thread, the result is handled by this loop
+                threads.emplace_back([&, i]() {
+                    bool success = execute(&tasks[i], stages[tasks[i].stage]);
+
+                    std::lock_guard<std::mutex> guard(mutex);
+                    PipelineTask& task = tasks[i];
+                    task.end = now();
+                    task.state = success ? PipelineTask::State::succeeded : PipelineTask::State::failed;
+
+                    // Print the output with the name of the task in front of every line, so that the output of parallel tasks can be told apart
+                    std::istringstream lines(task.output);
+                    for (std::string line; std::getline(lines, line); )
+                        std::cout << std::format("[{}] {}", label(task), line) << std::endl;
+                    std::cout << std::format("[{}] {} after {:.3f} s.", label(task), success ? "succeeded" : "failed", task.end - task.start) << std::endl;
+
+                    busy[task.addr]--;
+                    running--;
+                    manifest.reset();
+                    finished.notify_one();
+                });
+            }
+        }
+
+        // All tasks have finished if none is running anymore
+        if (running == 0)
+            break;
+
+        // Wait until a task has finished
+        finished.wait(lock);
+    }
+    lock.unlock();
+
+    for (std::thread& thread : threads)
+        thread.join();
+
+    seconds = now();
+
+    // Save the keys of the succeeded tasks and forget the failed ones, so that they run again next time
+    bool success = true;
+    for (const PipelineTask& task : tasks) {
+        const PipelineStage& stage = stages[task.stage];
+        std::string name = stage.target == StageTarget::any ? stage.name + "@any" : label(task);
+
+        if (task.state == PipelineTask::State::succeeded && task.key != 0)
+            saved[name] = task.key;
+        else if (task.state == PipelineTask::State::failed) {
+            saved.erase(name);
+            success = false;
+        }
+        // A skipped task didn't run, its last result is still valid
+        else if (task.state == PipelineTask::State::skipped)
+            success = false;
+    }
+
+    // Write into a temporary file which is renamed, so that an interrupted run doesn't lose the keys
+    std::string tmpPath = std::format("{}.{:08x}.tmp", statePath, std::random_device()());
+    {
+        std::ofstream file(tmpPath, std::ofstream::trunc);
+        for (auto& [name, key] : saved)
+            file << std::format("{:016x} {}\n", key, name);
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, statePath, ec);
+    if (ec) {
+        std::cerr << std::format("Can't save the state of the pipeline into {}: {}", statePath, ec.message()) << std::endl;
+        std::filesystem::remove(tmpPath, ec);
+    }
+
+    return success;
+}
+
+std::string Pipeline::report() const {
+    static const char* const states[] = { "waiting", "running", "succeeded", "cached", "failed", "skipped" };
+
+    // The tasks in the order they started, the skipped ones at the end
+    std::vector<size_t> order(tasks.size());
+    for (size_t i = 0; i < tasks.size(); i++)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        bool skippedA = tasks[a].state == PipelineTask::State::skipped, skippedB = tasks[b].state == PipelineTask::State::skipped;
+        return skippedA != skippedB ? skippedB : tasks[a].start < tasks[b].start;
+    });
+
+    // The critical path ends with the task which finished last and follows the dependency which finished last,
+    // i.e., the one the task waited for. Skipped tasks didn't run and aren't part of it
+    std::vector<size_t> path;
+    auto last = [&](const std::vector<size_t>& candidates) {
+        size_t best = tasks.size();
+        for (size_t t : candidates)
+            if (tasks[t].state != PipelineTask::State::skipped && (best == tasks.size() || tasks[t].end > tasks[best].end))
+                best = t;
+
+        return best;
+    };
+
+    for (size_t t = last(order); t != tasks.size(); t = last(tasks[t].deps))
+        path.insert(path.begin(), t);
+
+    // One line per task with its start, duration, and state, the tasks on the critical path are marked
+    std::string text = std::format("Pipeline finished after {:.3f} s:\n", seconds);
+    text += std::format("  {:>9} {:>9}  {:<9}  {}\n", "start", "time", "state", "stage");
+
+    double total = 0;
+    for (size_t t : order) {
+        const PipelineTask& task = tasks[t];
+        text += std::format("{} {:>8.3f}s {:>8.3f}s  {:<9}  {}\n", std::find(path.begin(), path.end(), t) != path.end() ? '*' : ' ',
+            task.start, task.end - task.start, states[(int)task.state], label(task));
+        total += task.end - task.start;
+    }
+
+    // The critical path, the time between its tasks was spent waiting (e.g., connecting or scheduling)
+    double critical = 0;
+    std::string chain;
+    for (size_t t : path) {
+        critical += tasks[t].end - tasks[t].start;
+        chain += std::format("{}{} ({:.3f} s)", chain.empty() ? "" : " -> ", label(tasks[t]), tasks[t].end - tasks[t].start);
+    }
+
+    if (!path.empty())
+        text += std::format("Critical path: {}, {:.3f} s of {:.3f} s.\n", chain, critical, seconds);
+
+    // How much faster the pipeline was than running all tasks one after another
+    text += std::format("All stages took {:.3f} s together, {:.2f}x faster in parallel.", total, seconds > 0 ? total / seconds : 1.0);
+
+    return text;
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+class Manifest;
+
+// Name of the file inside a project which saves its arguments, options, and the stages of its pipeline
+#define PIPELINE_CONFIG_FILE	"config.txt"
+
+// Prefix of the lines of the configuration file which define a stage: stage.<name>=<command> and stage.<name>.<attribute>=<value>
+#define PIPELINE_STAGE_PREFIX	"stage."
+
+/// <summary>
+/// Where a stage of a pipeline runs
+/// </summary>
+enum class StageTarget {
+	// Once on the host, inside the local project folder
+	host,
+
+	// Once on the Raspberry Pi with the fewest running stages
+	any,
+
+	// On every Raspberry Pi
+	all
+};
+
+/// <summary>
+/// A named stage of a pipeline as defined in the configuration file of the project
+/// </summary>
+struct PipelineStage {
+	// Name of the stage, the stages are referred to by it
+	std::string name;
+
+	// Shell command, or a built-in operation of the SSH executable (@sync, @compile, @collect)
+	std::string command;
+
+	// Where the stage runs (attribute on, default: all)
+	StageTarget target = StageTarget::all;
+
+	// Names of the stages which have to succeed before this one starts (attribute after)
+	std::vector<std::string> after;
+
+	// Patterns (see DeployIgnore) of the files of the project which the result depends on (attribute inputs),
+	// a stage without inputs always runs, else it's skipped while the hash of its inputs is unchanged
+	std::vector<std::string> inputs;
+};
+
+/// <summary>
+/// A single run of a stage, a stage which runs on all Raspberry Pis has one task per Raspberry Pi
+/// </summary>
+struct PipelineTask {
+	// State of the task, cached tasks were skipped because their inputs haven't changed since they succeeded
+	enum class State { waiting, running, succeeded, cached, failed, skipped };
+
+	// Index of the stage
+	size_t stage = 0;
+
+	// Address of the Raspberry Pi which runs the task, empty on the host. Set when the task starts if the stage runs on any Raspberry Pi
+	std::string addr;
+
+	// Indices of the tasks which have to succeed first
+	std::vector<size_t> deps;
+
+	// Current state
+	State state = State::waiting;
+
+	// Hash of the stage, its inputs, and the keys of the cached tasks it depends on, 0 if the stage has no inputs
+	uint64_t key = 0;
+
+	// Start and end of the task in seconds since the start of the pipeline
+	double start = 0, end = 0;
+
+	// Output of the task (stdout and stderr), printed after the task has finished
+	std::string output;
+};
+
+/// <summary>
+/// Pipeline of a project: named stages with dependencies, which run on the host or on the Raspberry Pis. Independent stages run in parallel
+/// (also across the Raspberry Pis), stages whose inputs haven't changed since their last success are skipped, and the timing of every stage is reported
+/// together with the critical path, i.e., the chain of dependencies which determined the total time
+/// </summary>
+class Pipeline {
+
+public:
+	/// <summary>
+	/// Runs a task and saves its output, called by one thread per running task
+	/// </summary>
+	using Executor = std::function<bool(PipelineTask* task, const PipelineStage& stage)>;
+
+	/// <summary>
+	/// Scans and hashes the local project, needed for the keys of stages with inputs
+	/// </summary>
+	using Scanner = std::function<bool(Manifest* manifest)>;
+
+	/// <summary>
+	/// Stages in the order of the configuration file
+	/// </summary>
+	std::vector<PipelineStage> stages;
+
+	/// <summary>
+	/// Tasks of the selected stages, created by plan
+	/// </summary>
+	std::vector<PipelineTask> tasks;
+
+	/// <summary>
+	/// Reads the stages from the configuration file of a project and checks them (unknown stages in after, cycles, invalid attributes)
+	/// </summary>
+	/// <param name="path">Path of the configuration file</param>
+	/// <returns>true on success, false if the file can't be read or a stage is invalid (an error message is printed)</returns>
+	bool load(const std::string& path);
+
+	/// <summary>
+	/// Creates the tasks of the given stages and of all stages they depend on
+	/// </summary>
+	/// <param name="names">Names of the stages to run, all stages if empty</param>
+	/// <param name="pis">Addresses of the Raspberry Pis on which the stages run</param>
+	/// <returns>true on success, false if a stage is unknown (an error message is printed)</returns>
+	bool plan(const std::vector<std::string>& names, const std::vector<std::string>& pis);
+
+	/// <summary>
+	/// Runs all tasks as soon as the tasks they depend on have succeeded, tasks which depend on a failed one are skipped.
+	/// The keys of the succeeded tasks are saved in the given file, a task whose key is saved there is skipped as cached unless a task it depends on ran
+	/// </summary>
+	/// <param name="statePath">Path of the file which saves the keys of the succeeded tasks</param>
+	/// <param name="force">true to run the cached tasks as well</param>
+	/// <param name="scan">Function which scans and hashes the local project</param>
+	/// <param name="execute">Function which runs a task</param>
+	/// <returns>true if all tasks succeeded or were cached, else false</returns>
+	bool run(const std::string& statePath, bool force, const Scanner& scan, const Executor& execute);
+
+	/// <summary>
+	/// Returns the timing of all tasks, the critical path, and the speedup from running tasks in parallel as text
+	/// </summary>
+	std::string report() const;
+
+private:
+	/// <summary>
+	/// Addresses of the Raspberry Pis, set by plan
+	/// </summary>
+	std::vector<std::string> pis;
+
+	/// <summary>
+	/// Total time of the last run in seconds
+	/// </summary>
+	double seconds = 0;
+
+	/// <summary>
+	/// Returns the name of the task together with the Raspberry Pi which runs it (e.g., "build@192.168.1.10")
+	/// </summary>
+	std::string label(const PipelineTask& task) const;
+
+	/// <summary>
+	/// Computes the key of a task from its stage, its Raspberry Pi, the content of its inputs, and the keys of the tasks it depends on
+	/// </summary>
+	/// <param name="task">The task whose dependencies have already finished</param>
+	/// <param name="manifest">The scanned and hashed local project</param>
+	uint64_t task_key(const PipelineTask& task, const Manifest& manifest) const;
+
+};
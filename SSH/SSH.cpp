@@ -1,11 +1,34 @@
 #include "SSH.h"
-
+#include "Agent.h"
+#include "Agent/hash.h"
+#include "Delta.h"
+#include "Manifest.h"
+#include "MappedFile.h"
+#include "Pipeline.h"
+
+#include <errno.h>
 #include <fcntl.h>
-
+#include <limits.h>
+#include <math.h>
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
 #include <filesystem>
 #include <format>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
 
 #include <libssh/libssh.h>
 #include <libssh/sftp.h>
@@ -15,6 +38,17 @@
 #ifdef WIN32
     // Define the read, write and execute permission bits
     #define S_IRWXU 0000700
+
+    // Pipes to the commands of the stages which run on the host
+    #define popen   _popen
+    #define pclose  _pclose
+#endif
+
+// Shell command which runs the command of a pipeline stage inside the local project folder, stderr is part of the output
+#ifdef WIN32
+    #define SSH_HOST_STAGE  "cd /d \"{}\" && ({}) 2>&1"
+#else
+    #define SSH_HOST_STAGE  "cd \"{}\" && ({}) 2>&1"
 #endif
 
 // Indicates that no Bytes were read after trying to read a SSH channel
@@ -23,6 +57,76 @@
 // Indicates that Bytes were read after trying to read a SSH channel
 #define SSH_BYTES_READ      1
 
+// Shell command which prints the hash of the sources of the project in the current folder, computed from the paths, sizes, and content hashes
+// inside its manifest (modification times and inodes don't count), prints nothing if the project has no manifest
+#define SSH_SOURCE_HASH     "test -f " SSH_MANIFEST_FILE " && tail -n +2 " SSH_MANIFEST_FILE " | cut -d\" \" -f1,2,5- | md5sum | cut -c1-32"
+
+// Shell commands which print what a built binary depends on: the architecture and CPU, the distribution, the C library, the compilers,
+// and a hash of the installed shared libraries (with their full versions), Raspberry Pis with the same output build the same binary
+#define SSH_FINGERPRINT     "uname -m; grep -E \"^CPU (implementer|part)\" /proc/cpuinfo | sort -u; (. /etc/os-release && echo \"$ID $VERSION_ID\"); " \
+                            "ldd --version 2>&1 | head -n 1; for c in cc c++ gcc g++ clang; do command -v $c > /dev/null && $c --version 2>&1 | head -n 1; done; " \
+                            "echo \"libraries $({ /sbin/ldconfig -p || ldconfig -p; } 2>/dev/null | sed -n \"s/.* => //p\" | xargs -r readlink -f | sort | md5sum | cut -c1-32)\""
+
+// Shell commands of the scripts which log into other Raspberry Pis: they read the password from stdin and create an askpass script which answers
+// the password prompt of ssh with it inside the temporary folder $x. SSH_PI_SSH is the ssh command which uses it (the host keys aren't checked)
+#define SSH_PI_ASKPASS      "read -r P; export P; x=$(mktemp -d) || exit 1; trap \"rm -rf $x\" EXIT; printf \"#!/bin/sh\\necho \\\"\\$P\\\"\\n\" > $x/pass; chmod 700 $x/pass; "
+#define SSH_PI_SSH          "SSH_ASKPASS=$x/pass SSH_ASKPASS_REQUIRE=force DISPLAY=: setsid -w ssh -o StrictHostKeyChecking=no -o UserKnownHostsFile=/dev/null -o LogLevel=ERROR"
+
+// Options of tar which leave out the state of the last build and start inside the Debug folder of the project $p (and object files), so that a relayed
+// project is built and started on every Raspberry Pi itself
+#define SSH_RELAY_EXCLUDE   "--exclude=$p/Debug/" SSH_PID_FILE " --exclude=$p/Debug/" SSH_EXIT_FILE " --exclude=$p/Debug/" SSH_LAUNCH_FILE " --exclude=$p/Debug/" SSH_CGROUP_FILE \
+                            " --exclude=$p/Debug/" SSH_GOVERNOR_FILE " --exclude=$p/Debug/output.txt --exclude=$p/Debug/" SSH_BUILD_FILE " --exclude=$p/Debug/" SSH_BUILD_LOG \
+                            " --exclude=$p/Debug/" SSH_BUILD_PID " --exclude=$p/Debug/$p \"--exclude=*.o\" \"--exclude=*.dcc*\""
+
+// Converts the value of an option to a number, only accepts numbers between min and max, an invalid value doesn't change the number
+static bool parse_option_number(const char* value, long min, long max, long* number) {
+    char* end;
+    errno = 0;
+    long parsed = strtol(value, &end, 10);
+    if (*value == '\0' || *end != '\0' || errno == ERANGE || parsed < min || parsed > max)
+        return false;
+
+    *number = parsed;
+    return true;
+}
+
+// Converts the value of a yes/no option, only accepts yes/no resp. true/false resp. 1/0 (an empty value is no)
+static bool parse_option_flag(const char* value, bool* flag) {
+    std::string text = value;
+    if (text == "yes" || text == "true" || text == "1")
+        *flag = true;
+    else if (text == "no" || text == "false" || text == "0" || text.empty())
+        *flag = false;
+    else
+        return false;
+
+    return true;
+}
+
+// Splits the comma separated value of an option, empty items (e.g., after a trailing comma) are skipped
+static std::vector<std::string> split_option_list(const char* value) {
+    std::vector<std::string> items;
+    std::string list = value;
+    for (size_t start = 0, end; start < list.length(); start = end + 1) {
+        end = std::min(list.find(',', start), list.length());
+        if (end > start)
+            items.push_back(list.substr(start, end - start));
+    }
+
+    return items;
+}
+
+// Returns the targets which reported their success to a script on the SSH client, i.e. the rest of the lines of its stdout which start with the given prefix
+static std::unordered_set<std::string> reported_targets(const std::string& out, const std::string& prefix) {
+    std::unordered_set<std::string> targets;
+    std::istringstream lines(out);
+    for (std::string line; std::getline(lines, line); )
+        if (line.starts_with(prefix))
+            targets.insert(line.substr(prefix.length()));
+
+    return targets;
+}
+
 // Constructor
 SSH::SSH() {
     // Initially not connected
@@ -85,12 +189,29 @@ int SSH::connect(const char* addr, unsigned int port, const char* user, const ch
 
     connected = true;
 
+    // Save the username, it's part of the agent's socket path, and the address, the default folder of collect
+    this->user = user;
+    this->addr = addr;
+
+    // Save the rest of the credentials to reconnect after a dropped connection
+    this->passwd = passwd;
+    this->port = port;
+    this->timeout = timeout;
+
+    // Open the token buckets which limit the transfers, without a shared bucket only the other limits apply
+    if (!bandwidth.open(addr, port, bandwidthLimit * 1024, subnetBandwidth * 1024, hostBandwidth * 1024))
+        std::cerr << "Can't open the shared bandwidth limits." << std::endl;
+
     return SSH_OK;
 }
 
 void SSH::disconnect() {
     // Only disconnect if there is a connection
     if (connected) {
+        // Close the channel to the agent, it keeps running on the client for the next connection
+        delete agent;
+        agent = nullptr;
+
         // Disconnect from the client
         ssh_disconnect(session);
 
@@ -99,6 +220,335 @@ void SSH::disconnect() {
     }
 }
 
+int SSH::setOption(const char* key, const char* value) {
+    std::string option = key;
+
+    // Remember the option for the further connections of pipeline
+    optionValues.emplace_back(option, value);
+
+    // If the workspace on the SSH client should be changed
+    if (option == "workspace") {
+        std::string path = value;
+
+        // Use the RAM (tmpfs) workspace for "ram", the persistent workspace for "sd" or an empty value, else the given path
+        if (path == "ram")
+            workspace = SSH_RAM_WORKSPACE;
+        else if (path == "sd" || path.empty())
+            workspace = SSH_WORKSPACE;
+        else
+            workspace = path;
+
+        // Remove trailing slashes because the paths are appended with a slash
+        while (workspace.length() > 1 && workspace.back() == '/')
+            workspace.pop_back();
+    }
+    // If the time to wait for the application after SIGTERM should be changed
+    else if (option == "stopTimeout") {
+        // Only accept 1 second to an hour, the agent gets the time in milliseconds
+        if (!parse_option_number(value, 1, 3600, &stopTimeout)) {
+            // Print an error message to stderr
+            std::cerr << "Invalid value for option stopTimeout: " << value << std::endl;
+
+            return SSH_ERROR;
+        }
+    }
+    // If the built binary should be copied to the persistent workspace
+    else if (option == "persistBinary") {
+        // Only accept yes/no resp. true/false resp. 1/0
+        if (!parse_option_flag(value, &persistBinary)) {
+            // Print an error message to stderr
+            std::cerr << "Invalid value for option persistBinary: " << value << std::endl;
+
+            return SSH_ERROR;
+        }
+    }
+
+    // If the application should be bound to some CPUs
+    else if (option == "cpuAffinity") {
+        std::string cpus = value;
+
+        // Only accept a list of CPUs resp. ranges like taskset, because the value becomes part of the launcher script
+        if (cpus.find_first_not_of("0123456789,-") != std::string::npos) {
+            // Print an error message to stderr
+            std::cerr << "Invalid value for option cpuAffinity: " << value << std::endl;
+
+            return SSH_ERROR;
+        }
+
+        cpuAffinity = cpus;
+    }
+    // If the nice value of the application should be changed
+    else if (option == "nice") {
+        // Only accept the valid nice values
+        if (!parse_option_number(value, -20, 19, &niceness)) {
+            // Print an error message to stderr
+            std::cerr << "Invalid value for option nice: " << value << std::endl;
+
+            return SSH_ERROR;
+        }
+    }
+    // If the application should be run with a real-time priority
+    else if (option == "rtPriority") {
+        // Only accept the priorities of SCHED_FIFO, 0 disables it
+        if (!parse_option_number(value, 0, 99, &rtPriority)) {
+            // Print an error message to stderr
+            std::cerr << "Invalid value for option rtPriority: " << value << std::endl;
+
+            return SSH_ERROR;
+        }
+    }
+    // If the memory of the application's cgroup should be limited
+    else if (option == "memoryLimit") {
+        std::string limit = value;
+
+        // Remove the optional unit (K, M, G) of the number of Bytes like memory.max
+        std::string number = limit;
+        if (!number.empty() && std::string("KMG").find(number.back()) != std::string::npos)
+            number.pop_back();
+
+        // Only accept a number (or an empty value for no limit), because the value becomes part of the launcher script
+        if (!limit.empty() && (number.empty() || number.find_first_not_of("0123456789") != std::string::npos)) {
+            // Print an error message to stderr
+            std::cerr << "Invalid value for option memoryLimit: " << value << std::endl;
+
+            return SSH_ERROR;
+        }
+
+        memoryLimit = limit;
+    }
+    // If the CPU time of the application's cgroup should be limited
+    else if (option == "cpuLimit") {
+        // Accept percent of one CPU, 0 disables the limit
+        if (!parse_option_number(value, 0, 100000, &cpuLimit)) {
+            // Print an error message to stderr
+            std::cerr << "Invalid value for option cpuLimit: " << value << std::endl;
+
+            return SSH_ERROR;
+        }
+    }
+    // If a CPU frequency governor should be set while the application is running
+    else if (option == "governor") {
+        std::string name = value;
+
+        // Only accept names of governors (e.g., performance, ondemand), because the value becomes part of the launcher script
+        if (name.find_first_not_of("abcdefghijklmnopqrstuvwxyz_") != std::string::npos) {
+            // Print an error message to stderr
+            std::cerr << "Invalid value for option governor: " << value << std::endl;
+
+            return SSH_ERROR;
+        }
+
+        governor = name;
+    }
+    // If the application should be started at a given time (milliseconds since the Unix epoch on our clock)
+    else if (option == "startAt") {
+        // Only accept positive numbers, 0 starts immediately
+        char* end;
+        long long time = strtoll(value, &end, 10);
+        if (*value == '\0' || *end != '\0' || time < 0) {
+            // Print an error message to stderr
+            std::cerr << "Invalid value for option startAt: " << value << std::endl;
+
+            return SSH_ERROR;
+        }
+
+        startAt = time;
+    }
+    // If other results should be downloaded by collect
+    else if (option == "results") {
+        results.clear();
+
+        // Split the comma separated paths
+        for (const std::string& path : split_option_list(value)) {
+            // Only accept paths inside the project, they are also used as local paths
+            if (path.front() == '/' || std::filesystem::path(path).lexically_normal().string().starts_with("..")) {
+                // Print an error message to stderr
+                std::cerr << "Invalid value for option results: " << path << " is outside of the project" << std::endl;
+
+                return SSH_ERROR;
+            }
+
+            results.push_back(path);
+        }
+    }
+    // If the minimum size of files which are sent as delta should be changed
+    else if (option == "deltaMinSize") {
+        // Only accept positive numbers, 0 disables the delta transfer
+        if (!parse_option_number(value, 0, LONG_MAX, &deltaMinSize)) {
+            // Print an error message to stderr
+            std::cerr << "Invalid value for option deltaMinSize: " << value << std::endl;
+
+            return SSH_ERROR;
+        }
+    }
+    // If the project should be built even if its sources haven't changed
+    else if (option == "rebuild") {
+        // Only accept yes/no resp. true/false resp. 1/0
+        if (!parse_option_flag(value, &rebuild)) {
+            // Print an error message to stderr
+            std::cerr << "Invalid value for option rebuild: " << value << std::endl;
+
+            return SSH_ERROR;
+        }
+    }
+    // If the build should be aborted on the first error
+    else if (option == "abortOnError") {
+        // Only accept yes/no resp. true/false resp. 1/0
+        if (!parse_option_flag(value, &abortOnError)) {
+            // Print an error message to stderr
+            std::cerr << "Invalid value for option abortOnError: " << value << std::endl;
+
+            return SSH_ERROR;
+        }
+    }
+    // If the sent files should be verified
+    else if (option == "verify") {
+        // Only accept yes/no resp. true/false resp. 1/0
+        if (!parse_option_flag(value, &verify)) {
+            // Print an error message to stderr
+            std::cerr << "Invalid value for option verify: " << value << std::endl;
+
+            return SSH_ERROR;
+        }
+    }
+    // If the files should be hard links into the object store
+    else if (option == "objectStore") {
+        // Only accept yes/no resp. true/false resp. 1/0
+        if (!parse_option_flag(value, &objectStore)) {
+            // Print an error message to stderr
+            std::cerr << "Invalid value for option objectStore: " << value << std::endl;
+
+            return SSH_ERROR;
+        }
+    }
+    // If the fan-out of a relay should be changed
+    else if (option == "relayFanout") {
+        // Only accept 0 (choose it by the number of targets) to 16 Raspberry Pis
+        if (!parse_option_number(value, 0, 16, &relayFanout)) {
+            // Print an error message to stderr
+            std::cerr << "Invalid value for option relayFanout: " << value << std::endl;
+
+            return SSH_ERROR;
+        }
+    }
+    // If the transfers of all SSH processes of the host, to a subnet, or to the SSH client should be rate-limited
+    else if (option == "bandwidth" || option == "subnetBandwidth" || option == "hostBandwidth") {
+        long* rate = option == "bandwidth" ? &bandwidthLimit : option == "subnetBandwidth" ? &subnetBandwidth : &hostBandwidth;
+
+        // Only accept positive rates in KiB/s, 0 disables the limit
+        if (!parse_option_number(value, 0, LONG_MAX / 1024, rate)) {
+            // Print an error message to stderr
+            std::cerr << "Invalid value for option " << option << ": " << value << std::endl;
+
+            return SSH_ERROR;
+        }
+    }
+    // If the minimum size of the files which are uploaded resumable should be changed
+    else if (option == "resumeMinSize") {
+        // Only accept positive numbers, 0 disables the part files
+        if (!parse_option_number(value, 0, LONG_MAX, &resumeMinSize)) {
+            // Print an error message to stderr
+            std::cerr << "Invalid value for option resumeMinSize: " << value << std::endl;
+
+            return SSH_ERROR;
+        }
+    }
+    // If update should create releases and how many of them should be kept
+    else if (option == "releases") {
+        // Only accept 0 (update in place) to 100 releases
+        if (!parse_option_number(value, 0, 100, &keepReleases)) {
+            // Print an error message to stderr
+            std::cerr << "Invalid value for option releases: " << value << std::endl;
+
+            return SSH_ERROR;
+        }
+    }
+    // If the number of reconnection attempts during an upload should be changed
+    else if (option == "reconnects") {
+        // Only accept 0 (don't reconnect) to 10 attempts, the waiting time doubles with every attempt
+        if (!parse_option_number(value, 0, 10, &reconnects)) {
+            // Print an error message to stderr
+            std::cerr << "Invalid value for option reconnects: " << value << std::endl;
+
+            return SSH_ERROR;
+        }
+    }
+    // If folders and files of every project shouldn't be deployed
+    else if (option == "ignore") {
+        // Split the comma separated patterns
+        ignore = split_option_list(value);
+    }
+    // If the compile jobs should be distributed to other Raspberry Pis
+    else if (option == "helpers") {
+        // Split the comma separated addresses
+        helpers = split_option_list(value);
+    }
+    // If pipeline should run the stages on further Raspberry Pis
+    else if (option == "pipelinePis") {
+        // Split the comma separated addresses
+        pipelinePis = split_option_list(value);
+    }
+    // If the object files of compile should be shared through the compiler cache on the host
+    else if (option == "cache") {
+        // yes uses the cache inside the temporary folder, no (or an empty value) disables it, every other value is the folder of the cache
+        bool enabled;
+        if (!parse_option_flag(value, &enabled))
+            cacheFolder = value;
+        else if (enabled) {
+            std::error_code ec;
+            cacheFolder = (std::filesystem::temp_directory_path(ec) / BUILD_CACHE_FOLDER).string();
+        }
+        else
+            cacheFolder.clear();
+    }
+    // If the size of the compiler cache should be changed
+    else if (option == "cacheSize") {
+        // Only accept positive sizes in MiB
+        if (!parse_option_number(value, 1, LONG_MAX / (1024 * 1024), &cacheSize)) {
+            // Print an error message to stderr
+            std::cerr << "Invalid value for option cacheSize: " << value << std::endl;
+
+            return SSH_ERROR;
+        }
+    }
+    // If the SSH traffic should be compressed (e.g., for results which compress well over a slow network)
+    else if (option == "compress") {
+        // Only accept yes/no resp. true/false resp. 1/0, the option has to be set before connecting
+        bool compress;
+        if (!parse_option_flag(value, &compress)) {
+            // Print an error message to stderr
+            std::cerr << "Invalid value for option compress: " << value << std::endl;
+
+            return SSH_ERROR;
+        }
+
+        ssh_options_set(session, SSH_OPTIONS_COMPRESSION, compress ? "yes" : "no");
+    }
+    // If the agent should (not) be used or its sources are somewhere else
+    else if (option == "agent") {
+        // Use the default sources for "yes" (or an empty value), no agent for "no", else the given folder
+        bool enabled;
+        if (*value == '\0')
+            agentDir = AGENT_DIR;
+        else if (!parse_option_flag(value, &enabled))
+            agentDir = value;
+        else
+            agentDir = enabled ? AGENT_DIR : "";
+    }
+
+    // Unknown options are ignored because they may be meant for the GUI
+    return SSH_OK;
+}
+
+bool SSH::is_volatile_workspace() {
+    // Every other workspace than the one in the home directory isn't persistent, a staged release belongs to the workspace it was created in
+    return shared_workspace() != SSH_WORKSPACE;
+}
+
+const std::string& SSH::shared_workspace() {
+    return liveWorkspace.empty() ? workspace : liveWorkspace;
+}
+
 size_t SSH::write_to_stdout(const char* buffer, size_t count) {
     // Write the buffer to stdout, save the number of written bytes (should be equal to count)
     size_t nbytes = fwrite(buffer, 1, count, stdout);
@@ -116,8 +566,13 @@ size_t SSH::write_to_stderr(const char* buffer, size_t count) {
 }
 
 int SSH::channel_redirect_output(ssh_channel* channel, enum File from, size_t (*to)(const char*, size_t), unsigned int buffer_size) {
-    // Allocate a new array for the bytes to read
-    char* buffer = new char[buffer_size];
+    // Reuse the read buffer of previous calls, only grow it if a larger one is requested
+    if (channelBuffer.size() < buffer_size)
+        channelBuffer.resize(buffer_size);
+
+    // Read into the whole buffer, it may be larger than requested
+    char* buffer = channelBuffer.data();
+    buffer_size = (unsigned int)channelBuffer.size();
 
     // Save if Bytes were read
     bool bytesRead = false;
@@ -140,9 +595,6 @@ int SSH::channel_redirect_output(ssh_channel* channel, enum File from, size_t (*
         } while (nbytes > 0);
     }
 
-    // Free the allocated array
-    delete[] buffer;
-
     // If there was an error while reading
     if (nbytes < 0)
         return SSH_ERROR;
@@ -151,7 +603,7 @@ int SSH::channel_redirect_output(ssh_channel* channel, enum File from, size_t (*
     return bytesRead ? SSH_BYTES_READ : SSH_NO_BYTES_READ;
 }
 
-int SSH::execute(const char* cmd, unsigned int buffer_size) {
+ssh_channel SSH::open_exec_channel(const char* cmd) {
     // Allocate a new channel
     ssh_channel channel = ssh_channel_new(session);
 
@@ -160,7 +612,7 @@ int SSH::execute(const char* cmd, unsigned int buffer_size) {
         // Print an error message
         std::cerr << "Couldn't create Channel." << std::endl;
 
-        return SSH_ERROR;
+        return nullptr;
     }
 
     // Open a session channel (shell) ...
@@ -172,7 +624,7 @@ int SSH::execute(const char* cmd, unsigned int buffer_size) {
         // Free the channel
         ssh_channel_free(channel);
 
-        return SSH_ERROR;
+        return nullptr;
     }
 
     // Run the given shell command cmd (sh -c cmd) ...
@@ -185,9 +637,20 @@ int SSH::execute(const char* cmd, unsigned int buffer_size) {
         ssh_channel_close(channel);
         ssh_channel_free(channel);
 
-        return SSH_ERROR;
+        return nullptr;
     }
 
+    return channel;
+}
+
+int SSH::execute(const char* cmd, unsigned int buffer_size) {
+    // Open a new channel which runs the given shell command
+    ssh_channel channel = open_exec_channel(cmd);
+
+    // If the channel couldn't be opened
+    if (channel == nullptr)
+        return SSH_ERROR;
+
     // Read from the client's stdout and redirect to host's stdout, check if there was an error
     if (channel_redirect_output(&channel, File::STDOUT, write_to_stdout, buffer_size) == SSH_ERROR) {
         // Print the error message
@@ -224,260 +687,2226 @@ int SSH::execute(const char* cmd, unsigned int buffer_size) {
     return rc == SSH_BYTES_READ ? SSH_CMD_ERROR : SSH_OK;
 }
 
-int SSH::get_project_dirs_and_files(const char* project, const char* path2project, std::list<std::string>* dirs, std::list<std::string>* files) {
-    try {
-        // Recursively iterate through all folders and files (entries) of the given project
-        for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(std::format("{}/{}", path2project, project))) {
-            // Get the path of the current entry
-            std::filesystem::path path = entry.path();
+int SSH::channel_read_all(ssh_channel* channel, enum File from, std::string* data) {
+    // Buffer for the bytes to read
+    char buffer[16384];
 
-            // Convert the absolute path to a path relative to path2project, get the path as string and append it to the respective directory or file list
-            (is_directory(path) ? dirs : files)->push_back(relative(path, path2project).generic_string());
-        }
-    }
-    // If an error, exception occured (e.g., The project is missing and/or path2project is invalid)
-    catch (const std::filesystem::filesystem_error& err) {
-        // Print the exception message to stderr
-        std::cerr << err.what() << std::endl;
+    // Read data from stdout or stderr until the end of file is reached
+    int nbytes;
+    while ((nbytes = ssh_channel_read(*channel, buffer, sizeof(buffer), from)) > 0)
+        // Append the read Bytes
+        data->append(buffer, nbytes);
+
+    // Return if there was an error while reading
+    return nbytes < 0 ? SSH_ERROR : SSH_OK;
+}
+
+int SSH::execute_capture(const char* cmd, std::string* out, std::string* err, const std::string* input) {
+    // Open a new channel which runs the given shell command
+    ssh_channel channel = open_exec_channel(cmd);
+
+    // If the channel couldn't be opened
+    if (channel == nullptr)
+        return SSH_ERROR;
+
+    // Write the input to stdin of the command and close it, then read the whole stdout and stderr of the command
+    if ((input != nullptr && (ssh_channel_write(channel, input->data(), (uint32_t)input->size()) != (int)input->size() || ssh_channel_send_eof(channel) != SSH_OK))
+        || channel_read_all(&channel, File::STDOUT, out) != SSH_OK || channel_read_all(&channel, File::STDERR, err) != SSH_OK) {
+        // Print the error message
+        std::cerr << ssh_get_error(session) << std::endl;
+
+        // Close and free the channel
+        ssh_channel_close(channel);
+        ssh_channel_free(channel);
 
         return SSH_ERROR;
     }
 
+    // Send an end of file, close and free the channel
+    ssh_channel_send_eof(channel);
+    ssh_channel_close(channel);
+    ssh_channel_free(channel);
+
     return SSH_OK;
 }
 
-int SSH::project_mkdirs(const char* project, std::list<std::string>* dirs) {
-    // Create the command for removing and recreating the current sw_workspace folder and creating the project folder
-    //std::string cmd = format("rm -rf sw_workspace && mkdir sw_workspace sw_workspace/{}", project);
-    std::string cmd = std::format("mkdir -p sw_workspace && rm -rf sw_workspace/{}/* && mkdir -p sw_workspace/{}", project, project);
+int SSH::execute_stream(const char* cmd, std::string* out, std::string* err, const std::string* input, bool serveCache, const std::string& abortCmd) {
+    // Open a new channel which runs the given shell command
+    ssh_channel channel = open_exec_channel(cmd);
 
-    // Iterate through all directories of the project
-    for (std::string dirPath : *dirs)
-        // Append the current directory to the mkdir command
-        cmd.append(std::format(" sw_workspace/{}", dirPath));
+    // If the channel couldn't be opened
+    if (channel == nullptr)
+        return SSH_ERROR;
 
-    // Execute the command, return the return code
-    return execute(cmd.c_str());
-}
+    // Write the input to stdin of the command and close it
+    bool failed = input != nullptr && (ssh_channel_write(channel, input->data(), (uint32_t)input->size()) != (int)input->size() || ssh_channel_send_eof(channel) != SSH_OK);
+
+    // If the command should be aborted resp. was stopped, and up to where stderr was searched for errors
+    bool aborted = false, killed = false;
+    size_t scanned = 0;
+
+    // Until the command has finished, the compilers wait for the answers of the cache, so that stdout and stderr can't be read at once
+    char buffer[16384];
+    while (!failed && !ssh_channel_is_eof(channel)) {
+        // Accept the connections to the cache and answer their complete requests without waiting for the others, resp. wait shortly for new output
+        ssh_channel request;
+        if (serveCache) {
+            while ((request = ssh_channel_accept_forward(session, 10, nullptr)) != nullptr)
+                buildCache.accept(request);
+            buildCache.serve();
+        }
+        else
+            ssh_channel_poll_timeout(channel, 10, File::STDOUT);
+
+        // Print and append what the command printed meanwhile
+        int nbytes;
+        while ((nbytes = ssh_channel_read_nonblocking(channel, buffer, sizeof(buffer), File::STDOUT)) > 0) {
+            write_to_stdout(buffer, nbytes);
+            out->append(buffer, nbytes);
+        }
+        failed |= nbytes < 0 && nbytes != SSH_EOF;
 
-int SSH::project_save_file(sftp_session* sftp, std::string filePath, const char* path2project, unsigned int buffer_size) {
-    // Create the local path of the file
-    std::string localPath = std::format("{}/{}", path2project, filePath);
+        while ((nbytes = ssh_channel_read_nonblocking(channel, buffer, sizeof(buffer), File::STDERR)) > 0) {
+            write_to_stderr(buffer, nbytes);
+            err->append(buffer, nbytes);
+        }
+        failed |= nbytes < 0 && nbytes != SSH_EOF;
 
-    // Open the local file in binary mode
-    std::ifstream localFile(localPath, std::ifstream::binary);
+        // With the option abortOnError, an error of the compiler ("error:") or of make ("*** ") aborts the command
+        if (abortOnError && !aborted && (err->find("error:", scanned) != std::string::npos || err->find("*** ", scanned) != std::string::npos))
+            aborted = true;
+        scanned = err->length() > 5 ? err->length() - 5 : 0;
 
-    // If the local file couldn't be opened
-    if (!localFile.is_open()) {
-        // Print an error message to stderr
-        std::cerr << "Can't open local file " << localPath << std::endl;
+        // Stop the command until the abort command succeeded, it fails as long as the command hasn't saved its PID
+        if (!abortCmd.empty() && (aborted || abort_requested()) && !killed) {
+            aborted = true;
 
-        return SSH_ERROR;
+            std::string killOut, killErr;
+            killed = execute_capture(abortCmd.c_str(), &killOut, &killErr) == SSH_OK && killOut.find("killed") != std::string::npos;
+        }
     }
 
-    // Create the remote path of the file
-    std::string remotePath = format("sw_workspace/{}", filePath);
+    // The compilers have finished, close the connections to the cache which weren't answered
+    if (serveCache)
+        buildCache.discard();
 
-    // Open the remote file in write mode, if it doesn't exist yet create it, else truncate it
-    // give user read, write and execute permission
-    sftp_file remoteFile = sftp_open(*sftp, remotePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRWXU);
-
-    // If the remote file couldn't be opened
-    if (remoteFile == nullptr) {
-        // Print the error message to stderr
-        std::cerr << "Can't open remote file " << remotePath << ": " << ssh_get_error(session) << std::endl;
+    // If there was an error while writing or reading
+    if (failed) {
+        // Print the error message
+        std::cerr << ssh_get_error(session) << std::endl;
 
-        // Close the local file
-        localFile.close();
+        // Close and free the channel
+        ssh_channel_close(channel);
+        ssh_channel_free(channel);
 
         return SSH_ERROR;
     }
 
-    // Allocate a new array for the Bytes to read
-    char* text = new char[buffer_size];
+    // Send an end of file, close and free the channel
+    ssh_channel_send_eof(channel);
+    ssh_channel_close(channel);
+    ssh_channel_free(channel);
 
-    // While the end of the local file isn't reached
-    do {
-        // Read the first buffer_size Bytes from the local file
-        localFile.read(text, buffer_size);
+    // The command only counts as aborted if it was stopped before it finished by itself
+    return killed ? SSH_CMD_ERROR : SSH_OK;
+}
 
-        // If there was an error reading the local file
-        if (localFile.bad()) {
-            // Print an error message to stderr
-            std::cerr << "Error reading local file " << localPath << std::endl;
+bool SSH::abort() {
+    // Request the abort, it's only handled while a build or a pipeline is running
+    abortRequested = true;
 
-            // Close the local and remote file
-            localFile.close();
-            sftp_close(remoteFile);
+    return abortable || pipelineRunning;
+}
 
-            // Free the allocated array
-            delete[] text;
+bool SSH::abort_requested() const {
+    // The connections of the tasks of a pipeline are aborted together with it
+    return abortRequested || (parent != nullptr && parent->abort_requested());
+}
 
-            return SSH_ERROR;
-        }
+int SSH::execute_batch(std::vector<BatchCommand>* cmds) {
+    // Create a random marker which separates the outputs of the commands, so that it doesn't occur inside an output
+    std::random_device random;
+    std::string marker = std::format("@@PIDEPLOY{:08x}{:08x}", random(), random());
 
-        // Get the number of Bytes read
-        size_t nbytes = localFile.gcount();
+    // Create a temporary file for the stderr of the current command
+    std::string script = "t=$(mktemp) || exit 1; ";
 
-        // Write the Bytes to the remote file, verify that all Bytes have been written
-        if (sftp_write(remoteFile, text, nbytes) != nbytes) {
-            // Print the error message to stderr
-            std::cerr << ssh_get_error(session) << std::endl;
+    // Iterate through all commands
+    for (size_t i = 0; i < cmds->size(); i++)
+        // Run the command inside a subshell (so that cd, exit, etc. don't affect the following commands) and save its stderr
+        // Print a line with the marker, index, exit code, and size of stderr after its stdout, followed by the stderr
+        script.append(std::format("( {}\n) 2>\"$t\"; printf '\\n{} %d %d %d\\n' {} $? $(wc -c < \"$t\"); cat \"$t\"; ",
+            (*cmds)[i].cmd, marker, i));
 
-            // Close the local and remote file
-            localFile.close();
-            sftp_close(remoteFile);
+    // Remove the temporary file
+    script.append("rm -f \"$t\"");
 
-            // Free the allocated array
-            delete[] text;
+    // Execute the whole script over a single channel
+    std::string out, err;
+    int rc = execute_capture(script.c_str(), &out, &err);
+
+    // If there was a connection error
+    if (rc != SSH_OK)
+        return rc;
+
+    // Current position inside the output
+    size_t pos = 0;
+
+    // Demultiplex the output of every command
+    for (size_t i = 0; i < cmds->size(); i++) {
+        BatchCommand& command = (*cmds)[i];
+
+        // Search for the marker line of the command, it's preceded by a newline which isn't part of the stdout
+        size_t markerPos = out.find(std::format("\n{} {} ", marker, i), pos);
+
+        // If the marker is missing the script was aborted
+        if (markerPos == std::string::npos) {
+            // Print an error message and the stderr of the script
+            std::cerr << "Incomplete output of the batched commands. " << err << std::endl;
 
             return SSH_ERROR;
         }
-    } while (!localFile.eof());
 
-    // Print the success to stdout
-    std::cout << filePath << " was saved successfully." << std::endl;
+        // Save the stdout of the command
+        command.out = out.substr(pos, markerPos - pos);
 
-    // Close the local and remote file
-    localFile.close();
-    sftp_close(remoteFile);
+        // Parse the exit code and size of stderr behind the marker
+        size_t errSize = 0;
+        size_t lineEnd = out.find('\n', markerPos + 1);
+        if (lineEnd == std::string::npos || sscanf(out.c_str() + markerPos + marker.length() + 1, "%*d %d %zu", &command.rc, &errSize) != 2) {
+            // Print an error message
+            std::cerr << "Invalid output of the batched commands." << std::endl;
 
-    // Free the allocated array
-    delete[] text;
+            return SSH_ERROR;
+        }
+
+        // Save the stderr of the command and continue behind it
+        command.err = out.substr(lineEnd + 1, errSize);
+        pos = std::min(lineEnd + 1 + errSize, out.length());
+    }
 
     return SSH_OK;
 }
 
-int SSH::project_save_files(std::list<std::string>* files, const char* path2project) {
+bool SSH::use_agent() {
+    // If the agent shouldn't be used or there is no connection
+    if (agentDir.empty() || !connected)
+        return false;
+
+    // If it was already tried to connect to the agent
+    if (agent != nullptr)
+        return agent->isOpen();
+
+    agent = new Agent(session);
+
+    // Read the sources of the agent, the shell commands are used if they are missing
+    std::vector<std::pair<std::string, std::string>> sources = { { "protocol.h", "" }, { "hash.h", "" }, { "agent.cpp", "" } };
+    for (auto& [file, content] : sources) {
+        std::ifstream source(std::format("{}/{}", agentDir, file), std::ifstream::binary);
+        if (!source.is_open())
+            return false;
+
+        content.assign(std::istreambuf_iterator<char>(source), std::istreambuf_iterator<char>());
+    }
+
+    // Hash the sources (FNV-1a), so that a changed agent is built and started next to the old one
+    uint64_t hash = 0xcbf29ce484222325;
+    for (auto& [file, content] : sources)
+        for (char c : file + content)
+            hash = (hash ^ (unsigned char)c) * 0x100000001b3;
+
+    // Name of the binary and its socket. The socket is inside the agent folder in the home directory, which only the user can change,
+    // so that no other user can listen on it first. The path has to be absolute for the forwarding
+    std::string name = std::format("agent-{:016x}", hash);
+    std::string home, err;
+    if (execute_capture("printf %s ~", &home, &err) != SSH_OK || home.empty() || home[0] != '/')
+        return false;
+
+    std::string socketPath = std::format("{}/{}/{}.sock", home, SSH_AGENT_FOLDER, name);
+
+    // Connect to the running agent
+    if (agent->open(socketPath.c_str()) == SSH_OK)
+        return true;
+
+    // Else build and start it, then try again
+    return agent_deploy(name, sources, socketPath) == SSH_OK && agent->open(socketPath.c_str()) == SSH_OK;
+}
+
+int SSH::agent_deploy(const std::string& name, const std::vector<std::pair<std::string, std::string>>& sources, const std::string& socketPath) {
+    // Folder for the sources of this agent version
+    std::string srcDir = std::format("{}/{}-src", SSH_AGENT_FOLDER, name);
+
+    // Create a new SFTP session to upload the sources
+    sftp_session sftp = sftp_new(session);
+    if (sftp == nullptr || sftp_init(sftp) != SSH_OK) {
+        // Print an error message
+        std::cerr << "Error initializing SFTP session for the agent: " << ssh_get_error(session) << std::endl;
+
+        if (sftp != nullptr)
+            sftp_free(sftp);
+
+        return SSH_ERROR;
+    }
+
+    // Only upload the sources if the binary doesn't exist yet
+    sftp_attributes attributes = sftp_stat(sftp, std::format("{}/{}", SSH_AGENT_FOLDER, name).c_str());
+    if (attributes != nullptr)
+        sftp_attributes_free(attributes);
+    else {
+        // Create the folders, they may already exist
+        sftp_mkdir(sftp, SSH_AGENT_FOLDER, S_IRWXU);
+        sftp_mkdir(sftp, srcDir.c_str(), S_IRWXU);
+
+        // Write every source file
+        for (auto& [file, content] : sources) {
+            std::string remotePath = std::format("{}/{}", srcDir, file);
+            sftp_file remoteFile = sftp_open(sftp, remotePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRWXU);
+
+            // If the remote file couldn't be opened or written
+            if (remoteFile == nullptr || sftp_write(remoteFile, content.data(), content.size()) != (ssize_t)content.size()) {
+                // Print the error message to stderr
+                std::cerr << "Can't upload the agent source " << remotePath << ": " << ssh_get_error(session) << std::endl;
+
+                if (remoteFile != nullptr)
+                    sftp_close(remoteFile);
+                sftp_free(sftp);
+
+                return SSH_ERROR;
+            }
+
+            sftp_close(remoteFile);
+        }
+    }
+
+    // Close and deallocate the SFTP session
+    sftp_free(sftp);
+
+    // Create the command which builds the agent (if needed) and starts it from the home directory as leader of a new session
+    std::string cmd = std::format(
+        // Build the binary under a temporary name, so that an aborted build isn't used, and remove the sources afterwards
+        "{{ test -x {}/{} || {{ g++ -O2 -std=c++17 -o {}/{}.tmp {}/agent.cpp && mv {}/{}.tmp {}/{}; }}; }} && rm -rf {} && "
+
+        // Start the agent in background, it exits by itself if another one already listens on the socket
+        "{{ setsid {}/{} --listen {} </dev/null &>/dev/null & "
+
+        // Wait up to five seconds until the socket was created
+        "for ((i = 0; i < 50; i++)); do test -S {} && break; sleep 0.1; done; }}",
+    SSH_AGENT_FOLDER, name, SSH_AGENT_FOLDER, name, srcDir, SSH_AGENT_FOLDER, name, SSH_AGENT_FOLDER, name, srcDir,
+    SSH_AGENT_FOLDER, name, socketPath, socketPath);
+
+    // Execute the command, compiler errors are printed to stderr
+    return execute(cmd.c_str());
+}
+
+int SSH::execute_agent(const char* cmd) {
+    // If the agent can be used
+    if (use_agent()) {
+        // Let the agent execute the command
+        std::string payload, response;
+        agent::put_string(&payload, cmd);
+
+        // Only a request which couldn't be sent falls back to a new channel. Once it was sent the command may have run,
+        // and running it again (e.g., a start or a chain of rm and mv) isn't safe
+        uint32_t id = agent->send(AGENT_EXEC, payload);
+        if (id != 0) {
+            // Decode the exit code, stdout, and stderr
+            size_t pos = 0;
+            uint32_t rc;
+            std::string out, err;
+            if (agent->receive(id, &response) != SSH_OK ||
+                !agent::get_u32(response, &pos, &rc) || !agent::get_string(response, &pos, &out) || !agent::get_string(response, &pos, &err)) {
+                // Print an error message to stderr
+                std::cerr << "The agent didn't answer the command, it may have been executed." << std::endl;
+
+                return SSH_ERROR;
+            }
+
+            // Print stdout and stderr like execute
+            write_to_stdout(out.data(), out.length());
+            write_to_stderr(err.data(), err.length());
+
+            // If something was written to stderr (i.e., an error occured executing the command) return SSH_CMD_ERROR, SSH_OK else
+            return err.empty() ? SSH_OK : SSH_CMD_ERROR;
+        }
+    }
+
+    // Else execute the command over a new channel
+    return execute(cmd);
+}
+
+sftp_session SSH::sftp_start() {
     // Create a new SFTP session and allocate a new SFTP channel
     sftp_session sftp = sftp_new(session);
 
-    // If there was an allocation error
-    if (sftp == nullptr) {
+    // If there was an allocation error
+    if (sftp == nullptr) {
+        // Print the error message to stderr
+        std::cerr << "Error allocating SFTP session: " << ssh_get_error(session) << std::endl;
+
+        return nullptr;
+    }
+
+    // Initialize the SFTP protocol with the server
+    if (sftp_init(sftp) != SSH_OK) {
+        // Print an error message together with the error code
+        std::cerr << "Error initializing SFTP session: code " << sftp_get_error(sftp) << std::endl;
+
+        // Close and deallocate the SFTP session
+        sftp_free(sftp);
+
+        return nullptr;
+    }
+
+    return sftp;
+}
+
+int SSH::reconnect(sftp_session* sftp, long attempt) {
+    // Free the SFTP session, its channel belongs to the dropped connection
+    if (*sftp != nullptr)
+        sftp_free(*sftp);
+    *sftp = nullptr;
+
+    // Close the dropped connection (and the channel to the agent), copy the credentials because connect saves them again
+    disconnect();
+    std::string addr = this->addr, user = this->user, passwd = this->passwd;
+
+    // Wait 1, 2, 4, ... seconds, the network or the SSH client may need some time to come back
+    std::this_thread::sleep_for(std::chrono::seconds(1L << std::min(attempt, 5L)));
+
+    // Connect again and start a new SFTP session
+    if (connect(addr.c_str(), port, user.c_str(), passwd.c_str(), timeout) != SSH_OK)
+        return SSH_ERROR;
+
+    *sftp = sftp_start();
+    return *sftp != nullptr ? SSH_OK : SSH_ERROR;
+}
+
+bool SSH::connection_lost(sftp_session* sftp) {
+    // The session isn't connected anymore or the SFTP server reported the lost connection
+    int error = sftp_get_error(*sftp);
+    return ssh_is_connected(session) == 0 || error == SSH_FX_CONNECTION_LOST || error == SSH_FX_NO_CONNECTION;
+}
+
+int SSH::manifest_build(Manifest* manifest, const char* project, const char* path2project) {
+    // Add the global patterns, the scan adds the ones of the project
+    for (const std::string& pattern : ignore)
+        manifest->ignore.add(pattern);
+
+    // Walk the project and hash its files in parallel, unchanged files take their hash from the cache
+    return manifest->build(project, path2project);
+}
+
+int SSH::sftp_read_all(sftp_session* sftp, const std::string& remotePath, std::string* data) {
+    // Open the remote file in read mode
+    sftp_file remoteFile = sftp_open(*sftp, remotePath.c_str(), O_RDONLY, 0);
+
+    // If the remote file couldn't be opened, distinguish a missing file from other errors
+    if (remoteFile == nullptr)
+        return sftp_get_error(*sftp) == SSH_FX_NO_SUCH_FILE ? SSH_CMD_ERROR : SSH_ERROR;
+
+    // Read until the end of the file
+    data->clear();
+    char buffer[16384];
+    ssize_t nbytes;
+    while ((nbytes = sftp_read(remoteFile, buffer, sizeof(buffer))) > 0)
+        data->append(buffer, nbytes);
+
+    // Close the remote file
+    sftp_close(remoteFile);
+
+    return nbytes == 0 ? SSH_OK : SSH_ERROR;
+}
+
+int SSH::sftp_write_all(sftp_session* sftp, const std::string& remotePath, const std::string& data) {
+    // Open the remote file in write mode, if it doesn't exist yet create it, else truncate it
+    sftp_file remoteFile = sftp_open(*sftp, remotePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+
+    // If the remote file couldn't be opened
+    if (remoteFile == nullptr) {
+        // Print the error message to stderr
+        std::cerr << "Can't open remote file " << remotePath << ": " << ssh_get_error(session) << std::endl;
+
+        return SSH_ERROR;
+    }
+
+    // Write the data in chunks every server accepts
+    for (size_t offset = 0; offset < data.size(); offset += 32768) {
+        size_t nbytes = std::min((size_t)32768, data.size() - offset);
+
+        // Wait until the bandwidth limits allow the chunk
+        bandwidth.acquire(nbytes);
+
+        if (sftp_write(remoteFile, data.data() + offset, nbytes) != (ssize_t)nbytes) {
+            // Print the error message to stderr
+            std::cerr << "Can't write remote file " << remotePath << ": " << ssh_get_error(session) << std::endl;
+
+            sftp_close(remoteFile);
+            return SSH_ERROR;
+        }
+    }
+
+    // Close the remote file
+    sftp_close(remoteFile);
+
+    return SSH_OK;
+}
+
+int SSH::project_mkdirs(const char* project, std::list<std::string>* dirs) {
+    // Create the command for removing and recreating the current project folder inside the workspace
+    //std::string cmd = format("rm -rf sw_workspace && mkdir sw_workspace sw_workspace/{}", project);
+    // The manifest of the previous save is removed too, the project is incomplete until all files are saved
+    std::string cmd = std::format("mkdir -p {} && rm -rf {}/{}/* {}/{}/{} && mkdir -p {}/{}", workspace, workspace, project, workspace, project, SSH_MANIFEST_FILE, workspace, project);
+
+    // Iterate through all directories of the project
+    for (std::string dirPath : *dirs)
+        // Append the current directory to the mkdir command
+        cmd.append(std::format(" {}/{}", workspace, dirPath));
+
+    // Execute the command, return the return code
+    return execute_agent(cmd.c_str());
+}
+
+int SSH::project_save_file(sftp_session* sftp, std::string filePath, const std::string& remotePath, const char* path2project, size_t chunk_size, std::string* partPath, uint64_t* sentBytes, uint64_t* hash) {
+    // Create the local path of the file
+    std::string localPath = std::format("{}/{}", path2project, filePath);
+
+    // Map the local file into memory, so that it is sent directly from the page cache without copying it into a buffer first
+    MappedFile localFile;
+
+    // If the local file couldn't be opened or mapped
+    if (!localFile.open(localPath)) {
+        // Print an error message to stderr
+        std::cerr << "Can't open local file " << localPath << std::endl;
+
+        return SSH_ERROR;
+    }
+
+    // Open the remote file in write mode, if it doesn't exist yet create it, else truncate it
+    std::string openPath = remotePath;
+    int flags = O_WRONLY | O_CREAT | O_TRUNC;
+    uint64_t offset = 0;
+
+    // Large files are written into a part file named after the remote path instead, which survives a dropped connection.
+    // If a part already exists and matches the beginning of the local file, the upload continues at its end
+    partPath->clear();
+    if (resumeMinSize > 0 && localFile.size() >= (size_t)resumeMinSize) {
+        *partPath = std::format("{}/{}/{:016x}.part", shared_workspace(), SSH_PARTS_FOLDER, agent::hash64(remotePath.data(), remotePath.size()));
+        openPath = *partPath;
+
+        offset = part_verified_size(sftp, *partPath, localFile.data(), localFile.size());
+        if (offset > 0)
+            flags = O_WRONLY;
+    }
+
+    // give user read, write and execute permission
+    sftp_file remoteFile = sftp_open(*sftp, openPath.c_str(), flags, S_IRWXU);
+
+    // If the folder of the part files doesn't exist yet, create it and try again
+    if (remoteFile == nullptr && !partPath->empty() && sftp_get_error(*sftp) == SSH_FX_NO_SUCH_FILE) {
+        sftp_mkdir(*sftp, std::format("{}/{}", shared_workspace(), SSH_PARTS_FOLDER).c_str(), S_IRWXU);
+        remoteFile = sftp_open(*sftp, openPath.c_str(), flags, S_IRWXU);
+    }
+
+    // A read-only file (e.g., a hard link to the object store) is replaced instead of overwritten
+    if (remoteFile == nullptr && partPath->empty() && sftp_get_error(*sftp) == SSH_FX_PERMISSION_DENIED && sftp_unlink(*sftp, openPath.c_str()) == 0)
+        remoteFile = sftp_open(*sftp, openPath.c_str(), flags, S_IRWXU);
+
+    // If the remote file couldn't be opened or the end of the part couldn't be found
+    if (remoteFile == nullptr || (offset > 0 && sftp_seek64(remoteFile, offset) != 0)) {
+        // Print the error message to stderr
+        std::cerr << "Can't open remote file " << openPath << ": " << ssh_get_error(session) << std::endl;
+
+        if (remoteFile != nullptr)
+            sftp_close(remoteFile);
+
+        return SSH_ERROR;
+    }
+
+    // Write the mapped file in chunks of at most chunk_size Bytes, starting behind the verified part
+    for (size_t pos = offset; pos < localFile.size(); pos += chunk_size) {
+        // Get the number of Bytes of the current chunk
+        size_t nbytes = std::min(chunk_size, localFile.size() - pos);
+
+        // Wait until the bandwidth limits allow the chunk
+        bandwidth.acquire(nbytes);
+
+        // If the local file was truncated meanwhile (e.g., by an editor), its mapped end can't be read anymore
+        if (localFile.truncated()) {
+            // Print an error message to stderr, the next save sends the new content
+            std::cerr << "Local file " << localPath << " was changed while it was saved" << std::endl;
+
+            sftp_close(remoteFile);
+
+            return SSH_ERROR;
+        }
+
+        // Write the Bytes to the remote file, verify that all Bytes have been written
+        if (sftp_write(remoteFile, localFile.data() + pos, nbytes) != (ssize_t)nbytes) {
+            // Print the error message to stderr
+            std::cerr << ssh_get_error(session) << std::endl;
+
+            // Close the remote file, the local file is unmapped automatically
+            sftp_close(remoteFile);
+
+            return SSH_ERROR;
+        }
+
+        *sentBytes += nbytes;
+    }
+
+    // Hash the sent content for the verification, a truncated file is sent again since its hash is unknown
+    if (hash != nullptr && localFile.truncated())
+        *hash = 0;
+    else if (hash != nullptr)
+        *hash = agent::hash64(localFile.data(), localFile.size());
+
+    // Print the success to stdout
+    if (offset > 0)
+        std::cout << std::format("{} was saved successfully (resumed at {} of {} Bytes).", filePath, offset, localFile.size()) << std::endl;
+    else
+        std::cout << filePath << " was saved successfully." << std::endl;
+
+    // Close the remote file, the local file is unmapped automatically
+    sftp_close(remoteFile);
+
+    return SSH_OK;
+}
+
+uint64_t SSH::part_verified_size(sftp_session* sftp, const std::string& partPath, const char* data, uint64_t size) {
+    // Get the size of what arrived before, a missing part starts at the beginning
+    sftp_attributes attributes = sftp_stat(*sftp, partPath.c_str());
+    if (attributes == nullptr)
+        return 0;
+
+    uint64_t partSize = attributes->size;
+    sftp_attributes_free(attributes);
+
+    // An empty part or one longer than the local file (e.g., of an older version) is overwritten
+    if (partSize == 0 || partSize > size)
+        return 0;
+
+    // If the agent can be used, compare the hash of the whole part with the hash of the same number of local Bytes
+    if (use_agent()) {
+        std::string payload, response;
+        agent::put_u8(&payload, 0);
+        agent::put_u32(&payload, 1);
+        agent::put_string(&payload, partPath);
+        agent::put_u64(&payload, partSize);
+
+        size_t pos = 0;
+        uint32_t count;
+        uint8_t ok;
+        uint64_t remoteSize, remoteHash;
+        if (agent->request(AGENT_HASH, payload, &response) == SSH_OK && agent::get_u32(response, &pos, &count) && count == 1
+            && agent::get_u8(response, &pos, &ok) && agent::get_u64(response, &pos, &remoteSize) && agent::get_u64(response, &pos, &remoteHash))
+            return ok && remoteSize == partSize && remoteHash == agent::hash64(data, partSize) ? partSize : 0;
+    }
+
+    // Else the part can't be verified without reading it completely (e.g., it may belong to an older version with other Bytes at its beginning),
+    // it is overwritten and the file is sent completely
+    return 0;
+}
+
+int SSH::project_save_files(sftp_session* sftp, std::list<std::string>* files, const char* path2project, uint64_t* sentBytes, const std::unordered_map<std::string, std::string>* remotePaths) {
+    // Write with the maximum length per request the server supports (up to 256 KiB), or the minimum every server supports if it reports no limit
+    size_t chunk = 32768;
+    sftp_limits_t limits = sftp_limits(*sftp);
+    if (limits != nullptr) {
+        if (limits->max_write_length > 0)
+            chunk = (size_t)std::min(limits->max_write_length, (uint64_t)262144);
+        sftp_limits_free(limits);
+    }
+
+    // Part files which are renamed into place after all files were sent, and the remote paths of the files
+    std::map<std::string, std::string> renames;
+    uint64_t sent = 0;
+
+    // A sent file which is verified, its remote path (the part file if it has one) and the hash of the sent content
+    struct Sent {
+        std::string file, remotePath;
+        uint64_t hash;
+    };
+
+    // With the option verify, the agent hashes the sent files in batches while the next files are sent:
+    // the files of the next batch and the requested batches with their request IDs
+    bool verifying = verify && use_agent();
+    std::vector<Sent> batch;
+    std::vector<std::pair<uint32_t, std::vector<Sent>>> requests;
+
+    if (verify && !verifying)
+        std::cerr << "Can't verify the sent files without the agent." << std::endl;
+
+    // Requests the hashes of the files of the next batch, read back from the storage of the SSH client
+    auto request_hashes = [&]() {
+        if (batch.empty())
+            return true;
+
+        if (!use_agent())
+            return false;
+
+        std::string payload;
+        agent::put_u8(&payload, AGENT_HASH_SYNC);
+        agent::put_u32(&payload, (uint32_t)batch.size());
+        for (const Sent& file : batch) {
+            agent::put_string(&payload, file.remotePath);
+            agent::put_u64(&payload, UINT64_MAX);
+        }
+
+        uint32_t id = agent->send(AGENT_HASH, payload);
+        if (id == 0)
+            return false;
+
+        requests.emplace_back(id, std::move(batch));
+        batch.clear();
+        return true;
+    };
+
+    // Saves a file on the SSH client, if the connection drops it reconnects and tries again (a part file is resumed)
+    auto save_file = [&](const std::string& filePath) {
+        // Reconnection attempts for this file
+        long attempt = 0;
+
+        // The file is saved inside the workspace unless another remote path is given
+        std::string remotePath = remotePaths != nullptr ? remotePaths->at(filePath) : std::format("{}/{}", workspace, filePath);
+
+        std::string partPath;
+        uint64_t hash;
+        while (project_save_file(sftp, filePath, remotePath, path2project, chunk, &partPath, &sent, verifying ? &hash : nullptr) != SSH_OK) {
+            // Stop at the first error, unless the connection dropped
+            if (*sftp == nullptr || !connection_lost(sftp))
+                return false;
+
+            bool reconnected = false;
+            while (!reconnected && attempt < reconnects) {
+                std::cerr << std::format("Connection to {} lost, reconnecting ({} of {}) ...", addr, attempt + 1, reconnects) << std::endl;
+                reconnected = reconnect(sftp, attempt++) == SSH_OK;
+            }
+
+            if (!reconnected)
+                return false;
+
+            // The requests to the agent were lost with the connection, their files are requested again
+            for (auto& [id, files] : requests)
+                batch.insert(batch.end(), files.begin(), files.end());
+            requests.clear();
+        }
+
+        if (!partPath.empty())
+            renames[partPath] = remotePath;
+
+        // Request the hashes once a batch is complete
+        if (verifying) {
+            batch.push_back({ filePath, partPath.empty() ? remotePath : partPath, hash });
+            if (batch.size() >= SSH_VERIFY_BATCH)
+                return request_hashes();
+        }
+
+        return true;
+    };
+
+    // Files which are (re)sent in the current round and the number of files which were sent again
+    std::list<std::string> pending = *files;
+    size_t resent = 0;
+
+    for (int round = 0; ; round++) {
+        // Iterate through all file paths, stop at the first error
+        for (const std::string& filePath : pending)
+            if (!save_file(filePath))
+                return SSH_ERROR;
+
+        if (!verifying)
+            break;
+
+        // Request the hashes of the last batch, then compare all hashes, files with a wrong (or without) hash are sent again
+        if (!request_hashes())
+            return SSH_ERROR;
+
+        pending.clear();
+        for (auto& [id, sentFiles] : requests) {
+            std::string response;
+            size_t pos = 0;
+            uint32_t count;
+            if (agent->receive(id, &response) != SSH_OK || !agent::get_u32(response, &pos, &count) || count != sentFiles.size())
+                return SSH_ERROR;
+
+            for (const Sent& file : sentFiles) {
+                uint8_t ok;
+                uint64_t size, hash;
+                if (!agent::get_u8(response, &pos, &ok) || !agent::get_u64(response, &pos, &size) || !agent::get_u64(response, &pos, &hash))
+                    return SSH_ERROR;
+
+                if (!ok || hash != file.hash)
+                    pending.push_back(file.file);
+            }
+        }
+
+        requests.clear();
+
+        if (pending.empty())
+            break;
+
+        // Give up if the files are still wrong after SSH_VERIFY_ROUNDS attempts (e.g., a broken SD card)
+        for (const std::string& filePath : pending)
+            std::cerr << std::format("{} has a wrong hash on the SSH client{}", filePath, round < SSH_VERIFY_ROUNDS ? ", sending it again." : ".") << std::endl;
+
+        if (round >= SSH_VERIFY_ROUNDS)
+            return SSH_ERROR;
+
+        resent += pending.size();
+    }
+
+    if (sentBytes != nullptr)
+        *sentBytes += sent;
+
+    // Print the result of the verification
+    if (verifying)
+        std::cout << std::format("Verified {} file(s), {} sent again.", files->size(), resent) << std::endl;
+
+    if (renames.empty())
+        return SSH_OK;
+
+    // Rename the parts into place with one command, the old versions stay complete until then (rename is atomic).
+    // Parts which weren't resumed for a week (e.g., of deleted files) are removed
+    std::string cmd;
+    for (auto& [part, path] : renames)
+        cmd.append(std::format("mv -f {} {} && ", part, path));
+    cmd.append(std::format("find {}/{} -type f -mtime +7 -delete", shared_workspace(), SSH_PARTS_FOLDER));
+
+    return execute_agent(cmd.c_str());
+}
+
+int SSH::project_store_files(sftp_session* sftp, const Manifest& manifest, std::list<std::string>* files, const char* path2project, bool upload, uint64_t* sentBytes) {
+    std::string objectsDir = std::format("{}/{}", shared_workspace(), SSH_OBJECTS_FOLDER);
+
+    // Group the files by their object, named by hash and size, files with the same content share one object.
+    // Executable files get their own objects (suffix x), only they are executable through their links
+    std::map<std::string, std::vector<std::string>> objects;
+    std::unordered_map<std::string, uint64_t> sizes;
+    std::unordered_set<std::string> executables;
+    for (const std::string& path : *files) {
+        const ManifestEntry* file = manifest.find(path);
+        if (file == nullptr)
+            continue;
+
+        std::error_code ec;
+        bool executable = (std::filesystem::status(std::format("{}/{}", path2project, path), ec).permissions() & std::filesystem::perms::owner_exec) != std::filesystem::perms::none;
+
+        std::string name = std::format("{:016x}-{}{}", file->hash, file->size, executable ? "x" : "");
+        objects[name].push_back(path);
+        sizes[name] = file->size;
+        if (executable)
+            executables.insert(name);
+    }
+
+    if (objects.empty())
+        return SSH_OK;
+
+    // Ask which objects already exist on the SSH client, an object with another size is an incomplete upload
+    std::unordered_set<std::string> existing;
+    if (use_agent()) {
+        std::string payload, response;
+        agent::put_u32(&payload, (uint32_t)objects.size());
+        for (auto& [name, paths] : objects)
+            agent::put_string(&payload, std::format("{}/{}", objectsDir, name));
+
+        size_t pos = 0;
+        uint32_t count;
+        if (agent->request(AGENT_STAT, payload, &response) != SSH_OK || !agent::get_u32(response, &pos, &count) || count != objects.size())
+            return SSH_ERROR;
+
+        for (auto& [name, paths] : objects) {
+            agent::Stat stat;
+            if (!agent::get_stat(response, &pos, &stat))
+                return SSH_ERROR;
+
+            if (stat.type == AGENT_TYPE_FILE && stat.size == sizes[name])
+                existing.insert(name);
+        }
+    }
+    else {
+        // Without the agent, print the name and size of every existing object
+        std::string cmd = std::format("cd {} 2>/dev/null && stat -c '%n %s'", objectsDir);
+        for (auto& [name, paths] : objects)
+            cmd.append(" " + name);
+        cmd.append(" 2>/dev/null");
+
+        std::string out, err;
+        if (execute_capture(cmd.c_str(), &out, &err) != SSH_OK)
+            return SSH_ERROR;
+
+        std::istringstream lines(out);
+        std::string name;
+        uint64_t size;
+        while (lines >> name >> size)
+            if (sizes.count(name) && sizes[name] == size)
+                existing.insert(name);
+    }
+
+    // Upload one file of every missing object into the object store
+    std::list<std::string> missing;
+    std::unordered_map<std::string, std::string> remotePaths;
+    if (upload) {
+        for (auto& [name, paths] : objects) {
+            if (!existing.count(name)) {
+                missing.push_back(paths.front());
+                remotePaths[paths.front()] = std::format("{}/{}", objectsDir, name);
+            }
+        }
+
+        if (!missing.empty()) {
+            // Create the object store, it may already exist
+            sftp_mkdir(*sftp, objectsDir.c_str(), S_IRWXU);
+
+            int rc = project_save_files(sftp, &missing, path2project, sentBytes, &remotePaths);
+            if (rc != SSH_OK)
+                return rc;
+        }
+    }
+
+    // Replace the files by hard links to their objects, the objects become read-only (0444, or 0555 if executable) so that they can't be changed through a link
+    std::vector<std::tuple<std::string, std::string, uint32_t>> links;
+    for (auto& [name, paths] : objects)
+        if (upload || existing.count(name))
+            for (const std::string& path : paths)
+                links.emplace_back(std::format("{}/{}", objectsDir, name), std::format("{}/{}", workspace, path), executables.count(name) ? 0555 : 0444);
+
+    int rc = SSH_OK;
+    if (!links.empty()) {
+        if (use_agent()) {
+            std::string payload, response;
+            agent::put_u32(&payload, (uint32_t)links.size());
+            for (auto& [object, path, mode] : links) {
+                agent::put_string(&payload, object);
+                agent::put_string(&payload, path);
+                agent::put_u32(&payload, mode);
+            }
+
+            rc = agent->request(AGENT_LINK, payload, &response);
+
+            // Print the error message of the agent
+            std::string error;
+            size_t pos = 0;
+            if (rc == SSH_CMD_ERROR && agent::get_string(response, &pos, &error))
+                std::cerr << error << std::endl;
+        }
+        else {
+            // Without the agent, link every file under a temporary name and rename it over the file (unless it already is a link to the object)
+            std::string readOnly, executable;
+            for (auto& [name, paths] : objects)
+                if (upload || existing.count(name))
+                    (executables.count(name) ? executable : readOnly).append(std::format(" {}/{}", objectsDir, name));
+
+            std::string cmd = "true";
+            if (!readOnly.empty())
+                cmd.append(" && chmod 444" + readOnly);
+            if (!executable.empty())
+                cmd.append(" && chmod 555" + executable);
+
+            for (auto& [object, path, mode] : links)
+                cmd.append(std::format(" && {{ test {} -ef {} || {{ ln -f {} {}.pideploy-link && mv -f {}.pideploy-link {}; }}; }}", object, path, object, path, path, path));
+
+            rc = execute(cmd.c_str());
+        }
+    }
+
+    if (rc != SSH_OK)
+        return rc;
+
+    // The linked files don't have to be sent anymore
+    size_t linked = 0;
+    for (auto& [name, paths] : objects) {
+        if (upload || existing.count(name)) {
+            for (const std::string& path : paths)
+                files->remove(path);
+            linked += paths.size();
+        }
+    }
+
+    if (linked > 0)
+        std::cout << std::format("Linked {} file(s) to the object store, {} of {} object(s) uploaded.", linked, missing.size(), objects.size()) << std::endl;
+
+    // Remove objects which weren't linked by any project for a week (a link changes the ctime of the object)
+    if (upload)
+        rc = execute_agent(std::format("find {} -type f -links 1 -ctime +7 -delete", objectsDir).c_str());
+
+    return rc;
+}
+
+int SSH::project_patch_files(const Manifest& manifest, std::list<std::string>* files, const char* path2project, uint64_t* sentBytes) {
+    *sentBytes = 0;
+
+    // The checksums are computed and the files are rebuilt by the agent
+    if (deltaMinSize <= 0 || !use_agent())
+        return SSH_OK;
+
+    // A file which is sent as delta
+    struct Patch {
+        const ManifestEntry* file;
+        uint32_t blockSize;
+        uint32_t id = 0;
+        uint64_t literalBytes = 0, sentBytes = 0;
+    };
+
+    // Select the large files
+    std::vector<Patch> patches;
+    for (const std::string& path : *files) {
+        const ManifestEntry* file = manifest.find(path);
+        if (file != nullptr && file->size >= (uint64_t)deltaMinSize)
+            patches.push_back({ file, Delta::block_size(file->size) });
+    }
+
+    // Request the checksums of the old versions, at most DELTA_PIPELINE files ahead so that the unread responses stay small
+    size_t requested = 0;
+    auto request_sums = [&](size_t until) {
+        for (; requested < std::min(until, patches.size()); requested++) {
+            std::string payload;
+            agent::put_string(&payload, std::format("{}/{}", workspace, patches[requested].file->path));
+            agent::put_u32(&payload, patches[requested].blockSize);
+
+            patches[requested].id = agent->send(AGENT_BLOCKSUMS, payload);
+            if (patches[requested].id == 0)
+                return false;
+        }
+
+        return true;
+    };
+
+    for (size_t i = 0; i < patches.size(); i++) {
+        Patch& patch = patches[i];
+
+        // Request the next checksums, then wait for the ones of this file
+        if (!request_sums(i + DELTA_PIPELINE))
+            return SSH_ERROR;
+
+        std::string response;
+        int rc = agent->receive(patch.id, &response);
+        patch.id = 0;
+
+        if (rc == SSH_ERROR)
+            return SSH_ERROR;
+
+        // If the old version is missing (e.g., a new file) or unreadable, the file is sent completely
+        uint64_t baseSize;
+        std::vector<BlockSum> sums;
+        if (rc != SSH_OK || !Delta::parse_sums(response, &baseSize, &sums))
+            continue;
+
+        // Map the local file, send it completely if it changed since the manifest was built
+        std::string localPath = std::format("{}/{}", path2project, patch.file->path);
+        MappedFile localFile;
+        if (!localFile.open(localPath) || localFile.size() != patch.file->size || localFile.truncated())
+            continue;
+
+        // Create the operations which rebuild the file from the old blocks and the literal data
+        std::string ops;
+        uint32_t count = Delta::encode(localFile.data(), localFile.size(), patch.blockSize, baseSize, sums, &ops, &patch.literalBytes);
+
+        // Send the file completely if most of it changed (the delta would save little) or it doesn't fit into a single frame
+        if (patch.literalBytes > patch.file->size / 2 || ops.size() + 64 + patch.file->path.size() + workspace.size() > AGENT_MAX_FRAME)
+            continue;
+
+        std::string payload;
+        agent::put_string(&payload, std::format("{}/{}", workspace, patch.file->path));
+        agent::put_u32(&payload, patch.blockSize);
+        agent::put_u64(&payload, patch.file->size);
+        agent::put_u64(&payload, patch.file->hash);
+        agent::put_u32(&payload, count);
+        payload.append(ops);
+
+        // Send the delta, the agent verifies the result against the hash before it replaces the file
+        bandwidth.acquire(payload.size());
+        patch.id = agent->send(AGENT_PATCH, payload);
+        if (patch.id == 0)
+            return SSH_ERROR;
+
+        patch.sentBytes = payload.size();
+    }
+
+    // Wait for the results, the patched files don't have to be sent anymore
+    for (Patch& patch : patches) {
+        if (patch.id == 0)
+            continue;
+
+        std::string response;
+        int rc = agent->receive(patch.id, &response);
+        if (rc == SSH_ERROR)
+            return SSH_ERROR;
+
+        if (rc == SSH_OK) {
+            files->remove(patch.file->path);
+            *sentBytes += patch.sentBytes;
+
+            // Print the success to stdout
+            std::cout << std::format("{} was patched successfully ({} of {} Bytes changed).", patch.file->path, patch.literalBytes, patch.file->size) << std::endl;
+        }
+    }
+
+    return SSH_OK;
+}
+
+int SSH::save(const char* project, const char* path2project) {
+    // If path2project isn't specified
+    if (path2project == nullptr)
+        // Take the current directory
+        path2project = ".";
+
+    // Walk the project and hash its files in parallel, unchanged files take their hash from the cache
+    Manifest manifest;
+    if (manifest_build(&manifest, project, path2project) != SSH_OK)
+        return SSH_ERROR;
+
+    // Create two lists which save the paths of the directories and files from the project
+    std::list<std::string> dirs(manifest.dirs.begin(), manifest.dirs.end()), files;
+    for (const ManifestEntry& file : manifest.files)
+        files.push_back(file.path);
+
+    // Create all the directories on the SSH client, save the return code
+    int rc = project_mkdirs(project, &dirs);
+
+    // If there was an error creating the directories
+    if (rc != SSH_OK)
+        return rc;
+
+    // Create a new SFTP session
+    sftp_session sftp = sftp_start();
+    if (sftp == nullptr)
+        return SSH_ERROR;
+
+    // With the object store, link the files to their objects and only upload the missing ones, else save all files on the SSH client.
+    // Then save the manifest so that the next sync only transfers changed files
+    uint64_t sentBytes = 0;
+    if (objectStore)
+        rc = project_store_files(&sftp, manifest, &files, path2project, true, &sentBytes);
+    if (rc == SSH_OK)
+        rc = project_save_files(&sftp, &files, path2project, &sentBytes);
+    if (rc == SSH_OK)
+        rc = sftp_write_all(&sftp, std::format("{}/{}/{}", workspace, project, SSH_MANIFEST_FILE), manifest.serialize());
+
+    // Close and deallocate the SFTP session
+    sftp_free(sftp);
+
+    if (rc != SSH_OK)
+        return rc;
+
+    // Print what was saved and what was left out
+    std::cout << std::format("Saved {} file(s) ({} Bytes), ignored {} file(s) ({} Bytes) and {} folder(s).",
+        manifest.files.size(), manifest.total_size(), manifest.ignoredFiles, manifest.ignoredBytes, manifest.ignoredDirs) << std::endl;
+
+    return SSH_OK;
+}
+
+int SSH::sync(const char* project, const char* path2project) {
+    // If path2project isn't specified
+    if (path2project == nullptr)
+        // Take the current directory
+        path2project = ".";
+
+    // Measure the time of the whole sync
+    auto begin = std::chrono::steady_clock::now();
+
+    // Walk the project and hash its files in parallel, unchanged files take their hash from the cache
+    Manifest manifest;
+    if (manifest_build(&manifest, project, path2project) != SSH_OK)
+        return SSH_ERROR;
+
+    // Create a new SFTP session
+    sftp_session sftp = sftp_start();
+    if (sftp == nullptr)
+        return SSH_ERROR;
+
+    // Read the manifest of the last save or sync from the SSH client
+    std::string manifestPath = std::format("{}/{}/{}", workspace, project, SSH_MANIFEST_FILE);
+    std::string data;
+    int rc = sftp_read_all(&sftp, manifestPath, &data);
+
+    // If there was a connection error (a missing manifest is fine, then every file is transferred)
+    if (rc == SSH_ERROR) {
+        std::cerr << "Can't read remote file " << manifestPath << ": " << ssh_get_error(session) << std::endl;
+
+        sftp_free(sftp);
+        return SSH_ERROR;
+    }
+
+    // Files on the SSH client by their path, empty if the manifest is missing or invalid
+    std::unordered_map<std::string, ManifestEntry> remote;
+    int64_t remoteTime_ns;
+    bool known = rc == SSH_OK && Manifest::parse(data, &remote, &remoteTime_ns);
+    if (!known)
+        remote.clear();
+
+    // Compare the local and the remote files, the remaining remote files were removed locally
+    std::list<std::string> changed, removed;
+    uint64_t changedBytes = 0;
+    for (const ManifestEntry& file : manifest.files) {
+        auto it = remote.find(file.path);
+        if (it == remote.end() || it->second.hash != file.hash || it->second.size != file.size) {
+            changed.push_back(file.path);
+            changedBytes += file.size;
+        }
+
+        if (it != remote.end())
+            remote.erase(it);
+    }
+
+    for (auto& [path, entry] : remote)
+        removed.push_back(path);
+
+    // If nothing changed since the last save or sync
+    if (known && changed.empty() && removed.empty()) {
+        sftp_free(sftp);
+
+        std::cout << std::format("Project {} is up to date ({} file(s)).", project, manifest.files.size()) << std::endl;
+        return SSH_OK;
+    }
+
+    // Remove the old manifest first, so that an interrupted sync leads to a full comparison next time
+    sftp_unlink(sftp, manifestPath.c_str());
+
+    // Create the command which creates the folders (new ones may contain new files) and removes the deleted files
+    std::string cmd = std::format("mkdir -p {}/{}", workspace, project);
+    for (const std::string& dir : manifest.dirs)
+        cmd.append(std::format(" {}/{}", workspace, dir));
+
+    if (!removed.empty()) {
+        cmd.append(" && rm -f");
+        for (const std::string& path : removed)
+            cmd.append(std::format(" {}/{}", workspace, path));
+    }
+
+    // Execute the command, then send the large changed files as delta and the others completely, and save the new manifest.
+    // With the object store, the files whose objects exist are linked before and the remaining files are uploaded as objects
+    rc = execute_agent(cmd.c_str());
+
+    std::list<std::string> unpatched = changed;
+    uint64_t sentBytes = 0;
+    if (rc == SSH_OK && objectStore)
+        rc = project_store_files(&sftp, manifest, &unpatched, path2project, false, &sentBytes);
+    if (rc == SSH_OK)
+        rc = project_patch_files(manifest, &unpatched, path2project, &sentBytes);
+    if (rc == SSH_OK && objectStore)
+        rc = project_store_files(&sftp, manifest, &unpatched, path2project, true, &sentBytes);
+    if (rc == SSH_OK)
+        rc = project_save_files(&sftp, &unpatched, path2project, &sentBytes);
+    if (rc == SSH_OK)
+        rc = sftp_write_all(&sftp, manifestPath, manifest.serialize());
+
+    // Close and deallocate the SFTP session
+    sftp_free(sftp);
+
+    if (rc != SSH_OK)
+        return rc;
+
+    // Print what was transferred
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    std::cout << std::format("Synced {} changed file(s) ({} Bytes, {} Bytes sent), removed {} file(s), {} unchanged in {:.3f} s, ignored {} file(s) ({} Bytes) and {} folder(s).",
+        changed.size(), changedBytes, sentBytes, removed.size(), manifest.files.size() - changed.size(), seconds, manifest.ignoredFiles, manifest.ignoredBytes, manifest.ignoredDirs) << std::endl;
+
+    return SSH_OK;
+}
+
+int SSH::update(const char* project, const char* path2project, const char* args) {
+    // Measure the time of every step
+    auto begin = std::chrono::steady_clock::now();
+
+    // With releases, sync and build a copy of the active release while the application keeps running
+    std::string release;
+    if (keepReleases > 0) {
+        int rc = release_stage(project, &release);
+        if (rc != SSH_OK)
+            return rc;
+    }
+
+    // Transfer the changed files
+    int rc = sync(project, path2project);
+
+    auto synced = std::chrono::steady_clock::now();
+
+    // Build the project, make only rebuilds what depends on the changed files
+    if (rc == SSH_OK)
+        rc = compile(project);
+
+    // Switch back to the workspace, a release which couldn't be synced or built is removed and the active one keeps running
+    if (!release.empty())
+        release_finish(project, release, rc != SSH_OK);
+
+    if (rc != SSH_OK)
+        return rc;
+
+    auto built = std::chrono::steady_clock::now();
+
+    // Stop the application if it is running, then start it again (with releases in the new release)
+    rc = isAppRunning(project);
+    if (rc == SSH_APP_RUNNING)
+        rc = stop(project);
+    else if (rc == SSH_APP_NOT_RUNNING)
+        rc = SSH_OK;
+
+    if (rc == SSH_OK && !release.empty())
+        rc = release_activate(project, release, true);
+    if (rc == SSH_OK)
+        rc = start(project, args);
+    if (rc != SSH_OK)
+        return rc;
+
+    // Print the duration of the steps
+    auto ms = [](auto duration) { return std::chrono::duration<double, std::milli>(duration).count(); };
+    auto now = std::chrono::steady_clock::now();
+    std::cout << std::format("Updated in {:.0f} ms (sync {:.0f} ms, build {:.0f} ms, restart {:.0f} ms).",
+        ms(now - begin), ms(synced - begin), ms(built - synced), ms(now - built)) << std::endl;
+
+    if (!release.empty())
+        std::cout << std::format("Release {} of {} is active.", release, project) << std::endl;
+
+    return SSH_OK;
+}
+
+int SSH::release_stage(const char* project, std::string* release) {
+    // Name the release after the current time (UTC, with milliseconds) so that the names sort by age
+    auto now = std::chrono::system_clock::now();
+    time_t seconds = std::chrono::system_clock::to_time_t(now);
+    char name[32];
+    strftime(name, sizeof(name), "%Y%m%d-%H%M%S", std::gmtime(&seconds));
+    *release = std::format("{}.{:03}", name, std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() % 1000);
+    std::string dir = std::format("{}/{}/{}/{}", workspace, SSH_RELEASES_FOLDER, project, *release);
+
+    // Copy the active project (a release or a project saved without releases), so that only the changes are synced and make only rebuilds
+    // what depends on them. The state files of the running application stay in the active release
+    std::string cmd = std::format("mkdir -p {0}/{1} && {{ test ! -d {2}/{1} || cp -a {2}/{1}/. {0}/{1}/; }} && rm -f {0}/{1}/Debug/{3} {0}/{1}/Debug/{4} {0}/{1}/Debug/{5}",
+        dir, project, workspace, SSH_PID_FILE, SSH_EXIT_FILE, SSH_LAUNCH_FILE);
+
+    int rc = execute_agent(cmd.c_str());
+    if (rc != SSH_OK)
+        return rc;
+
+    // Let save, sync, and compile work inside the release, the part files and the object store stay in the workspace
+    liveWorkspace = workspace;
+    workspace = dir;
+
+    return SSH_OK;
+}
+
+void SSH::release_finish(const char* project, const std::string& release, bool failed) {
+    // Switch back to the workspace
+    workspace = liveWorkspace;
+    liveWorkspace.clear();
+
+    // Remove a release which failed, it was never active
+    if (failed && execute_agent(std::format("rm -rf {}/{}/{}/{}", workspace, SSH_RELEASES_FOLDER, project, release).c_str()) != SSH_OK)
+        std::cerr << std::format("Could not remove the failed release {} of {}.", release, project) << std::endl;
+}
+
+int SSH::release_activate(const char* project, const std::string& release, bool prune) {
+    // Path of the project inside the release, relative to the workspace so that the link stays valid if the workspace is moved
+    std::string target = std::format("{}/{}/{}/{}", SSH_RELEASES_FOLDER, project, release, project);
+
+    // Create the new link next to the project folder and rename it over the old one, so that the project folder is always complete.
+    // A folder of a project saved without releases can't be replaced by a rename, it is removed before
+    std::string cmd = std::format("test -d {0}/{1} && ln -sfn {1} {0}/{2}.pideploy-link && {{ test -L {0}/{2} || rm -rf {0}/{2}; }} && mv -Tf {0}/{2}.pideploy-link {0}/{2}",
+        workspace, target, project);
+
+    // Remove the oldest releases, the names sort by age and the activated release is the newest one
+    if (prune)
+        cmd.append(std::format(" && {{ ls -1 {0}/{1}/{2} | sort | head -n -{3} | sed 's|^|{0}/{1}/{2}/|' | xargs -r rm -rf; }}",
+            workspace, SSH_RELEASES_FOLDER, project, keepReleases));
+
+    int rc = execute_agent(cmd.c_str());
+    if (rc == SSH_CMD_ERROR)
+        std::cerr << std::format("Could not activate the release {} of {}.", release, project) << std::endl;
+
+    return rc;
+}
+
+int SSH::rollback(const char* project, const char* release, const char* args) {
+    // Read the active release and the names of all releases in one round trip
+    std::vector<BatchCommand> cmds(2);
+    cmds[0].cmd = std::format("readlink {}/{}", workspace, project);
+    cmds[1].cmd = std::format("ls -1 {}/{}/{}", workspace, SSH_RELEASES_FOLDER, project);
+
+    int rc = execute_batch(&cmds);
+    if (rc != SSH_OK)
+        return rc;
+
+    // The link points to <releases folder>/<project>/<release>/<project>
+    std::string active;
+    std::string prefix = std::format("{}/{}/", SSH_RELEASES_FOLDER, project);
+    if (cmds[0].out.starts_with(prefix))
+        active = cmds[0].out.substr(prefix.size(), cmds[0].out.find('/', prefix.size()) - prefix.size());
+
+    std::vector<std::string> releases;
+    std::istringstream lines(cmds[1].out);
+    for (std::string line; std::getline(lines, line); )
+        if (!line.empty())
+            releases.push_back(line);
+
+    std::sort(releases.begin(), releases.end());
+
+    // Without a name, take the newest release which is older than the active one
+    std::string target;
+    if (release != nullptr && *release != '\0' && strcmp(release, "previous") != 0) {
+        if (std::find(releases.begin(), releases.end(), release) != releases.end())
+            target = release;
+    }
+    else if (!active.empty()) {
+        auto it = std::lower_bound(releases.begin(), releases.end(), active);
+        if (it != releases.begin())
+            target = *std::prev(it);
+    }
+
+    if (target.empty()) {
+        // Print an error message to stderr
+        std::cerr << std::format("There is no {} release of {}.", release != nullptr && *release != '\0' ? release : "previous", project) << std::endl;
+
+        return SSH_CMD_ERROR;
+    }
+
+    if (target == active) {
+        std::cout << std::format("Release {} of {} is already active.", target, project) << std::endl;
+        return SSH_OK;
+    }
+
+    // Stop the application if it is running, switch the link, and start the application of the release again
+    rc = isAppRunning(project);
+    bool running = rc == SSH_APP_RUNNING;
+    if (running)
+        rc = stop(project);
+    else if (rc == SSH_APP_NOT_RUNNING)
+        rc = SSH_OK;
+
+    if (rc == SSH_OK)
+        rc = release_activate(project, target, false);
+    if (rc == SSH_OK && running)
+        rc = start(project, args);
+    if (rc != SSH_OK)
+        return rc;
+
+    std::cout << std::format("Rolled {} back from release {} to {}.", project, active.empty() ? "(none)" : active, target) << std::endl;
+
+    return SSH_OK;
+}
+
+int SSH::relay(const char* project, const char* path2project, const std::vector<std::string>& targets) {
+    // Sync the project to the seed first, only the changed files are sent by the host
+    int rc = sync(project, path2project);
+    if (rc != SSH_OK || targets.empty())
+        return rc;
+
+    // Choose the fan-out by the number of targets (about its square root) unless it is set: a small fan-out uses the uplink
+    // of a Raspberry Pi for fewer copies, a large one keeps the tree flat
+    long fanout = relayFanout;
+    if (fanout == 0)
+        fanout = std::clamp((long)ceil(sqrt((double)targets.size())), 1L, (long)SSH_RELAY_MAX_FANOUT);
+
+    // The nodes of the tree are numbered like a heap, the seed is node 0 and the children of node i are the nodes fanout * i + 1 to fanout * i + fanout
+    std::string nodes = port == 22 ? addr : std::format("{}:{}", addr, port);
+    for (const std::string& target : targets)
+        nodes.append(" " + target);
+
+    // Script which runs on every node, it doesn't contain single quotes because it is passed inside them.
+    // Arguments: role (seed or node), workspace, project, default user, fan-out, index of the node, identity of the project folder of the seed, addresses of all nodes.
+    // Input: the password, then the project (tar)
+    std::string script =
+        // Read the arguments and the password, which answers the password prompt of ssh through an askpass script.
+        // The identity of a project folder is the boot ID with its device and inode, a node with the same one shares the workspace of the seed
+        R"(r=$1 w=$2 p=$3 u=$4 d=$5 i=$6 I=$7; shift 7; t=("$@"); n=${#t[@]}; )" SSH_PI_ASKPASS R"(shopt -s nullglob; )"
+        R"~(id() { echo "$(cat /proc/sys/kernel/random/boot_id)$(stat -c :%d:%i $w/$p 2>/dev/null)"; }; [ $r = seed ] && I=$(id); )~"
+
+        // Start one ssh per child which runs this script there with the index of the child (as its user, else the default one), the child reads the project from a FIFO
+        R"(for ((c = d * i + 1; c <= d * i + d && c < n; c++)); do mkfifo $x/$c; a=${t[c]}; v=$u; [[ $a == *@* ]] && v=${a%%@*} a=${a#*@}; )"
+        R"(h=${a%:*}; o=22; [[ $a == *:* ]] && o=${a##*:}; )"
+        R"({ { echo "$P"; cat; } < $x/$c | )" SSH_PI_SSH R"( -p $o $v@$h "S=$(printf %q "$S"); export S; bash -c \"\$S\" relay node $w $p $u $d $c $I ${t[*]}"; } & done; )"
+
+        // The seed streams its copy of the project without the state of its last build and start to the children. With releases the project folder
+        // is a link to the project inside the active release, whose folder has the name of the project as well, so the resolved folder is archived.
+        // The other nodes copy their input to the children while extracting it into a temporary folder which replaces the project, then report their success.
+        // On a node with releases the project inside its active release is replaced and the link is kept, like save and sync write into the active release.
+        // A node which shares the workspace of the seed only forwards the project, replacing it would break the copy which the seed still reads
+        R"(if [ $r = seed ]; then tar -C $(dirname $(readlink -f $w/$p)) )" SSH_RELAY_EXCLUDE R"( -c $p | tee -p $x/[0-9]* > /dev/null; )"
+        R"~(elif [ "$(id)" = "$I" ]; then echo "${t[i]}: shares the workspace of the seed" >&2; tee -p $x/[0-9]* > /dev/null; )~"
+        R"(else mkdir -p $w && D=$w/$p && { [ ! -L $D ] || D=$(readlink -f $D); } && y=$(mktemp -d $(dirname $D)/.$p.relay.XXXXXX) && )"
+        R"(tee -p $x/[0-9]* | tar -x -C $y && rm -rf $D && mv $y/$p $D && echo "relay OK ${t[i]}"; )"
+        R"(rm -rf "$y"; fi; )"
+
+        // Wait until the children (and their subtrees) are finished
+        R"(wait)";
+
+    std::string cmd = std::format("S='{}'; export S; bash -c \"$S\" relay seed {} {} {} {} 0 - {}", script, workspace, project, user, fanout, nodes);
+
+    // Run the script on the seed, the password is sent through stdin so that it doesn't appear in any command line
+    std::string input = passwd + "\n", out, err;
+    if (execute_capture(cmd.c_str(), &out, &err, &input) != SSH_OK)
+        return SSH_ERROR;
+
+    // Print the errors of the nodes (e.g., a failed login)
+    write_to_stderr(err.data(), err.length());
+
+    // Every node which received the project reported it, a node without report failed (and so did its subtree)
+    std::unordered_set<std::string> received = reported_targets(out, "relay OK ");
+
+    size_t failed = 0;
+    for (const std::string& target : targets) {
+        if (received.count(target))
+            std::cout << std::format("{} was relayed to {}.", project, target) << std::endl;
+        else {
+            std::cerr << std::format("{} couldn't be relayed to {}.", project, target) << std::endl;
+            failed++;
+        }
+    }
+
+    std::cout << std::format("Relayed {} to {} of {} target(s) with a fan-out of {}.", project, targets.size() - failed, targets.size(), fanout) << std::endl;
+
+    return failed == 0 ? SSH_OK : SSH_CMD_ERROR;
+}
+
+int SSH::fingerprint(const char* project) {
+    // Print the fingerprint details and their hash, then the hash of the sources of the project
+    std::string cmd = std::format("d=$({}); echo \"$d\"; echo \"Fingerprint: $(echo \"$d\" | md5sum | cut -c1-32)\"; "
+        "echo \"Sources: $(cd {}/{} 2>/dev/null && {})\"", SSH_FINGERPRINT, workspace, project, SSH_SOURCE_HASH);
+
+    return execute(cmd.c_str()) == SSH_ERROR ? SSH_ERROR : SSH_OK;
+}
+
+int SSH::share(const char* project, const std::vector<std::string>& targets) {
+    // Script which runs on the SSH client and on every target, it doesn't contain single quotes because it is passed inside them.
+    // Arguments: role (share or node), workspace, project, user, then the addresses of the targets resp. the fingerprint, source hash, and address of the node.
+    // Input: the password resp. the binary, the build hash, and the build log (tar)
+    std::string script =
+        // Read the arguments, define the functions which print the fingerprint and the hash of the sources
+        R"~(r=$1 w=$2 p=$3 u=$4; shift 4; f() { { )~" SSH_FINGERPRINT R"~(; } | md5sum | cut -c1-32; }; s() { )~" SSH_SOURCE_HASH R"~(; }; )~"
+
+        // A target only accepts the binary if it has the same fingerprint and sources, the build hash is replaced last so that an interrupted copy is built again
+        R"~(if [ $r = node ]; then F=$1 H=$2 a=$3; cd $w/$p 2>/dev/null || { echo "$a: $p is not saved" >&2; exit 1; }; )~"
+        R"~([ "$(f)" = $F ] || { echo "$a: different fingerprint" >&2; exit 1; }; [ "$(s)" = $H ] || { echo "$a: different sources" >&2; exit 1; }; )~"
+        R"~(mkdir -p Debug && rm -f Debug/)~" SSH_BUILD_FILE R"~( && y=$(mktemp -d Debug/.share.XXXXXX) && trap "rm -rf $y" EXIT && tar -x -C $y )~"
+        R"~(&& mv -f $y/$p $y/)~" SSH_BUILD_LOG R"~( Debug/ && mv -f $y/)~" SSH_BUILD_FILE R"~( Debug/ && > Debug/output.txt && echo "share OK $a"; exit; fi; )~"
+
+        // The binary is only shared if it was built from the current sources
+        SSH_PI_ASKPASS R"~(F=$(f); cd $w/$p || exit 1; H=$(s); [ -n "$H" ] && [ -f Debug/$p ] && [ "$H" = "$(cat Debug/)~" SSH_BUILD_FILE R"~( 2>/dev/null)" ] )~"
+        R"~(|| { echo "$p is not built from its current sources" >&2; exit 1; }; )~"
+
+        // Stream the binary to all targets at once, each runs this script as node
+        R"~(for a in "$@"; do h=${a%:*}; o=22; [[ $a == *:* ]] && o=${a##*:}; tar -C Debug -c $p )~" SSH_BUILD_LOG " " SSH_BUILD_FILE R"~( | )~"
+        SSH_PI_SSH R"~( -p $o $u@$h "S=$(printf %q "$S"); export S; bash -c \"\$S\" share node $w $p $u $F $H $a" & done; wait)~";
+
+    std::string cmd = std::format("S='{}'; export S; bash -c \"$S\" share share {} {} {}", script, workspace, project, user);
+    for (const std::string& target : targets)
+        cmd.append(" " + target);
+
+    // Run the script, the password is sent through stdin so that it doesn't appear in any command line
+    std::string input = passwd + "\n", out, err;
+    if (execute_capture(cmd.c_str(), &out, &err, &input) != SSH_OK)
+        return SSH_ERROR;
+
+    // Print the errors of the targets (e.g., a different fingerprint)
+    write_to_stderr(err.data(), err.length());
+
+    // Every target which installed the binary reported it
+    std::unordered_set<std::string> received = reported_targets(out, "share OK ");
+
+    size_t failed = 0;
+    for (const std::string& target : targets) {
+        if (received.count(target))
+            std::cout << std::format("The binary of {} was copied to {}.", project, target) << std::endl;
+        else {
+            std::cerr << std::format("The binary of {} couldn't be copied to {}.", project, target) << std::endl;
+            failed++;
+        }
+    }
+
+    std::cout << std::format("Copied the binary of {} to {} of {} target(s).", project, targets.size() - failed, targets.size()) << std::endl;
+
+    return failed == 0 ? SSH_OK : SSH_CMD_ERROR;
+}
+
+int SSH::collect_file(sftp_session* sftp, const std::string& remotePath, const std::string& localPath, uint64_t* nbytes) {
+    // Open the remote file in read mode
+    sftp_file remoteFile = sftp_open(*sftp, remotePath.c_str(), O_RDONLY, 0);
+
+    // If the remote file couldn't be opened
+    if (remoteFile == nullptr) {
         // Print the error message to stderr
-        std::cerr << "Error allocating SFTP session: " << ssh_get_error(session) << std::endl;
+        std::cerr << "Can't open remote file " << remotePath << ": " << ssh_get_error(session) << std::endl;
 
         return SSH_ERROR;
     }
 
-    // Initialize the SFTP protocol with the server
-    if (sftp_init(sftp) != SSH_OK) {
-        // Print an error message together with the error code
-        std::cerr << "Error initializing SFTP session: code " << sftp_get_error(sftp) << std::endl;
+    // Get the size of the file, only this many Bytes are read (the file may still grow)
+    sftp_attributes attributes = sftp_fstat(remoteFile);
+    uint64_t size = attributes != nullptr ? attributes->size : 0;
+    sftp_attributes_free(attributes);
 
-        // Close and deallocate the SFTP session
-        sftp_free(sftp);
+    // Open the local file in binary mode, truncate it if it exists
+    std::ofstream localFile(localPath, std::ofstream::binary | std::ofstream::trunc);
+
+    // If the local file couldn't be opened
+    if (!localFile.is_open()) {
+        // Print an error message to stderr
+        std::cerr << "Can't open local file " << localPath << std::endl;
 
+        sftp_close(remoteFile);
         return SSH_ERROR;
     }
 
-    // Save the return code from the upcoming function calls
-    // Initialize with SSH_OK in case there are no files to be saved
+    // Read with the maximum length per request the server supports (up to 256 KiB), or the minimum every server supports if it reports no limit
+    size_t chunk = 32768;
+    sftp_limits_t limits = sftp_limits(*sftp);
+    if (limits != nullptr) {
+        if (limits->max_read_length > 0)
+            chunk = (size_t)std::min(limits->max_read_length, (uint64_t)262144);
+        sftp_limits_free(limits);
+    }
+
+    // Keep up to 16 read requests in flight, so that the round trip time is only waited once instead of per request
+    const size_t depth = 16;
+    std::deque<sftp_aio> inflight;
+    uint64_t requested = 0;
+
+    // Buffer for the Bytes of one request
+    std::vector<char> buffer(chunk);
+
     int rc = SSH_OK;
+    while (rc == SSH_OK && (requested < size || !inflight.empty())) {
+        // Send read requests until the file is requested completely or enough are in flight
+        while (requested < size && inflight.size() < depth) {
+            sftp_aio aio;
+            size_t len = (size_t)std::min((uint64_t)chunk, size - requested);
 
-    // Iterate through all file paths
-    for (std::string filePath : *files) {
-        // Save the file on the SSH client, and save the return code
-        rc = project_save_file(&sftp, filePath, path2project);
+            // Wait until the bandwidth limits allow the chunk
+            bandwidth.acquire(len);
 
-        // If there was an error saving the last file
-        if (rc != SSH_OK)
+            if (sftp_aio_begin_read(remoteFile, len, &aio) < 0) {
+                // Print the error message to stderr
+                std::cerr << "Error reading remote file " << remotePath << ": " << ssh_get_error(session) << std::endl;
+
+                rc = SSH_ERROR;
+                break;
+            }
+
+            inflight.push_back(aio);
+            requested += len;
+        }
+
+        // If no request is in flight (e.g., the first one failed)
+        if (inflight.empty())
+            break;
+
+        // Wait for the oldest request, the responses arrive in order
+        sftp_aio aio = inflight.front();
+        inflight.pop_front();
+        ssize_t nread = sftp_aio_wait_read(&aio, buffer.data(), buffer.size());
+
+        // If there was an error reading the remote file
+        if (nread < 0) {
+            // Print the error message to stderr
+            std::cerr << "Error reading remote file " << remotePath << ": " << ssh_get_error(session) << std::endl;
+
+            rc = SSH_ERROR;
             break;
+        }
+
+        // If the file was truncated meanwhile, there is nothing more to read
+        if (nread == 0)
+            size = requested;
+
+        // Write the Bytes to the local file
+        localFile.write(buffer.data(), nread);
+        *nbytes += nread;
+
+        // If there was an error writing the local file
+        if (localFile.bad()) {
+            // Print an error message to stderr
+            std::cerr << "Error writing local file " << localPath << std::endl;
+
+            rc = SSH_ERROR;
+        }
+    }
+
+    // Free the requests which are still in flight after an error
+    for (sftp_aio aio : inflight)
+        sftp_aio_free(aio);
+
+    // Close the local and remote file
+    localFile.close();
+    sftp_close(remoteFile);
+
+    return rc;
+}
+
+int SSH::collect_path(sftp_session* sftp, const std::string& remotePath, const std::string& localPath, size_t* nfiles, uint64_t* nbytes) {
+    // Get the type of the remote path
+    sftp_attributes attributes = sftp_stat(*sftp, remotePath.c_str());
+
+    // If the remote path doesn't exist
+    if (attributes == nullptr) {
+        // Print the error message to stderr
+        std::cerr << "Can't find remote path " << remotePath << ": " << ssh_get_error(session) << std::endl;
+
+        return SSH_ERROR;
+    }
+
+    bool isDir = attributes->type == SSH_FILEXFER_TYPE_DIRECTORY;
+    sftp_attributes_free(attributes);
+
+    // If it's a file
+    if (!isDir) {
+        // Create the local folders of the file
+        std::error_code error;
+        std::filesystem::create_directories(std::filesystem::path(localPath).parent_path(), error);
+
+        // Download the file, save the return code
+        int rc = collect_file(sftp, remotePath, localPath, nbytes);
+
+        // If the file was downloaded successfully
+        if (rc == SSH_OK) {
+            // Count it and print the success to stdout
+            (*nfiles)++;
+            std::cout << remotePath << " was collected successfully." << std::endl;
+        }
+
+        return rc;
+    }
+
+    // Else create the local folder
+    std::error_code error;
+    std::filesystem::create_directories(localPath, error);
+
+    // Open the remote folder
+    sftp_dir dir = sftp_opendir(*sftp, remotePath.c_str());
+
+    // If the remote folder couldn't be opened
+    if (dir == nullptr) {
+        // Print the error message to stderr
+        std::cerr << "Can't open remote folder " << remotePath << ": " << ssh_get_error(session) << std::endl;
+
+        return SSH_ERROR;
+    }
+
+    // Download all entries of the folder, but continue with the other ones after an error
+    int rc = SSH_OK;
+    while ((attributes = sftp_readdir(*sftp, dir)) != nullptr) {
+        std::string name = attributes->name;
+        sftp_attributes_free(attributes);
+
+        // Skip the current and parent folder
+        if (name == "." || name == "..")
+            continue;
+
+        if (collect_path(sftp, std::format("{}/{}", remotePath, name), std::format("{}/{}", localPath, name), nfiles, nbytes) != SSH_OK)
+            rc = SSH_ERROR;
     }
 
+    // Close the remote folder
+    sftp_closedir(dir);
+
+    return rc;
+}
+
+int SSH::collect(const char* project, const char* localDir) {
+    // If localDir isn't specified
+    std::string local = localDir != nullptr ? localDir : std::format("results/{}", addr);
+
+    // Create a new SFTP session
+    sftp_session sftp = sftp_start();
+    if (sftp == nullptr)
+        return SSH_ERROR;
+
+    // Count the downloaded files and Bytes, and measure the time
+    size_t nfiles = 0;
+    uint64_t nbytes = 0;
+    auto begin = std::chrono::steady_clock::now();
+
+    // Download every result, but continue with the other ones after an error
+    int rc = SSH_OK;
+    for (const std::string& result : results)
+        if (collect_path(&sftp, std::format("{}/{}/{}", workspace, project, result), std::format("{}/{}", local, result), &nfiles, &nbytes) != SSH_OK)
+            rc = SSH_ERROR;
+
     // Close and deallocate the SFTP session
     sftp_free(sftp);
 
+    // Print the transferred Bytes and the throughput
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << std::format("Collected {} file(s), {} Bytes in {:.3f} s ({:.2f} MiB/s) into {}.",
+        nfiles, nbytes, seconds, seconds > 0 ? nbytes / seconds / (1024 * 1024) : 0.0, local) << std::endl;
+
     return rc;
 }
 
-int SSH::save(const char* project, const char* path2project) {
+int SSH::pipeline(const char* project, const char* path2project, const std::vector<std::string>& stages) {
     // If path2project isn't specified
     if (path2project == nullptr)
         // Take the current directory
         path2project = ".";
 
-    // Create two lists which save the paths of the directories and files from the project
-    std::list<std::string> dirs, files;
+    // Read the stages from the configuration file of the local project
+    Pipeline pipeline;
+    if (!pipeline.load(std::format("{}/{}/{}", path2project, project, PIPELINE_CONFIG_FILE)))
+        return SSH_ERROR;
 
-    // Get the paths of all directories and paths from the project and store them in the respective lists
-    // Save the return code
-    int rc = get_project_dirs_and_files(project, path2project, &dirs, &files);
+    if (pipeline.stages.empty()) {
+        std::cerr << std::format("The project {} has no pipeline, its stages are defined with {}<name>=<command> inside {}.",
+            project, PIPELINE_STAGE_PREFIX, PIPELINE_CONFIG_FILE) << std::endl;
+        return SSH_ERROR;
+    }
 
-    // If there was an error retrieving the paths
-    if (rc != SSH_OK)
-        return rc;
+    // The connected Raspberry Pi and the further ones, each only once
+    std::vector<std::string> pis = { port == 22 ? addr : std::format("{}:{}", addr, port) };
+    for (const std::string& pi : pipelinePis)
+        if (std::find(pis.begin(), pis.end(), pi) == pis.end())
+            pis.push_back(pi);
 
-    // Create all the directories on the SSH client, save the return code
-    rc = project_mkdirs(project, &dirs);
+    // Create the tasks of the requested stages
+    if (!pipeline.plan(stages, pis))
+        return SSH_ERROR;
 
-    // If there was an error creating the directories
-    if (rc != SSH_OK)
-        return rc;
+    // Connections which no running task uses, by Raspberry Pi. This connection is used for the first Raspberry Pi,
+    // a task which finds no idle connection opens another one, so that tasks on the same Raspberry Pi can run in parallel
+    std::mutex poolMutex;
+    std::map<std::string, std::vector<SSH*>> idle = { { pis[0], { this } } };
+    std::vector<std::unique_ptr<SSH>> connections;
+
+    auto acquire = [&](const std::string& pi) -> SSH* {
+        {
+            std::lock_guard<std::mutex> guard(poolMutex);
+            if (!idle[pi].empty()) {
+                SSH* ssh = idle[pi].back();
+                idle[pi].pop_back();
+                return ssh;
+            }
+        }
+
+        // Split an optional port from the address
+        std::string host = pi;
+        unsigned int piPort = 22;
+        size_t colon = host.rfind(':');
+        if (colon != std::string::npos && host.find(':') == colon) {
+            piPort = (unsigned int)atoi(host.c_str() + colon + 1);
+            host.erase(colon);
+        }
+
+        // Connect with the same credentials and options as this connection, an abort of this connection aborts it as well
+        auto ssh = std::make_unique<SSH>();
+        ssh->parent = this;
+        for (const auto& [key, value] : optionValues)
+            ssh->setOption(key.c_str(), value.c_str());
+
+        if (ssh->connect(host.c_str(), piPort, user.c_str(), passwd.c_str(), timeout) != SSH_OK)
+            return nullptr;
+
+        std::lock_guard<std::mutex> guard(poolMutex);
+        connections.push_back(std::move(ssh));
+        return connections.back().get();
+    };
+
+    // Runs a task on the host or on its Raspberry Pi, the built-in operations print their output themselves
+    auto execute = [&](PipelineTask* task, const PipelineStage& stage) {
+        // After an abort no further task starts, it fails so that the tasks after it are skipped
+        if (abort_requested()) {
+            task->output = "Aborted.";
+            return false;
+        }
+
+        if (stage.target == StageTarget::host) {
+            // Run the command inside the local project folder
+            FILE* pipe = popen(std::format(SSH_HOST_STAGE, (std::filesystem::path(path2project) / project).string(), stage.command).c_str(), "r");
+            if (pipe == nullptr) {
+                task->output = "Can't run the command.";
+                return false;
+            }
+
+            // Read the whole output, the exit code of the command decides
+            char buffer[4096];
+            for (size_t nbytes; (nbytes = fread(buffer, 1, sizeof(buffer), pipe)) > 0; )
+                task->output.append(buffer, nbytes);
+
+            return pclose(pipe) == 0;
+        }
+
+        SSH* ssh = acquire(task->addr);
+        if (ssh == nullptr) {
+            task->output = std::format("Can't connect to {}.", task->addr);
+            return false;
+        }
+
+        int rc;
+        if (stage.command == "@sync")
+            rc = ssh->sync(project, path2project);
+        else if (stage.command == "@compile")
+            rc = ssh->compile(project);
+        else if (stage.command == "@collect")
+            rc = ssh->collect(project);
+        else {
+            // Run the command inside the project folder and print its exit code after its output, so that it can be told from the output
+            std::string out, err;
+            rc = ssh->execute_capture(std::format("cd {}/{} 2>&1 && ({}) 2>&1; printf \"\\n{}%d\\n\" $?", ssh->workspace, project, stage.command, SSH_STAGE_EXIT).c_str(), &out, &err);
+
+            size_t exit = out.rfind("\n" SSH_STAGE_EXIT);
+            if (rc == SSH_OK && exit != std::string::npos) {
+                task->output = out.substr(0, exit) + err;
+                rc = atoi(out.c_str() + exit + 1 + strlen(SSH_STAGE_EXIT)) == 0 ? SSH_OK : SSH_CMD_ERROR;
+            }
+            else
+                rc = SSH_ERROR;
+        }
+
+        // After a connection error, the connection isn't used for further tasks
+        if (rc != SSH_ERROR) {
+            std::lock_guard<std::mutex> guard(poolMutex);
+            idle[task->addr].push_back(ssh);
+        }
+
+        return rc == SSH_OK;
+    };
+
+    // Hashes the local project for the stages with inputs
+    auto scan = [&](Manifest* manifest) {
+        return manifest_build(manifest, project, path2project) == SSH_OK;
+    };
+
+    // Run the pipeline, the keys of the succeeded stages are saved next to the project like the cache of the manifest.
+    // Meanwhile an abort is handled by the tasks, run returns after all of them have finished
+    pipelineRunning = true;
+    bool success = pipeline.run(std::format("{}/.{}.pipeline", path2project, project), rebuild, scan, execute);
+    pipelineRunning = false;
+
+    std::cout << pipeline.report() << std::endl;
+
+    if (abortRequested) {
+        std::cerr << "Pipeline aborted." << std::endl;
+
+        return SSH_CMD_ERROR;
+    }
+
+    return success ? SSH_OK : SSH_CMD_ERROR;
+}
+
+int SSH::manifest(const char* project, const char* path2project) {
+    // If path2project isn't specified
+    if (path2project == nullptr)
+        // Take the current directory
+        path2project = ".";
+
+    // Measure the time to walk and hash the project
+    auto begin = std::chrono::steady_clock::now();
+
+    // Walk the project and hash all files in parallel
+    Manifest manifest;
+    if (manifest_build(&manifest, project, path2project) != SSH_OK)
+        return SSH_ERROR;
 
-    // Save all files on the SSH client, return the return code
-    return project_save_files(&files, path2project);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    // Print every file with its hash and size
+    for (const ManifestEntry& file : manifest.files)
+        std::cout << std::format("{:016x} {:>12} {}", file.hash, file.size, file.path) << std::endl;
+
+    // Print the hash of the whole project and the throughput
+    uint64_t nbytes = manifest.total_size();
+    std::cout << std::format("Project hash {:016x}, hashed {} file(s) ({} unchanged from the cache), {} Bytes in {:.3f} s ({:.1f} MiB/s) with {} thread(s).",
+        manifest.project_hash(), manifest.files.size(), manifest.cached, nbytes, seconds, seconds > 0 ? nbytes / seconds / 1048576 : 0.0, Manifest::thread_count(0)) << std::endl;
+    std::cout << std::format("Ignored {} file(s) ({} Bytes) and {} folder(s).", manifest.ignoredFiles, manifest.ignoredBytes, manifest.ignoredDirs) << std::endl;
+
+    return SSH_OK;
 }
 
 int SSH::compile(const char* project) {
+    // Command part which copies the built binary to the persistent workspace, only used with a volatile (e.g., RAM) workspace
+    std::string persist = "";
+
+    // If the binary should be persisted and the project is built outside the persistent workspace
+    if (persistBinary && is_volatile_workspace())
+        // Copy the binary into the Debug folder of the project inside the persistent workspace, a failed copy isn't a build error
+        persist = std::format(" && {{ mkdir -p ~/{}/{}/Debug && cp Debug/{} ~/{}/{}/Debug/ || >&2 echo Could not persist the binary; }}",
+            SSH_WORKSPACE, project, project, SSH_WORKSPACE, project);
+
+    // First line of the output if the build is skipped because the sources haven't changed since the last successful build
+    std::string upToDate = std::format("Build of {} is up to date.", project);
+
+    // Command which runs make, the script which distributes it to the helpers resp. asks the cache is defined before the command
+    std::string make = "make -s", distribute = "";
+
+    // With the option cache, the SSH client forwards a port to the cache on the host, the build continues without cache if this fails
+    int cachePort = 0;
+    if (!cacheFolder.empty()) {
+        if (!buildCache.open(cacheFolder, (uint64_t)cacheSize * 1024 * 1024))
+            std::cout << "Can't open the compiler cache " << cacheFolder << ", building without it." << std::endl;
+        else if (ssh_channel_listen_forward(session, "localhost", 0, &cachePort) != SSH_OK) {
+            std::cout << "The SSH client doesn't forward a port to the compiler cache (AllowTcpForwarding), building without it." << std::endl;
+            cachePort = 0;
+        }
+    }
+
+    // If the compile jobs should be distributed to other Raspberry Pis or use the cache
+    if (!helpers.empty() || cachePort != 0) {
+        // Script which runs on the SSH client (role build), on the helpers (role probe), and as compiler (role cc), it doesn't contain single quotes
+        // because it is passed inside them. The role is $0, build gets the user, the port of the cache (0 without), the workspace, and the addresses of the helpers.
+        // Input of build: the password and the token of the cache
+        std::string script =
+            // Define the function which prints the fingerprint, a helper prints how many CPUs it has left (CPUs minus load) and its fingerprint.
+            // A helper whose application is running (checked like app_running_condition: no exit file, and the PID of the PID file belongs to a process
+            // with the saved start time, in its workspaces or releases, $1 is the workspace of the build) has none left, so that the compile jobs don't disturb a measurement
+            R"~(r=$0; f() { { )~" SSH_FINGERPRINT R"~(; } | md5sum | cut -c1-32; }; )~"
+            R"~(if [ $r = probe ]; then k=$(( $(nproc) - $(cut -d. -f1 /proc/loadavg) )); for W in "$1" )~" SSH_WORKSPACE " " SSH_RAM_WORKSPACE R"~(; do )~"
+            R"~(for p in $W/*/Debug/)~" SSH_PID_FILE " $W/" SSH_RELEASES_FOLDER "/*/*/*/Debug/" SSH_PID_FILE R"~(; do read -r i s g < "$p" 2> /dev/null && )~"
+            R"~([ ! -f "${p%/*}/)~" SSH_EXIT_FILE R"~(" ] && read -r t < /proc/$i/stat 2> /dev/null && t=${t##*) } && set -- $t && [ "${20}" = "$s" ] && k=0; done; done; echo "$k $(f)"; exit; fi; )~"
+
+            // The compiler removes its folder from PATH to find the real compiler, and sorts out the arguments: B for preprocessing, R for compiling
+            R"~(if [ $r = cc ]; then n=${1##*/}; shift; export PATH=${PATH#$DCC/bin:}; x=$DCC; A=("$@"); c=0 z=0 m=0 mf=0 mt=0 s= o=; B=(); R=(); )~"
+            R"~(while [ $# -gt 0 ]; do case $1 in -c) c=1;; -o) o=$2; shift;; -E|-S|-x|-) z=1;; -MD|-MMD) m=1; B+=("$1");; )~"
+            R"~(-MF) mf=1; B+=("$1" "$2"); shift;; -MT|-MQ) mt=1; B+=("$1" "$2"); shift;; -M*|-I?*|-D?*|-U?*) B+=("$1");; )~"
+            R"~(-I|-D|-U|-include|-imacros|-isystem|-iquote|-idirafter) B+=("$1" "$2"); shift;; )~"
+            R"~(*.c|*.cc|*.cpp|*.cxx|*.c++|*.C) [ -z "$s" ] && s=$1 || z=1;; *) B+=("$1"); R+=("$1");; esac; shift; done; )~"
+
+            // Only the compilation of a single source into an object file is distributed, everything else (e.g., linking) runs locally
+            R"~([ $c = 1 ] && [ -n "$s" ] && [ -n "$o" ] && [ $z = 0 ] || exec $n "${A[@]}"; t=$(date +%s%N); l=c++-cpp-output; [[ $s == *.c ]] && l=cpp-output; )~"
+            R"~([ $m = 1 ] && [ $mf = 0 ] && B+=(-MF "${o%.*}.d"); [ $m = 1 ] && [ $mt = 0 ] && B+=(-MT "$o"); q=; [ ${#R[@]} -gt 0 ] && q=$(printf "%q " "${R[@]}"); )~"
+
+            // Wait for a free slot of the Raspberry Pi (a helper or the local one) with the most free slots, a slot is a folder so that taking it is atomic
+            R"~(g() { while read -r a po h k; do echo "$((k - $(ls -d "$x/slot/$a#"* 2> /dev/null | wc -l))) $a $po $h $k"; done < $x/hosts | sort -nr | )~"
+            R"~(while read -r e a po h k; do [ $e -gt 0 ] || break; for ((j = 1; j <= k; j++)); do mkdir "$x/slot/$a#$j" 2> /dev/null && { echo "$a $po $h $x/slot/$a#$j"; exit; }; done; done; }; )~"
+            R"~(until v=$(g); [ -n "$v" ]; do sleep 0.05; done; read -r a po h d <<< "$v"; e=1; i=$x/$$.i; k=; )~"
+
+            // With the cache, the key is the hash of the fingerprint, the compiler and its flags, and the preprocessed source. The cache on the host
+            // is reached through the forwarded port and answers a hit with the size and the object file
+            R"~(if [ $DCC_CACHE != 0 ] && $n "${B[@]}" -E "$s" -o $i 2> $i.err && ! [ -s $i.err ]; then k=$({ echo "$DCC_F $n $q"; cat $i; } | md5sum | cut -c1-32); )~"
+            R"~((exec 3<> /dev/tcp/127.0.0.1/$DCC_CACHE && echo "GET $DCC_TOKEN $k" >&3 && read -r w y <&3 && [ "$w" = HIT ] && head -c $y <&3 > $o.dcc$$ && )~"
+            R"~([ $(stat -c %s $o.dcc$$) = $y ]) 2> /dev/null && mv -f $o.dcc$$ $o && a=cache e=0; fi; )~"
+
+            // Preprocess locally (unless done for the cache), compile the preprocessed source on the helper. Messages of the preprocessor
+            // (e.g., #warning) are only printed by a local compile
+            R"~(if [ $e != 0 ] && [ $a != local ]; then { [ -n "$k" ] || { $n "${B[@]}" -E "$s" -o $i 2> $i.err && ! [ -s $i.err ]; }; } && )~" SSH_PI_SSH R"~( -o ControlPath=$x/cm-%C -p $po $DCC_USER@$h )~"
+            R"~("d=\$(mktemp -d) && cd \$d && $n $q -x $l -c - -o o.o && cat o.o; r=\$?; cd; rm -rf \$d; exit \$r" < $i > $o.dcc$$ 2> $i.err && mv -f $o.dcc$$ $o; e=$?; fi; )~"
+
+            // Compile locally in a local slot, or if the helper failed (e.g., it went offline), the warnings of the successful compile are printed
+            R"~([ $e = 0 ] || { a=local; $n "${A[@]}" 2> $i.err; e=$?; }; [ -f $i.err ] && cat $i.err >&2; )~"
+
+            // Store a new object file in the cache, unless there were warnings (they would be missing after a hit)
+            R"~([ -n "$k" ] && [ $e = 0 ] && [ $a != cache ] && ! [ -s $i.err ] && (exec 3<> /dev/tcp/127.0.0.1/$DCC_CACHE && )~"
+            R"~({ echo "PUT $DCC_TOKEN $k $(stat -c %s $o)"; cat $o; } >&3 && read -r w <&3) 2> /dev/null; )~"
+
+            // Release the slot and log the time of the job
+            R"~(rm -f $i $i.err $o.dcc$$; rmdir "$d"; echo "$a $((($(date +%s%N) - t) / 1000000))" >> $x/log; exit $e; fi; )~"
+
+            // The build creates the compiler (for every name it may be called by) and opens a master connection to every helper, the compatible ones
+            // with free CPUs are saved with their number of slots, like the local CPUs. The connections to the helpers run in their own sessions (setsid),
+            // so an abort (SIGTERM to the process group of the build) closes the master connections and stops the SSH clients of the jobs (their
+            // command lines contain the control path), the temporary object files of jobs aborted by an earlier build are removed
+            R"~(U=$1; export DCC_CACHE=$2; W=$3; shift 3; )~" SSH_PI_ASKPASS R"~(read -r T; F=$(f); export DCC=$x DCC_USER=$U DCC_F=$F DCC_TOKEN=$T; mkdir $x/bin $x/slot && echo "local 0 - $(nproc)" > $x/hosts && )~"
+            R"~(printf "#!/bin/sh\nexec bash -c \"\$S\" cc \"\$0\" \"\$@\"\n" > $x/cc && chmod 755 $x/cc && for c in cc c++ gcc g++; do ln -s ../cc $x/bin/$c; done || exit 1; )~"
+            R"~(Q() { grep -v "^local " $x/hosts | while read -r a o h k; do )~" SSH_PI_SSH R"~( -o ControlPath=$x/cm-%C -O exit -p $o $U@$h 2> /dev/null; done; }; )~"
+            R"~(trap "Q; pkill -f $x/cm-; exit 143" TERM; find . -name "*.dcc[0-9]*" -type f -delete 2> /dev/null; )~"
+            R"~(for a in "$@"; do h=${a%:*}; o=22; [[ $a == *:* ]] && o=${a##*:}; { read -r k g < <()~" SSH_PI_SSH R"~( -o ControlMaster=auto -o ControlPath=$x/cm-%C -o ControlPersist=60 )~"
+            R"~(-p $o $U@$h "S=$(printf %q "$S"); export S; bash -c \"\$S\" probe $W" < /dev/null 2> /dev/null); [ "$g" = "$F" ] && [ "${k:-0}" -gt 0 ] && echo "$a $o $h $k" >> $x/hosts; } & done; wait; )~"
+
+            // Run make with as many jobs as there are slots (without helpers one job like a normal build), then close the master connections
+            // and print the speedup over compiling the jobs one after another, the hits of the cache are counted by the host
+            R"~(J=$(awk "{s += \$4} END {print s}" $x/hosts); [ $# -gt 0 ] || J=1; t=$(date +%s%N); PATH=$x/bin:$PATH make -s -j$J; e=$?; w=$((($(date +%s%N) - t) / 1000000)); )~"
+            R"~(Q; )~"
+            R"~([ $# -gt 0 ] && [ -f $x/log ] && awk -v w=$w -v m=$(grep -vc "^local " $x/hosts) "\$1 == \"cache\" {next} {n[\$1]++; s += \$2; c++} END {if (!c) exit; printf \"Distributed %d compile job(s) to %d helper(s):\", c, m; )~"
+            R"~(for (h in n) printf \" %s %d\", h, n[h]; printf \". %.1f s of compile time in %.1f s (%.1fx speedup over a serial build).\n\", s / 1000, w / 1000, (w > 0 ? s / w : 0)}" $x/log; exit $e)~";
+
+        distribute = std::format("S='{}'; export S; ", script);
+        make = std::format("bash -c \"$S\" build {} {} {}", user, cachePort, workspace);
+        for (const std::string& helper : helpers)
+            make.append(" " + helper);
+    }
+
     // Create the command string/script which builds the project
-    std::string cmd = std::format(
-        // Change to the project directory, create the Debug folder -------------------------------------------------------|
-        "cd sw_workspace/{} && (mkdir -p Debug && ("                                                                    // |
+    std::string cmd = distribute + std::format(
+        // Change to the project directory, create the Debug folder, remove the PID of an interrupted build --------------|
+        "cd {}/{} && (mkdir -p Debug && rm -f Debug/{} && ("                                                            // |
                                                                                                                         // |
             // Check if the makefile is there -------------------------------------------------------|                  // |
             "test -f makefile && ("                                                               // |                  // |
                                                                                                   // |                  // |
-                // Execute make and create the application output file output.txt ---|            // |                  // |
-                "make -s && > Debug/output.txt || "                              // |            // |                  // |
-                                                                                  // |            // |                  // |
-                // If there was a build error <--------------------------------------|            // |                  // |
-                ">&2 echo Build error)) || "                                                       // |                  // |
+                // Hash the sources (paths, sizes, contents) in the manifest,                     // |                  // |
+                // empty without a manifest (always built then)                                   // |                  // |
+                "h=$({}); "                                                                       // |                  // |
+                                                                                                  // |                  // |
+                // If the hash equals the one of the last successful build                        // |                  // |
+                // and its binary is there, print the log of that build                           // |                  // |
+                "if test -n \"$h\" && test {} = 0 && test -f Debug/{} && test -f Debug/{} && "    // |                  // |
+                "test \"$h\" = \"$(cat Debug/{} 2>/dev/null)\"; then "                            // |                  // |
+                "echo '{}'; cat Debug/{}; else "                                                  // |                  // |
+                                                                                                  // |                  // |
+                // Else remove the old hash, save the PID (to abort the build), and execute make, // |                  // |
+                // stream and save its stdout (the log) and stderr                                // |                  // |
+                "rm -f Debug/{}; echo $$ > Debug/{}; set -o pipefail; "                           // |                  // |
+                "{{ {} 2>&1 >&3 3>&- | tee Debug/{}.err >&2; }} 3>&1 | tee Debug/{}; "            // |                  // |
+                "r=$?; rm -f Debug/{}; "                                                          // |                  // |
+                                                                                                  // |                  // |
+                // Create the application output file output.txt, save the                        // |                  // |
+                // hash unless make printed to stderr (a build error)                             // |                  // |
+                "test $r = 0 && > Debug/output.txt{} && "                                         // |                  // |
+                "{{ test -s Debug/{}.err || test -z \"$h\" || echo $h > Debug/{}; }} || "         // |                  // |
+                                                                                                  // |                  // |
+                // If there was a build error print it, always remove the saved stderr           // |                  // |
+                ">&2 echo Build error; rm -f Debug/{}.err; fi)) || "                              // |                  // |
                                                                                                   // |                  // |
             // If there is no makefile <-------------------------------------------------------------|                  // |
             ">&2 echo Error: The project is missing a makefile) || "                                                    // |
                                                                                                                         // |
         // If the change to the project directory was unsuccessful, the project was probably not saved before <------------|              
         ">&2 echo Have you saved the project before?",
-    project);
+    workspace, project, SSH_BUILD_PID, SSH_SOURCE_HASH,
+    rebuild ? 1 : 0, project, SSH_BUILD_LOG, SSH_BUILD_FILE, upToDate, SSH_BUILD_LOG,
+    SSH_BUILD_FILE, SSH_BUILD_PID, make, SSH_BUILD_LOG, SSH_BUILD_LOG,
+    SSH_BUILD_PID,
+    persist,
+    SSH_BUILD_LOG, SSH_BUILD_FILE,
+    SSH_BUILD_LOG);
     
-    // Execute the command, save the return code
-    int rc = execute(cmd.c_str());
+    // Command which aborts the build: stops the process group of the build (all jobs of make), fails until the PID was saved
+    std::string abortCmd = std::format("p=$(cat {}/{}/Debug/{} 2>/dev/null) && {{ kill -TERM -- -$p || kill -TERM $p; }} 2>/dev/null && echo killed",
+        workspace, project, SSH_BUILD_PID);
+
+    // Execute the command, print its output while it is running and capture it, so that a skipped build can be recognized
+    // With the cache its requests are answered meanwhile. A distributed build gets the password and the token of the cache through stdin,
+    // so that they don't appear in any command line
+    std::string input = std::format("{}\n{}\n", passwd, cachePort != 0 ? buildCache.token() : "-"), out, err;
+    abortable = true;
+    int rc = execute_stream(cmd.c_str(), &out, &err, distribute.empty() ? nullptr : &input, cachePort != 0, abortCmd);
+    abortable = false;
+
+    // Stop the forwarding and remove the least recently used object files if the cache grew too large
+    if (cachePort != 0) {
+        ssh_channel_cancel_forward(session, "localhost", cachePort);
+        buildCache.prune();
+    }
 
-    // If there was an error executing the command
-    if (rc != SSH_OK)
-        // Return the return code
-        return rc;
+    // If the connection failed
+    if (rc == SSH_ERROR)
+        return SSH_ERROR;
+
+    // If the build was aborted (on request or on the first error)
+    if (rc == SSH_CMD_ERROR) {
+        std::cerr << "Build aborted." << std::endl;
+
+        return SSH_CMD_ERROR;
+    }
+
+    // The output of make resp. the log of the last build was already printed, followed by the statistics of the cache
+    std::string statistics = cachePort != 0 ? buildCache.statistics() : "";
+    if (!statistics.empty())
+        std::cout << statistics << std::endl;
 
-    // Print the build success to stdout
-    std::cout << "Build succeeded." << std::endl;
+    // If there was an error building the project (anything on stderr, as with execute)
+    if (!err.empty())
+        return SSH_CMD_ERROR;
+
+    // Print the build success to stdout, unless the build was skipped (the first line says it's up to date then)
+    if (out.rfind(upToDate, 0) != 0)
+        std::cout << "Build succeeded." << std::endl;
 
     return SSH_OK;
 }
 
 int SSH::start(const char* project, const char* args) {
+    // Command part which restores the persisted binary, only used with a volatile (e.g., RAM) workspace
+    std::string restore = "";
+
+    // If the binary was persisted and the project is started outside the persistent workspace
+    if (persistBinary && is_volatile_workspace())
+        // If the binary is missing (e.g., the RAM was cleared by a reboot) copy it back from the persistent workspace
+        restore = std::format("test -f {}/{}/Debug/{} || {{ mkdir -p {}/{}/Debug && cp ~/{}/{}/Debug/{} {}/{}/Debug/; }} 2>/dev/null; ",
+            workspace, project, project, workspace, project, SSH_WORKSPACE, project, project, workspace, project);
+
     // Create the first part of the command string/script which starts the project
-    std::string cmd = std::format(
+    std::string cmd = restore + std::format(
         // Change to the project directory
-        "cd sw_workspace/{} && ("
+        "cd {}/{} && ("
 
             // Change to the Debug directory
             "cd Debug && ("
                 
-                // Check if the previously built project binary is there, invoke a new bash, and start the project binary
-                "test -f {} && {{ bash -c './{} ",
-    project, project, project);
+                // Check if the previously built project binary is there, remove the state files of the previous run,
+                // invoke a new bash as leader of a new process group (setsid), catch SIGTERM so that the bash survives stopping the process group
+                "test -f {} && {{ rm -f {} {} {}; setsid bash -c 'trap : TERM; ",
+    workspace, project, project, SSH_PID_FILE, SSH_EXIT_FILE, SSH_LAUNCH_FILE);
+
+    // Get the commands which apply the resource options
+    std::string setup = resource_setup(project);
+
+    // Commands which wait until the synchronized start time, only used with the option startAt
+    std::string release = "";
+
+    // Clock offset of the SSH client (its clock minus ours) in microseconds
+    long long offset = 0;
+
+    // If the application should be started at a given time
+    if (startAt != 0) {
+        // Measure the clock offset, needed to convert the start time to the clock of the SSH client
+        long long rtt;
+        int rc = measure_clock(&offset, &rtt);
+
+        // If the clock couldn't be read
+        if (rc != SSH_OK)
+            return rc;
+
+        // Print the measurement, the start skew can't be more accurate than half the round trip time
+        std::cout << std::format("Clock offset {:+.3f} ms, round trip time {:.3f} ms.", offset / 1000.0, rtt / 1000.0) << std::endl;
+
+        // Start time in microseconds on the clock of the SSH client
+        long long target = startAt * 1000 + offset;
+
+        release = std::format(
+            // Sleep until 20 ms before the start time (bash >= 5 provides EPOCHREALTIME), then wait actively for the exact time, the margin covers the start of sleep
+            "t=$(({} - ${{EPOCHREALTIME/[.,]/}} - 20000)); ((t > 0)) && sleep $((t / 1000000)).$(printf %06d $((t % 1000000))); "
+            "while ((${{EPOCHREALTIME/[.,]/}} < {})); do :; done; "
+
+            // Save the actual start time to report the skew
+            "echo ${{EPOCHREALTIME/[.,]/}} > {}; ",
+        target, target, SSH_LAUNCH_FILE);
+    }
+
+    // If no resource option is set and the application should be started immediately
+    if (setup.empty() && release.empty())
+        // Start the project binary
+        cmd.append(std::format("./{} ", project));
+    else
+        // Else start a subshell which stops itself, so that the options can be applied (and the start time be awaited) before it's replaced by the project binary
+        // Truncate output.txt beforehand and append to it, so that the warnings of the setup aren't overwritten
+        cmd.append(std::format(": > output.txt; ( kill -STOP $BASHPID; {}exec ./{} ", release, project));
 
     // If arguments are given
     if (args != nullptr)
         // Append the arguments to the command string
         cmd.append(args);
 
-    // Append the second and last part of the command string
+    // If no resource option is set and the application should be started immediately
+    if (setup.empty() && release.empty())
+        // Redirect stdout and stderr from the project binary to the output file output.txt and run it in background
+        cmd.append(" &> output.txt & c=$!; ");
+    else
+        cmd.append(std::format(
+            // Close the subshell, append its stdout and stderr to output.txt, and run it in background
+            " ) &>> output.txt & c=$!; "
+
+            // Wait up to five seconds until the subshell has stopped itself (state T)
+            "for ((j = 0; j < 500; j++)); do read -r s < /proc/$c/stat; s=${{s##*\\) }}; test \"${{s%% *}}\" = T && break; sleep 0.01; done; "
+
+            // Apply the resource options and let the subshell continue
+            "{}kill -CONT $c; ",
+        setup));
+
+    // Append the last part of the command string
     cmd.append(std::format(
-                // Redirect stdout and stderr from the project binary to the output file output.txt, wait for the termination and append the exit code to output.txt
+
+                // Save the PID, the start time (field 22 of /proc/<pid>/stat, to detect a reused PID), and the process group (PID of this bash) inside the PID file
+                "read -r s < /proc/$c/stat; s=${{s##*\\) }}; set -- $s; echo \"$c ${{20}} $$\" > {}.tmp && mv {}.tmp {}; "
+
+                // Wait for the termination, wait again while the wait is interrupted by the SIGTERM trap, the last wait returns the exit code
+                "wait $c; while kill -0 $c 2>/dev/null; do wait $c; done; wait $c; r=$?; "
+
+                // Restore the CPU governors and remove the cgroup (if they were changed) before the exit is visible
+                "{}"
+
+                // Save the exit code inside the exit file and append it to output.txt
+                "echo $r > {}; echo \"\nThe Process exited with Code $r\" >> output.txt' "
+
                 // Redirect stdout and stderr from the bash to /dev/null (so that later read calls don't block) and run the bash commands in background
-                " &> output.txt; echo \"\nThe Process exited with Code $?\" >> output.txt' &>/dev/null & }} || "
+                // Wait up to five seconds until the PID file was written so that a following status check already finds it
+                "&>/dev/null & for ((i = 0; i < 50; i++)); do test -f {} && break; sleep 0.1; done; }} || "
 
                 // If there is no binary, it may has a wrong name or the previous compilation was unsuccessful
                 ">&2 echo 'The binary {} of the project is missing\nIs the final target of the makefile called {}?\nWas the compilation of the project successful?') || "
@@ -487,26 +2916,222 @@ int SSH::start(const char* project, const char* args) {
 
         // If the change to the project directory was unsuccessful, the project was probably not saved before
         ">&2 echo 'Have you saved the project before?'",
-    project, project));
+    SSH_PID_FILE, SSH_PID_FILE, SSH_PID_FILE, resource_restore(), SSH_EXIT_FILE, SSH_PID_FILE, project, project));
     
-    // Execute the command, save the return code
-    int rc = execute(cmd.c_str());
+    // Execute the command (through the agent if possible), save the return code
+    int rc = execute_agent(cmd.c_str());
 
     // If there was an error executing the command
     if (rc != SSH_OK)
         // Return the return code
         return rc;
 
+    // If the application was started at a given time
+    if (startAt != 0) {
+        // Wait until the start time has passed on our clock
+        std::this_thread::sleep_until(std::chrono::system_clock::time_point(std::chrono::milliseconds(startAt + 100)));
+
+        // Read the actual start time, saved by the launcher
+        std::vector<BatchCommand> cmds(1);
+        cmds[0].cmd = std::format("cat {}/{}/Debug/{}", workspace, project, SSH_LAUNCH_FILE);
+
+        long long launched;
+        if (execute_batch(&cmds) == SSH_OK && cmds[0].rc == 0 && sscanf(cmds[0].out.c_str(), "%lld", &launched) == 1)
+            // Convert it to our clock and print the difference to the requested start time
+            std::cout << std::format("Start skew {:+.3f} ms.", (launched - offset - startAt * 1000) / 1000.0) << std::endl;
+        else
+            // Print an error message to stderr
+            std::cerr << "Couldn't read the actual start time." << std::endl;
+    }
+
     // Print the successful start to stdout
     std::cout << "Application " << project << " started." << std::endl;
 
     return SSH_OK;
 }
 
+int SSH::measure_clock(long long* offset, long long* rtt) {
+    *rtt = -1;
+
+    // Take multiple samples, use the one with the shortest round trip time because its offset is the most accurate
+    for (int i = 0; i < 5; i++) {
+        // Our time before the request
+        auto before = std::chrono::system_clock::now();
+
+        // Read the time of the SSH client in microseconds, through the agent if possible
+        long long remote;
+        std::string payload, response, out, err;
+        size_t pos = 0;
+        uint64_t ns;
+
+        if (use_agent() && agent->request(AGENT_TIME, payload, &response) == SSH_OK && agent::get_u64(response, &pos, &ns))
+            remote = (long long)(ns / 1000);
+        else if (execute_capture("date +%s%6N", &out, &err) != SSH_OK || sscanf(out.c_str(), "%lld", &remote) != 1) {
+            // Print an error message to stderr
+            std::cerr << "Couldn't read the clock of the SSH client. " << err << std::endl;
+
+            return SSH_ERROR;
+        }
+
+        // Our time after the response
+        auto after = std::chrono::system_clock::now();
+
+        // The time of the SSH client is assumed in the middle of the round trip
+        long long sampleRtt = std::chrono::duration_cast<std::chrono::microseconds>(after - before).count();
+        long long middle = std::chrono::duration_cast<std::chrono::microseconds>(before.time_since_epoch()).count() + sampleRtt / 2;
+
+        // Keep the sample with the shortest round trip time
+        if (*rtt < 0 || sampleRtt < *rtt) {
+            *rtt = sampleRtt;
+            *offset = remote - middle;
+        }
+    }
+
+    return SSH_OK;
+}
+
+// Shell function which runs a command, and again through sudo (without password prompt) if it failed e.g., because of missing permissions
+#define SSH_PRIV_FUNCTION "priv() { \"$@\" || sudo -n \"$@\"; } &>/dev/null; "
+
+std::string SSH::resource_setup(const char* project) {
+    // Commands which apply the resource options to the stopped subshell $c, warnings are appended to output.txt
+    std::string setup;
+
+    // If the application should be bound to some CPUs
+    if (!cpuAffinity.empty())
+        setup.append(std::format("taskset -p -c {} $c &>/dev/null || echo \"Warning: Could not set the CPU affinity {}\" >> output.txt; ",
+            cpuAffinity, cpuAffinity));
+
+    // If the nice value should be changed, a negative value requires root
+    if (niceness != 0)
+        setup.append(std::format("priv renice -n {} -p $c || echo \"Warning: Could not set the nice value {}\" >> output.txt; ",
+            niceness, niceness));
+
+    // If a real-time priority should be used, requires root
+    if (rtPriority != 0)
+        setup.append(std::format("priv chrt -f -p {} $c || echo \"Warning: Could not set the real-time priority {}\" >> output.txt; ",
+            rtPriority, rtPriority));
+
+    // If the memory and/or CPU time should be limited
+    if (!memoryLimit.empty() || cpuLimit != 0) {
+        // Controllers to enable for the cgroups below the root and the limits to write
+        std::string controllers, limits;
+
+        if (!memoryLimit.empty()) {
+            controllers.append(" +memory");
+            limits.append(std::format("echo {} > $g/memory.max && ", memoryLimit));
+        }
+
+        if (cpuLimit != 0) {
+            // The quota is the CPU time in microseconds per period of 100 ms
+            controllers.append(" +cpu");
+            limits.append(std::format("echo {} 100000 > $g/cpu.max && ", cpuLimit * 1000));
+        }
+
+        // Create a cgroup (v2, recognizable by cgroup.controllers) for the project, save its path for the removal, set the limits, and move the subshell into it
+        setup.append(std::format(
+            "g=/sys/fs/cgroup/pideploy-{}; test -f /sys/fs/cgroup/cgroup.controllers && priv sh -c \"echo{} > /sys/fs/cgroup/cgroup.subtree_control; mkdir -p $g && {}echo $c > $g/cgroup.procs\" "
+            "&& echo $g > {} || echo \"Warning: Could not create the cgroup $g with the limits (requires cgroup v2 and sudo)\" >> output.txt; ",
+        project, controllers, limits, SSH_CGROUP_FILE));
+    }
+
+    // If a CPU frequency governor should be set
+    if (!governor.empty())
+        setup.append(std::format(
+            // If the CPU frequency can be scaled at all
+            "if test -f /sys/devices/system/cpu/cpu0/cpufreq/scaling_governor; then "
+
+                // Save the original governor of every CPU, unless a previous run couldn't restore them
+                "test -f {} || for f in /sys/devices/system/cpu/cpu[0-9]*/cpufreq/scaling_governor; do echo \"$f $(< $f)\"; done > {}; "
+
+                // Set the governor for all CPUs, requires root
+                "priv sh -c \"echo {} | tee /sys/devices/system/cpu/cpu[0-9]*/cpufreq/scaling_governor\" || echo \"Warning: Could not set the CPU governor {}\" >> output.txt; "
+
+            "else echo \"Warning: The CPU governor cannot be changed\" >> output.txt; fi; ",
+        SSH_GOVERNOR_FILE, SSH_GOVERNOR_FILE, governor, governor));
+
+    // Define the function for the privileged commands if there is any setup
+    return setup.empty() ? setup : SSH_PRIV_FUNCTION + setup;
+}
+
+std::string SSH::resource_restore() {
+    return SSH_PRIV_FUNCTION + std::format(
+        // Write the saved governor back to every CPU
+        "if test -f {}; then while read -r f g; do priv sh -c \"echo $g > $f\"; done < {}; rm -f {}; fi; "
+
+        // Remove the cgroup, retry while the killed processes are still inside it
+        "if test -f {}; then g=$(< {}); for ((i = 0; i < 10; i++)); do priv rmdir $g && break; sleep 0.1; done; rm -f {}; fi; ",
+    SSH_GOVERNOR_FILE, SSH_GOVERNOR_FILE, SSH_GOVERNOR_FILE, SSH_CGROUP_FILE, SSH_CGROUP_FILE, SSH_CGROUP_FILE);
+}
+
+std::string SSH::app_running_condition(const char* project) {
+    // Create the condition which is only true if the application of the last start is still running
+    return std::format(
+        // Change to the Debug directory and read the PID, start time, and process group from the PID file
+        "cd {}/{}/Debug 2>/dev/null && read -r pid start pgid 2>/dev/null < {} && "
+
+        // The application has not exited yet if there is no exit file
+        "test ! -f {} && "
+
+        // Check that the process exists and has the saved start time, else the PID was reused by another process
+        "read -r s < /proc/$pid/stat 2>/dev/null && s=${{s##*\\) }} && set -- $s && test \"${{20}}\" = \"$start\"",
+    workspace, project, SSH_PID_FILE, SSH_EXIT_FILE);
+}
+
 int SSH::stop(const char* project) {
-    // Create the command which sends a termination signal to the project application
-    // If an error occured, the project application is probably not running
-    std::string cmd = std::format("killall {} || >&2 echo Are you sure that the Application is running?", project);
+    // If the agent can be used let it stop the application, it behaves like the command below
+    if (use_agent()) {
+        std::string payload, response;
+        agent::put_string(&payload, std::format("{}/{}/Debug", workspace, project));
+        agent::put_u32(&payload, (uint32_t)(stopTimeout * 1000));
+        agent::put_string(&payload, resource_restore());
+
+        // Send the request, save the return code
+        int rc = agent->request(AGENT_STOP, payload, &response);
+
+        size_t pos = 0;
+        uint32_t exitCode;
+        std::string error;
+
+        // If the application was stopped print its exit code
+        if (rc == SSH_OK && agent::get_u32(response, &pos, &exitCode)) {
+            std::cout << "The Application exited with Code " << (int)exitCode << "." << std::endl;
+            std::cout << "Application " << project << " stopped." << std::endl;
+
+            return SSH_OK;
+        }
+
+        // If the application isn't running print the error message of the agent
+        if (rc == SSH_CMD_ERROR && agent::get_string(response, &pos, &error)) {
+            std::cerr << error << std::endl;
+
+            return SSH_CMD_ERROR;
+        }
+
+        // Else fall back to the shell command
+    }
+
+    // Create the command which sends a termination signal to the process group of the project application
+    std::string cmd = std::format(
+        // Check if the application is running
+        "{} && {{ "
+
+            // Send SIGTERM to the whole process group
+            "kill -TERM -- -$pgid; "
+
+            // Wait until the exit file was written or the timeout elapsed
+            "for ((i = 0; i < {}; i++)); do test -f {} && break; sleep 0.1; done; "
+
+            // If the application is still running send SIGKILL to the whole process group, the exit code is 128 + 9 then
+            // The launcher is killed as well, so restore the resource options here
+            "test -f {} || {{ kill -KILL -- -$pgid; {}echo 137 > {}; echo \"\nThe Process was killed\" >> output.txt; }}; "
+
+            // Print the exit code of the application
+            "echo The Application exited with Code $(< {}).; }} || "
+
+        // If an error occured, the project application is probably not running
+        ">&2 echo Are you sure that the Application is running?",
+    app_running_condition(project), stopTimeout * 10, SSH_EXIT_FILE, SSH_EXIT_FILE, resource_restore(), SSH_EXIT_FILE, SSH_EXIT_FILE);
 
     // Execute the command, save the return code
     int rc = execute(cmd.c_str());
@@ -523,9 +3148,27 @@ int SSH::stop(const char* project) {
 }
 
 int SSH::isAppRunning(const char* project) {
-    // Create the command which gets the PID of the project application and redirect it to /dev/null (so that it isn't printed to stdout because it isn't important)
+    // If the agent can be used let it check the PID file
+    if (use_agent()) {
+        std::string payload, response;
+        agent::put_string(&payload, std::format("{}/{}/Debug", workspace, project));
+
+        size_t pos = 0;
+        uint8_t running;
+        if (agent->request(AGENT_STATUS, payload, &response) == SSH_OK && agent::get_u8(response, &pos, &running)) {
+            // Print the same messages as the command below
+            if (running)
+                std::cout << "Application is running." << std::endl;
+            else
+                std::cerr << "Application is not running." << std::endl;
+
+            return running ? SSH_APP_RUNNING : SSH_APP_NOT_RUNNING;
+        }
+    }
+
+    // Create the command which checks the PID file of the project application (no scan of all processes)
     // If the command is successful the application of the project is currently running, else not
-    std::string com = std::format("pidof {} > /dev/null && echo Application is running. || >&2 echo Application is not running.", project);
+    std::string com = std::format("{} && echo Application is running. || >&2 echo Application is not running.", app_running_condition(project));
 
     // Execute the command, save the return code
     int rc = execute(com.c_str());
@@ -542,9 +3185,77 @@ int SSH::isAppRunning(const char* project) {
     }
 }
 
+int SSH::refresh(const char* project, unsigned int nbytes) {
+    // If the agent can be used send both requests at once (pipelined) and wait for the responses afterwards
+    if (use_agent()) {
+        std::string status, output;
+        agent::put_string(&status, std::format("{}/{}/Debug", workspace, project));
+        agent::put_string(&output, std::format("{}/{}/Debug/output.txt", workspace, project));
+        agent::put_u32(&output, nbytes);
+
+        uint32_t statusId = agent->send(AGENT_STATUS, status);
+        uint32_t outputId = agent->send(AGENT_OUTPUT, output);
+
+        // Wait for the responses, a missing output file isn't an error here
+        std::string statusResponse, outputResponse, content;
+        size_t statusPos = 0, outputPos = 0;
+        uint8_t running;
+        int outputRc = SSH_ERROR;
+        if (statusId != 0 && outputId != 0 && agent->receive(statusId, &statusResponse) == SSH_OK && agent::get_u8(statusResponse, &statusPos, &running)
+            && (outputRc = agent->receive(outputId, &outputResponse)) != SSH_ERROR) {
+            // Print the output of the application (if there is one) to stdout
+            if (outputRc == SSH_OK && agent::get_string(outputResponse, &outputPos, &content))
+                write_to_stdout(content.data(), content.length());
+
+            // Return if the application is running
+            return running ? SSH_APP_RUNNING : SSH_APP_NOT_RUNNING;
+        }
+    }
+
+    // Check if the application is running and read the last nbytes Bytes of its output within one round trip
+    std::vector<BatchCommand> cmds(2);
+    cmds[0].cmd = app_running_condition(project);
+    cmds[1].cmd = std::format("tail -c{} {}/{}/Debug/output.txt", nbytes, workspace, project);
+
+    // Execute both commands, save the return code
+    int rc = execute_batch(&cmds);
+
+    // If there was a connection error
+    if (rc != SSH_OK)
+        // Return 0 like isAppRunning
+        return 0;
+
+    // Print the output of the application (if there is one) to stdout
+    write_to_stdout(cmds[1].out.data(), cmds[1].out.length());
+
+    // Return if the application is running
+    return cmds[0].rc == 0 ? SSH_APP_RUNNING : SSH_APP_NOT_RUNNING;
+}
+
 int SSH::readOutput_once(const char* project, unsigned int nbytes) {
+    // If the agent can be used let it read the end of the output file
+    if (use_agent()) {
+        std::string payload, response, content;
+        agent::put_string(&payload, std::format("{}/{}/Debug/output.txt", workspace, project));
+        agent::put_u32(&payload, nbytes);
+
+        // Send the request, save the return code
+        int rc = agent->request(AGENT_OUTPUT, payload, &response);
+
+        // If the request was answered print the output resp. the error message like tail
+        size_t pos = 0;
+        if (rc != SSH_ERROR && agent::get_string(response, &pos, &content)) {
+            if (rc == SSH_OK)
+                write_to_stdout(content.data(), content.length());
+            else
+                std::cerr << content << std::endl;
+
+            return rc;
+        }
+    }
+
     // Create the tail command for reading the last nbytes Bytes of the project's output file output.txt once
-    std::string tail = std::format("tail -c{} sw_workspace/{}/Debug/output.txt", nbytes, project);
+    std::string tail = std::format("tail -c{} {}/{}/Debug/output.txt", nbytes, workspace, project);
 
     // Execute the tail command with a buffer size of nbytes, return the return code
     return execute(tail.c_str(), nbytes);
@@ -552,7 +3263,7 @@ int SSH::readOutput_once(const char* project, unsigned int nbytes) {
 
 int SSH::readOutput_cont(const char* project, unsigned int nbytes) {
     // Create the tail command for reading the last nbytes Bytes of the project's output file output.txt continuously
-    std::string tail = std::format("tail -f -c{} sw_workspace/{}/Debug/output.txt", nbytes, project);
+    std::string tail = std::format("tail -f -c{} {}/{}/Debug/output.txt", nbytes, workspace, project);
 
     // Execute the tail command with a buffer size of nbytes, return the return code
     return execute(tail.c_str(), nbytes);
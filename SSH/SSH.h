@@ -1,7 +1,17 @@
 #pragma once
 
+#include "Bandwidth.h"
+#include "BuildCache.h"
+#include "Delta.h"
+
+#include <stdint.h>
+
+#include <atomic>
 #include <list>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #define SSH_OK				0
 #define SSH_ERROR		   -1
@@ -10,16 +20,95 @@
 #define SSH_APP_RUNNING		1
 #define SSH_APP_NOT_RUNNING 2
 
+// The persistent workspace on the SD card of the SSH client, relative to the home directory
+#define SSH_WORKSPACE		"sw_workspace"
+
+// The workspace inside the RAM (tmpfs) of the SSH client, used with the option workspace=ram
+#define SSH_RAM_WORKSPACE	"/dev/shm/sw_workspace"
+
+// Files inside the Debug folder of a project which save the PID, start time, and process group resp. the exit code of the last start
+#define SSH_PID_FILE		"app.pid"
+#define SSH_EXIT_FILE		"app.exit"
+
+// Files inside the Debug folder of a project which save the original CPU governors resp. the cgroup of the last start, used to restore them
+#define SSH_GOVERNOR_FILE	"governor.saved"
+#define SSH_CGROUP_FILE		"app.cgroup"
+
+// File inside a saved project which lists the content hashes of the saved files (see Manifest), used by sync
+#define SSH_MANIFEST_FILE	".pideploy.manifest"
+
+// File inside the Debug folder of a project which saves the actual start time (microseconds since the Unix epoch) of a synchronized start
+#define SSH_LAUNCH_FILE		"app.launch"
+
+// Files inside the Debug folder of a project which save the source hash resp. the output of the last successful build, a build with the same hash is skipped
+#define SSH_BUILD_FILE		".pideploy-build"
+#define SSH_BUILD_LOG		".pideploy-build.log"
+
+// File inside the Debug folder of a project which saves the PID (and process group) of a running build, used to abort it
+#define SSH_BUILD_PID		".pideploy-build.pid"
+
+// Prefix of the line which a stage of a pipeline prints after its command with the exit code of the command
+#define SSH_STAGE_EXIT		"pideploy-stage-exit "
+
+// Folder on the SSH client, relative to the home directory, where the agent is built
+#define SSH_AGENT_FOLDER	".pideploy"
+
+// Folder inside the workspace into which large files are uploaded before they are renamed into place, so that an interrupted upload can be resumed
+#define SSH_PARTS_FOLDER	".pideploy-parts"
+
+// Folder inside the workspace with the content-addressed object store (option objectStore): one read-only file per content, named by its hash and size
+// (followed by x for executable files), the files of the projects are hard links to them so that projects with the same files don't need further copies
+#define SSH_OBJECTS_FOLDER	".pideploy-objects"
+
+// Folder inside the workspace with the releases of the projects (option releases): every release is a workspace of its own named after the time it was created,
+// the project folder inside the workspace is a symbolic link to the project inside the active release
+#define SSH_RELEASES_FOLDER	".pideploy-releases"
+
+// Files of at least this many Bytes are uploaded resumable, can be changed with the option resumeMinSize
+#define SSH_RESUME_MIN_SIZE	(1024 * 1024)
+
+// Number of reconnection attempts when the connection drops during an upload, can be changed with the option reconnects
+#define SSH_RECONNECTS		3
+
+// Maximum number of Raspberry Pis to which every node of a relay forwards the project
+#define SSH_RELAY_MAX_FANOUT	4
+
+// Number of sent files whose hashes are requested together with the option verify, and how often files with a wrong hash are sent again
+#define SSH_VERIFY_BATCH	8
+#define SSH_VERIFY_ROUNDS	2
+
+// Local folder with the sources of the agent, can be changed with the option agent=<folder>
+#ifndef AGENT_DIR
+	#define AGENT_DIR		"Agent"
+#endif
+
 typedef struct ssh_session_struct*  ssh_session;
 typedef struct ssh_channel_struct*	ssh_channel;
 typedef struct sftp_session_struct* sftp_session;
 
+class Agent;
+class Manifest;
+
 /// <summary>
 /// Class for a SSH client
 /// </summary>
 class SSH {
 
 public:
+	/// <summary>
+	/// A single command of a batch, see execute_batch
+	/// </summary>
+	struct BatchCommand {
+		// The shell command to be executed
+		std::string cmd;
+
+		// The exit code of the command, set by execute_batch
+		int rc = SSH_ERROR;
+
+		// The stdout and stderr of the command, set by execute_batch
+		std::string out, err;
+	};
+
 	/// <summary>
 	/// Constructor for initialization
 	/// </summary>
@@ -56,6 +145,14 @@ public:
 	/// </summary>
 	void disconnect();
 
+	/// <summary>
+	/// Sets an option which changes the behavior of the following operations, unknown options are ignored
+	/// </summary>
+	/// <param name="key">Name of the option (e.g., "workspace")</param>
+	/// <param name="value">Value of the option</param>
+	/// <returns>SSH_OK on success, SSH_ERROR if the value is invalid</returns>
+	int setOption(const char* key, const char* value);
+
 	/// <summary>
 	/// Executes a command on the SSH client
 	/// </summary>
@@ -65,7 +162,14 @@ public:
 	int execute(const char* cmd, unsigned int buffer_size = 256);
 
 	/// <summary>
-	/// Saves the project in the folder 'sw_workspace' on the SSH client
+	/// Executes multiple commands as one script over a single channel i.e., within one round trip to the SSH client
+	/// </summary>
+	/// <param name="cmds">Pointer to the commands, their exit codes and outputs are saved inside them afterwards</param>
+	/// <returns>SSH_OK on success (independent of the exit codes of the commands), SSH_ERROR on connection error</returns>
+	int execute_batch(std::vector<BatchCommand>* cmds);
+
+	/// <summary>
+	/// Saves the project in the workspace folder (default: 'sw_workspace') on the SSH client, the saved and ignored files are printed afterwards
 	/// </summary>
 	/// <param name="project">Name of the project (i.e., folder)</param>
 	/// <param name="path2project">Path to the project on the host disk</param>
@@ -73,14 +177,118 @@ public:
 	int save(const char* project, const char* path2project = nullptr);
 
 	/// <summary>
-	/// Calls 'make' inside the project folder on the SSH client i.e., builds the project
+	/// Only transfers the files which changed since the last save or sync (compared by their content hashes with the manifest
+	/// saved on the SSH client) and removes the files which were deleted locally, other files on the SSH client (e.g., the build) are kept
+	/// </summary>
+	/// <param name="project">Name of the project (i.e., folder)</param>
+	/// <param name="path2project">Path to the project on the host disk</param>
+	/// <returns>SSH_OK on success, SSH_CMD_ERROR if the folders couldn't be created, SSH_ERROR on error</returns>
+	int sync(const char* project, const char* path2project = nullptr);
+
+	/// <summary>
+	/// Syncs the project, builds it incrementally, and (re)starts the application, used by the watch mode of the GUI.
+	/// With the option releases, the project is synced into a copy of the active release and built there while the application keeps running,
+	/// the application is only stopped to switch to the new release. The duration of every step is printed afterwards
+	/// </summary>
+	/// <param name="project">Name of the project (i.e., folder)</param>
+	/// <param name="path2project">Path to the project on the host disk</param>
+	/// <param name="args">Arguments which should be passed to the application</param>
+	/// <returns>SSH_OK on success, SSH_CMD_ERROR on build or start error, SSH_ERROR on connection error</returns>
+	int update(const char* project, const char* path2project = nullptr, const char* args = nullptr);
+
+	/// <summary>
+	/// Syncs the project to the SSH client (the seed), which then distributes it to the targets through a tree of SSH connections between
+	/// the Raspberry Pis: every node streams the project to up to relayFanout further nodes while extracting it, so that the host sends it only once
+	/// </summary>
+	/// <param name="project">Name of the project (i.e., folder)</param>
+	/// <param name="path2project">Path to the project on the host disk</param>
+	/// <param name="targets">Addresses of the other SSH clients as seen from the Raspberry Pis, optionally with the user and the port (user@address:port)</param>
+	/// <returns>SSH_OK if all targets received the project, SSH_CMD_ERROR if some didn't, SSH_ERROR on error</returns>
+	int relay(const char* project, const char* path2project, const std::vector<std::string>& targets);
+
+	/// <summary>
+	/// Prints the fingerprint of the SSH client (architecture, CPU, distribution, C library, compilers, and installed libraries),
+	/// SSH clients with the same fingerprint build the same binary from the same sources
+	/// </summary>
+	/// <param name="project">Name of the project, the hash of its sources is printed too (empty if it wasn't saved)</param>
+	/// <returns>SSH_OK on success, SSH_ERROR on connection error</returns>
+	int fingerprint(const char* project);
+
+	/// <summary>
+	/// Copies the binary of the project, which was built on the SSH client, directly to the targets instead of building it there.
+	/// A target only accepts it if its fingerprint and the hash of its sources are the same, a later compile on it is skipped then
+	/// </summary>
+	/// <param name="project">Name of the project (i.e., folder)</param>
+	/// <param name="targets">Addresses of the other SSH clients as seen from the Raspberry Pis, optionally with the port (address:port)</param>
+	/// <returns>SSH_OK if all targets received the binary, SSH_CMD_ERROR if the binary isn't up to date or some targets didn't, SSH_ERROR on error</returns>
+	int share(const char* project, const std::vector<std::string>& targets);
+
+	/// <summary>
+	/// Switches the project back to an older release (see the option releases), a running application is restarted with the release
+	/// </summary>
+	/// <param name="project">Name of the project (i.e., folder)</param>
+	/// <param name="release">Name of the release, nullptr or "previous" for the release before the active one</param>
+	/// <param name="args">Arguments which should be passed to the restarted application</param>
+	/// <returns>SSH_OK on success, SSH_CMD_ERROR if there is no such release or the restart failed, SSH_ERROR on connection error</returns>
+	int rollback(const char* project, const char* release = nullptr, const char* args = nullptr);
+
+	/// <summary>
+	/// Downloads the result files and folders (option results, default: Debug/output.txt) of the project from the SSH client,
+	/// the transferred Bytes and the throughput are printed afterwards
+	/// </summary>
+	/// <param name="project">Name of the project</param>
+	/// <param name="localDir">Local folder in which the results are saved, keeping their paths relative to the project (default: results/&lt;address&gt;)</param>
+	/// <returns>SSH_OK on success, SSH_ERROR on error</returns>
+	int collect(const char* project, const char* localDir = nullptr);
+
+	/// <summary>
+	/// Runs the pipeline of the project, i.e., the stages defined in its configuration file (see Pipeline), on the host and on the SSH clients
+	/// (this one and the ones of the option pipelinePis). Independent stages run in parallel, stages whose inputs haven't changed since
+	/// their last success are skipped unless the option rebuild is set, and the timing with the critical path is printed afterwards
+	/// </summary>
+	/// <param name="project">Name of the project</param>
+	/// <param name="path2project">Path to the project on the host disk, contains the configuration file</param>
+	/// <param name="stages">Names of the stages to run together with the stages they depend on, empty for all stages</param>
+	/// <returns>SSH_OK if all stages succeeded, SSH_CMD_ERROR if a stage failed, SSH_ERROR on error (e.g., an invalid pipeline)</returns>
+	int pipeline(const char* project, const char* path2project, const std::vector<std::string>& stages);
+
+	/// <summary>
+	/// Closes the SFTP session and the connection after the connection dropped, then connects again with the saved credentials
+	/// and starts a new SFTP session. Waits 1, 2, 4, ... seconds before the attempts
+	/// </summary>
+	/// <param name="sftp">Pointer to the SFTP session handle, replaced by the new one (nullptr on error)</param>
+	/// <param name="attempt">Number of the attempt, starting with 0</param>
+	/// <returns>SSH_OK on success, SSH_ERROR on error</returns>
+	int reconnect(sftp_session* sftp, long attempt);
+
+	/// <summary>
+	/// Returns if the last error of the SFTP session was caused by a dropped connection
+	/// </summary>
+	/// <param name="sftp">Pointer to the SFTP session handle</param>
+	bool connection_lost(sftp_session* sftp);
+
+	/// <summary>
+	/// Builds the manifest of a local project (all files with their content hashes, see Manifest) and prints it,
+	/// doesn't need a connection to the SSH client
+	/// </summary>
+	/// <param name="project">Name of the project</param>
+	/// <param name="path2project">Optional, path to the project on the host disk (default: current directory)</param>
+	/// <returns>SSH_OK on success, SSH_ERROR on error</returns>
+	int manifest(const char* project, const char* path2project = nullptr);
+
+	/// <summary>
+	/// Calls 'make' inside the project folder on the SSH client i.e., builds the project. The build is skipped (and the log of the last build
+	/// is printed) if the sources haven't changed since the last successful build, unless the option rebuild is set
+	/// With the option cache, the compiler on the SSH client reuses the object files of all compatible Raspberry Pis through the cache on the host.
+	/// The output of make is printed while it is running, the build can be aborted with abort or (with the option abortOnError) on the first error
 	/// </summary>
 	/// <param name="project">Name of the project</param>
 	/// <returns>SSH_OK on build success, SSH_CMD_ERROR on build error, SSH_ERROR on connection or build error</returns>
 	int compile(const char* project);
 
 	/// <summary>
-	/// Starts the previously compiled binary (application) of the project on the SSH client
+	/// Starts the previously compiled binary (application) of the project on the SSH client,
+	/// with the option startAt the start is staged and released at the given time, the achieved skew is printed afterwards
 	/// </summary>
 	/// <param name="project">Name of the project</param>
 	/// <param name="args">Additional arguments when calling the binary, can be NULL for no arguments</param>
@@ -88,7 +296,16 @@ public:
 	int start(const char* project, const char* args = nullptr);
 
 	/// <summary>
-	/// Stops the previously started application of the project on the SSH client
+	/// Requests to abort the running build or pipeline, can be called from another thread (e.g., the one waiting for input).
+	/// compile stops the build on the SSH client and returns SSH_CMD_ERROR, pipeline stops the builds of its tasks, starts no further tasks,
+	/// and returns SSH_CMD_ERROR after its running tasks have finished
+	/// </summary>
+	/// <returns>true if a build or pipeline is running which will be aborted, false if there is nothing to abort</returns>
+	bool abort();
+
+	/// <summary>
+	/// Stops the previously started application of the project on the SSH client by sending SIGTERM to its process group,
+	/// followed by SIGKILL if it is still running after stopTimeout seconds, the exit code of the application is printed
 	/// </summary>
 	/// <param name="project">Name of the project</param>
 	/// <returns>SSH_OK on success, SSH_CMD_ERROR on stop error, SSH_ERROR on connection error</returns>
@@ -101,6 +318,14 @@ public:
 	/// <returns>SSH_APP_RUNNING if the application is running, SSH_APP_NOT_RUNNING if the applications is not running, 0 on connection error</returns>
 	int isAppRunning(const char* project);
 
+	/// <summary>
+	/// Checks if the application of the project is running and prints its last output within one round trip (batch)
+	/// </summary>
+	/// <param name="project">Name of the project</param>
+	/// <param name="nbytes">Optional, specifies how much of the last bytes should be read (default: 2048)</param>
+	/// <returns>SSH_APP_RUNNING if the application is running, SSH_APP_NOT_RUNNING if the applications is not running, 0 on connection error</returns>
+	int refresh(const char* project, unsigned int nbytes = 2048);
+
 	/// <summary>
 	/// Reads the output of the project's application (through tail command) once
 	/// </summary>
@@ -128,6 +353,194 @@ private:
 	/// </summary>
 	bool connected;
 
+	/// <summary>
+	/// Username and address of the SSH client, saved by connect
+	/// </summary>
+	std::string user, addr;
+
+	/// <summary>
+	/// Password, port, and connection timeout of the SSH client, saved by connect to reconnect after a dropped connection
+	/// </summary>
+	std::string passwd;
+	unsigned int port = 22;
+	long timeout = 5;
+
+	/// <summary>
+	/// Read buffer of channel_redirect_output, kept between the calls so that it is only allocated once
+	/// </summary>
+	std::vector<char> channelBuffer;
+
+	/// <summary>
+	/// Client of the agent on the SSH client, created by the first call of use_agent
+	/// </summary>
+	Agent* agent = nullptr;
+
+	/// <summary>
+	/// Local folder with the sources of the agent, empty if the agent shouldn't be used (default: AGENT_DIR)
+	/// </summary>
+	std::string agentDir = AGENT_DIR;
+
+	/// <summary>
+	/// Path of the workspace folder on the SSH client where the projects are saved, built, and started (default: SSH_WORKSPACE)
+	/// </summary>
+	std::string workspace = SSH_WORKSPACE;
+
+	/// <summary>
+	/// Seconds to wait for the application to exit after SIGTERM before SIGKILL is sent (default: 5)
+	/// </summary>
+	long stopTimeout = 5;
+
+	/// <summary>
+	/// If true, the built binary is additionally copied to the persistent workspace when another workspace (e.g., RAM) is used
+	/// </summary>
+	bool persistBinary = false;
+
+	/// <summary>
+	/// If true, compile always calls make, even if the sources haven't changed since the last successful build
+	/// </summary>
+	bool rebuild = false;
+
+	/// <summary>
+	/// If true, compile aborts the build on the first error which the compiler or make prints, instead of waiting for the running jobs
+	/// </summary>
+	bool abortOnError = false;
+
+	/// <summary>
+	/// Set by abort, abortable is true while compile can abort the build, pipelineRunning while pipeline can abort its tasks
+	/// </summary>
+	std::atomic<bool> abortRequested = false, abortable = false, pipelineRunning = false;
+
+	/// <summary>
+	/// Connection of the pipeline which opened this one for its tasks, an abort of it aborts this one as well
+	/// </summary>
+	SSH* parent = nullptr;
+
+	/// <summary>
+	/// Addresses of other SSH clients as seen from the Raspberry Pi (optionally with the port), to which compile distributes the compile jobs
+	/// if they have the same fingerprint and free CPUs, empty to build locally (default)
+	/// </summary>
+	std::vector<std::string> helpers;
+
+	/// <summary>
+	/// Addresses of further SSH clients (optionally with the port) on which pipeline runs the stages, the connected one is always used
+	/// </summary>
+	std::vector<std::string> pipelinePis;
+
+	/// <summary>
+	/// All options in the order they were set, pipeline sets them on its further connections as well
+	/// </summary>
+	std::vector<std::pair<std::string, std::string>> optionValues;
+
+	/// <summary>
+	/// Folder of the compiler cache on the host which compile shares with all Raspberry Pis (see BuildCache), empty for no cache (default)
+	/// </summary>
+	std::string cacheFolder;
+
+	/// <summary>
+	/// Size of the compiler cache in MiB above which the least recently used object files are removed (default: BUILD_CACHE_SIZE)
+	/// </summary>
+	long cacheSize = BUILD_CACHE_SIZE;
+
+	/// <summary>
+	/// Compiler cache which answers the compiler on the SSH client during compile
+	/// </summary>
+	BuildCache buildCache;
+
+	/// <summary>
+	/// CPUs the application is bound to in the format of taskset (e.g., "2-3"), empty for no binding
+	/// </summary>
+	std::string cpuAffinity;
+
+	/// <summary>
+	/// Nice value of the application (-20 to 19, default: 0)
+	/// </summary>
+	long niceness = 0;
+
+	/// <summary>
+	/// Real-time priority (SCHED_FIFO, 1 to 99) of the application, 0 for the normal scheduling (default)
+	/// </summary>
+	long rtPriority = 0;
+
+	/// <summary>
+	/// Memory limit of the application's cgroup in the format of memory.max (e.g., "256M"), empty for no limit
+	/// </summary>
+	std::string memoryLimit;
+
+	/// <summary>
+	/// CPU limit of the application's cgroup in percent of one CPU (e.g., 150), 0 for no limit
+	/// </summary>
+	long cpuLimit = 0;
+
+	/// <summary>
+	/// CPU frequency governor (e.g., "performance") which is set while the application is running, empty to keep the current one
+	/// </summary>
+	std::string governor;
+
+	/// <summary>
+	/// Time (milliseconds since the Unix epoch on the local clock) at which the application should be started, 0 to start immediately
+	/// </summary>
+	long long startAt = 0;
+
+	/// <summary>
+	/// Paths of the result files and folders relative to the project folder, downloaded by collect
+	/// </summary>
+	std::vector<std::string> results = { "Debug/output.txt" };
+
+	/// <summary>
+	/// Patterns (gitignore syntax) of folders and files which aren't deployed in any project, the .deployignore of a project is applied afterwards
+	/// </summary>
+	std::vector<std::string> ignore;
+
+	/// <summary>
+	/// Changed files of at least this many Bytes are sent as block-level delta by sync (if the agent is used), 0 to always send them completely
+	/// </summary>
+	long deltaMinSize = DELTA_MIN_SIZE;
+
+	/// <summary>
+	/// Files of at least this many Bytes are uploaded into a part file which is resumed after a dropped connection, 0 to always write the files directly
+	/// </summary>
+	long resumeMinSize = SSH_RESUME_MIN_SIZE;
+
+	/// <summary>
+	/// Number of attempts to reconnect and resume when the connection drops while files are uploaded, 0 to fail immediately
+	/// </summary>
+	long reconnects = SSH_RECONNECTS;
+
+	/// <summary>
+	/// If true, the agent hashes every sent file after reading it back from the storage, files with a wrong hash are sent again
+	/// </summary>
+	bool verify = false;
+
+	/// <summary>
+	/// If true, the files of the projects are hard links into the object store (see SSH_OBJECTS_FOLDER), only missing objects are uploaded
+	/// </summary>
+	bool objectStore = false;
+
+	/// <summary>
+	/// Number of Raspberry Pis to which every node of a relay forwards the project, 0 to choose it by the number of targets (default)
+	/// </summary>
+	long relayFanout = 0;
+
+	/// <summary>
+	/// Number of releases of a project which are kept on the SSH client, 0 to update the project in place (default)
+	/// </summary>
+	long keepReleases = 0;
+
+	/// <summary>
+	/// Workspace of the part files and the object store while a release is staged (the workspace is the release then), else empty
+	/// </summary>
+	std::string liveWorkspace;
+
+	/// <summary>
+	/// Rates in KiB/s of all transfers of the host, of the transfers to the subnet of the SSH client, and of the transfers to the SSH client, 0 for unlimited (default)
+	/// </summary>
+	long bandwidthLimit = 0, subnetBandwidth = 0, hostBandwidth = 0;
+
+	/// <summary>
+	/// Token buckets which limit the transfers to the SSH client, opened by connect
+	/// </summary>
+	Bandwidth bandwidth;
+
 	/// <summary>
 	/// Used to specify the file to read from, easier to understand when using SSH read commands
 	/// </summary>
@@ -155,22 +568,179 @@ private:
 	/// <param name="channel">SSH channel to read from</param>
 	/// <param name="from">Specifies wether to read from stdout or stderr</param>
 	/// <param name="to">Pointer to the function to which the data is passed</param>
-	/// <param name="buffer_size">Optional, if the number bytes of the return ouput is known they can be specified here (default: 256)</param>
+	/// <param name="buffer_size">Optional, minimum size of the reused read buffer, if the number bytes of the return ouput is known they can be specified here (default: 256)</param>
 	/// <returns>SSH_BYTES_READ when Bytes where read, SSH_NO_BYTES_READ when no Bytes where read, SSH_ERROR on error</returns>
 	int channel_redirect_output(ssh_channel* channel, enum File from, size_t(*to)(const char*, size_t), unsigned int buffer_size = 256);
 
 	/// <summary>
-	/// Gets all folders and files from the project directory
+	/// Opens a new channel and runs the given shell command on the SSH client
+	/// </summary>
+	/// <param name="cmd">Command to be executed</param>
+	/// <returns>The channel on success, nullptr on error</returns>
+	ssh_channel open_exec_channel(const char* cmd);
+
+	/// <summary>
+	/// Reads the whole stdout or stderr from the channel into a string
+	/// </summary>
+	/// <param name="channel">SSH channel to read from</param>
+	/// <param name="from">Specifies wether to read from stdout or stderr</param>
+	/// <param name="data">Pointer to the string to which the data is appended</param>
+	/// <returns>SSH_OK on success, SSH_ERROR on error</returns>
+	int channel_read_all(ssh_channel* channel, enum File from, std::string* data);
+
+	/// <summary>
+	/// Executes a command on the SSH client and saves its stdout and stderr instead of printing them
+	/// </summary>
+	/// <param name="cmd">Command to be executed</param>
+	/// <param name="out">Pointer to the string to which stdout is appended</param>
+	/// <param name="err">Pointer to the string to which stderr is appended</param>
+	/// <param name="input">Optional, written to stdin of the command, which is closed afterwards</param>
+	/// <returns>SSH_OK on success, SSH_ERROR on connection error</returns>
+	int execute_capture(const char* cmd, std::string* out, std::string* err, const std::string* input = nullptr);
+
+	/// <summary>
+	/// Executes a command on the SSH client, prints its stdout and stderr while it's running and saves them like execute_capture.
+	/// Meanwhile, the requests to the compiler cache which arrive through the forwarded port are answered, and the command is aborted
+	/// if abort was called (or with the option abortOnError on the first error in stderr)
+	/// </summary>
+	/// <param name="cmd">Command to be executed</param>
+	/// <param name="out">Pointer to the string to which stdout is appended</param>
+	/// <param name="err">Pointer to the string to which stderr is appended</param>
+	/// <param name="input">Optional, written to stdin of the command, which is closed afterwards</param>
+	/// <param name="serveCache">If true, the connections to the forwarded port are answered by the compiler cache</param>
+	/// <param name="abortCmd">Command which stops the command and prints "killed", repeated until it succeeds, empty if it can't be aborted</param>
+	/// <returns>SSH_OK on success, SSH_CMD_ERROR if the command was aborted, SSH_ERROR on connection error</returns>
+	int execute_stream(const char* cmd, std::string* out, std::string* err, const std::string* input, bool serveCache, const std::string& abortCmd);
+
+	/// <summary>
+	/// Connects to the agent on the SSH client on the first call, builds and starts it if it isn't running yet
+	/// </summary>
+	/// <returns>true if the agent can be used, false if the shell commands have to be used instead</returns>
+	bool use_agent();
+
+	/// <summary>
+	/// Uploads the sources of the agent (if it wasn't built yet), builds it, and starts it on the SSH client
+	/// </summary>
+	/// <param name="name">Name of the agent binary, contains the hash of the sources</param>
+	/// <param name="sources">The file names and contents of the sources</param>
+	/// <param name="socketPath">Path of the Unix socket on which the agent should listen</param>
+	/// <returns>SSH_OK on success, SSH_CMD_ERROR if the build failed, SSH_ERROR on connection error</returns>
+	int agent_deploy(const std::string& name, const std::vector<std::pair<std::string, std::string>>& sources, const std::string& socketPath);
+
+	/// <summary>
+	/// Executes a command through the agent if it can be used, else like execute
 	/// </summary>
+	/// <param name="cmd">Command to be executed</param>
+	/// <returns>SSH_OK on success, SSH_CMD_ERROR on command error (i.e., output on stderr), SSH_ERROR on connection error</returns>
+	int execute_agent(const char* cmd);
+
+	/// <summary>
+	/// Creates and initializes a new SFTP session, errors are printed to stderr
+	/// </summary>
+	/// <returns>The SFTP session handle (free it with sftp_free), nullptr on error</returns>
+	sftp_session sftp_start();
+
+	/// <summary>
+	/// Builds the manifest of a local project, folders and files matching the option ignore or the .deployignore of the project are left out
+	/// </summary>
+	/// <param name="manifest">Pointer to the manifest</param>
 	/// <param name="project">Name of the project</param>
 	/// <param name="path2project">Path to the project on the host disk</param>
-	/// <param name="dirs">A pointer to a list of strings in which the paths of the folders are pushed</param>
-	/// <param name="files">A pointer to a list of strings in which the paths of the files are pushed</param>
 	/// <returns>SSH_OK on success, SSH_ERROR on error</returns>
-	int get_project_dirs_and_files(const char* project, const char* path2project, std::list<std::string>* dirs, std::list<std::string>* files);
+	int manifest_build(Manifest* manifest, const char* project, const char* path2project);
+
+	/// <summary>
+	/// Reads a whole (small) file from the SSH client
+	/// </summary>
+	/// <param name="sftp">An already open SFTP session handle</param>
+	/// <param name="remotePath">Path of the file on the SSH client</param>
+	/// <param name="data">Pointer to the string in which the content is saved</param>
+	/// <returns>SSH_OK on success, SSH_CMD_ERROR if the file doesn't exist, SSH_ERROR on error</returns>
+	int sftp_read_all(sftp_session* sftp, const std::string& remotePath, std::string* data);
+
+	/// <summary>
+	/// Writes a whole file on the SSH client, an existing file is truncated
+	/// </summary>
+	/// <param name="sftp">An already open SFTP session handle</param>
+	/// <param name="remotePath">Path of the file on the SSH client</param>
+	/// <param name="data">Content of the file</param>
+	/// <returns>SSH_OK on success, SSH_ERROR on error</returns>
+	int sftp_write_all(sftp_session* sftp, const std::string& remotePath, const std::string& data);
+
+	/// <summary>
+	/// Returns if an abort was requested for this connection or for the pipeline which opened it
+	/// </summary>
+	bool abort_requested() const;
+
+	/// <summary>
+	/// Returns if the current workspace differs from the persistent workspace on the SD card
+	/// </summary>
+	/// <returns>true if e.g. the RAM workspace is used, else false</returns>
+	bool is_volatile_workspace();
+
+	/// <summary>
+	/// Returns the workspace of the part files and the object store, which stays the same while a release is staged
+	/// </summary>
+	const std::string& shared_workspace();
+
+	/// <summary>
+	/// Creates a new release as a copy of the active project (without the state files of the application) and lets save, sync, and compile work inside it.
+	/// The workspace has to be switched back with release_finish afterwards
+	/// </summary>
+	/// <param name="project">Name of the project (i.e., folder)</param>
+	/// <param name="release">Pointer to the string in which the name of the release is saved</param>
+	/// <returns>SSH_OK on success, SSH_CMD_ERROR if the copy failed, SSH_ERROR on connection error</returns>
+	int release_stage(const char* project, std::string* release);
+
+	/// <summary>
+	/// Switches the workspace back after a release was staged, a release which failed is removed
+	/// </summary>
+	/// <param name="project">Name of the project (i.e., folder)</param>
+	/// <param name="release">Name of the staged release</param>
+	/// <param name="failed">If true, the release is removed</param>
+	void release_finish(const char* project, const std::string& release, bool failed);
+
+	/// <summary>
+	/// Switches the project folder to a release by replacing its symbolic link atomically, a folder of a project saved without releases is replaced
+	/// </summary>
+	/// <param name="project">Name of the project (i.e., folder)</param>
+	/// <param name="release">Name of the release</param>
+	/// <param name="prune">If true, the oldest releases beyond keepReleases are removed afterwards</param>
+	/// <returns>SSH_OK on success, SSH_CMD_ERROR if the release doesn't exist or couldn't be activated, SSH_ERROR on connection error</returns>
+	int release_activate(const char* project, const std::string& release, bool prune);
+
+	/// <summary>
+	/// Creates the shell commands which apply the resource options (affinity, priority, cgroup, governor) to the stopped process $c,
+	/// the commands may not contain single quotes because they are part of the launcher script
+	/// </summary>
+	/// <param name="project">Name of the project</param>
+	/// <returns>The shell commands, empty if no resource option is set</returns>
+	std::string resource_setup(const char* project);
+
+	/// <summary>
+	/// Measures the offset between the clock of the SSH client and the local clock
+	/// </summary>
+	/// <param name="offset">Pointer to the variable in which the offset (clock of the SSH client minus local clock) in microseconds is saved</param>
+	/// <param name="rtt">Pointer to the variable in which the round trip time of the measurement in microseconds is saved</param>
+	/// <returns>SSH_OK on success, SSH_ERROR on error</returns>
+	int measure_clock(long long* offset, long long* rtt);
 
 	/// <summary>
-	/// Removes the current sw_workspace folder from the SSH client and recreates it including the given folders
+	/// Creates the shell commands which restore the CPU governors and remove the cgroup of the last start, run inside the Debug folder
+	/// </summary>
+	/// <returns>The shell commands, they don't contain single quotes</returns>
+	std::string resource_restore();
+
+	/// <summary>
+	/// Creates a shell condition which is only true if the application of the last start is still running,
+	/// afterwards the shell variables pid and pgid contain the PID and process group of the application
+	/// </summary>
+	/// <param name="project">Name of the project</param>
+	/// <returns>The shell condition, which changes to the Debug directory of the project</returns>
+	std::string app_running_condition(const char* project);
+
+	/// <summary>
+	/// Removes the current project folder from the workspace of the SSH client and recreates it including the given folders
 	/// </summary>
 	/// <param name="project">Name of the project</param>
 	/// <param name="dirs">A pointer to a list of strings containing the paths of the folders to be created</param>
@@ -178,21 +748,88 @@ private:
 	int project_mkdirs(const char* project, std::list<std::string>* dirs);
 
 	/// <summary>
-	/// Saves a single file from a project on the SSH client
+	/// Saves a single file from a project on the SSH client. Files of at least resumeMinSize Bytes are written into a part file
+	/// inside SSH_PARTS_FOLDER instead, an existing part is continued if its content matches the beginning of the local file
 	/// </summary>
 	/// <param name="sftp">An already open SFTP session handle</param>
 	/// <param name="filePath">Path to the file relative the project directory</param>
+	/// <param name="remotePath">Path of the file on the SSH client</param>
 	/// <param name="path2project">Path to the project on the host disk</param>
-	/// <param name="buffer_size">Optional, the size of the read buffer can be specified here (default: 16384)</param>
+	/// <param name="chunk_size">The maximum number of Bytes per SFTP write request</param>
+	/// <param name="partPath">Pointer in which the path of the part file is saved, empty if the file was written directly</param>
+	/// <param name="sentBytes">Pointer to the counter of sent Bytes</param>
+	/// <param name="hash">Optional, pointer in which the hash of the sent content is saved</param>
 	/// <returns>SSH_OK on success, SSH_ERROR on error</returns>
-	int project_save_file(sftp_session* sftp, std::string filePath, const char* path2project, unsigned int buffer_size = 16384);
+	int project_save_file(sftp_session* sftp, std::string filePath, const std::string& remotePath, const char* path2project, size_t chunk_size, std::string* partPath, uint64_t* sentBytes, uint64_t* hash = nullptr);
+
+	/// <summary>
+	/// Returns how many Bytes of a part file match the beginning of the local file, compares the hashes of the whole part
+	/// through the agent. Without the agent a part can't be verified and is never resumed
+	/// </summary>
+	/// <param name="sftp">An already open SFTP session handle</param>
+	/// <param name="partPath">Path of the part file on the SSH client</param>
+	/// <param name="data">Pointer to the local file</param>
+	/// <param name="size">Size of the local file in Bytes</param>
+	/// <returns>The offset at which the upload continues, 0 if the part is missing or doesn't match</returns>
+	uint64_t part_verified_size(sftp_session* sftp, const std::string& partPath, const char* data, uint64_t size);
 
 	/// <summary>
-	/// Saves/Transfers multiple files from a project on the SSH client
+	/// Downloads a single file from the SSH client with multiple read requests in flight (pipelined)
 	/// </summary>
+	/// <param name="sftp">An already open SFTP session handle</param>
+	/// <param name="remotePath">Path of the file on the SSH client</param>
+	/// <param name="localPath">Path of the file on the host disk, its folders must exist</param>
+	/// <param name="nbytes">Pointer to the counter of downloaded Bytes</param>
+	/// <returns>SSH_OK on success, SSH_ERROR on error</returns>
+	int collect_file(sftp_session* sftp, const std::string& remotePath, const std::string& localPath, uint64_t* nbytes);
+
+	/// <summary>
+	/// Downloads a file or a whole folder (recursively) from the SSH client
+	/// </summary>
+	/// <param name="sftp">An already open SFTP session handle</param>
+	/// <param name="remotePath">Path of the file or folder on the SSH client</param>
+	/// <param name="localPath">Path of the file or folder on the host disk</param>
+	/// <param name="nfiles">Pointer to the counter of downloaded files</param>
+	/// <param name="nbytes">Pointer to the counter of downloaded Bytes</param>
+	/// <returns>SSH_OK on success, SSH_ERROR on error</returns>
+	int collect_path(sftp_session* sftp, const std::string& remotePath, const std::string& localPath, size_t* nfiles, uint64_t* nbytes);
+
+	/// <summary>
+	/// Saves/Transfers multiple files from a project on the SSH client. If the connection drops, it reconnects (see reconnects)
+	/// and resumes the current file. With the option verify, the hashes of the sent files are requested in batches while the next files
+	/// are sent, files with a wrong hash are sent again. The part files are renamed into place after all files were sent and verified
+	/// </summary>
+	/// <param name="sftp">Pointer to an already open SFTP session handle, replaced after a reconnection</param>
 	/// <param name="files">A pointer to a list of strings containing the paths of the files to be transferred</param>
 	/// <param name="path2project">Path to the project on the host disk</param>
+	/// <param name="sentBytes">Optional, pointer to the counter of sent Bytes</param>
+	/// <param name="remotePaths">Optional, remote paths of the files by their path, else they are saved inside the workspace</param>
 	/// <returns>SSH_OK on success, SSH_ERROR on error</returns>
-	int project_save_files(std::list<std::string>* files, const char* path2project);
+	int project_save_files(sftp_session* sftp, std::list<std::string>* files, const char* path2project, uint64_t* sentBytes = nullptr,
+		const std::unordered_map<std::string, std::string>* remotePaths = nullptr);
+
+	/// <summary>
+	/// Replaces the files of a project by hard links to the objects with the same content inside the object store of the SSH client
+	/// (see SSH_OBJECTS_FOLDER), missing objects are uploaded first if requested
+	/// </summary>
+	/// <param name="sftp">Pointer to an already open SFTP session handle, replaced after a reconnection</param>
+	/// <param name="manifest">Manifest with the sizes and hashes of the local files</param>
+	/// <param name="files">Pointer to the list of files to be transferred, the linked files are removed from it</param>
+	/// <param name="path2project">Path to the project on the host disk</param>
+	/// <param name="upload">If true, the missing objects are uploaded and all files are linked, else only the files whose objects exist</param>
+	/// <param name="sentBytes">Pointer to the counter of sent Bytes</param>
+	/// <returns>SSH_OK on success, SSH_CMD_ERROR if a file couldn't be linked, SSH_ERROR on error</returns>
+	int project_store_files(sftp_session* sftp, const Manifest& manifest, std::list<std::string>* files, const char* path2project, bool upload, uint64_t* sentBytes);
+
+	/// <summary>
+	/// Sends the large files (at least deltaMinSize Bytes) as block-level delta against their current version on the SSH client
+	/// through the agent, which rebuilds and replaces them atomically. The checksums of the next files are requested while a delta is created
+	/// </summary>
+	/// <param name="manifest">Manifest with the sizes and hashes of the local files</param>
+	/// <param name="files">Pointer to the list of files to be transferred, the patched files are removed from it, the others have to be sent completely</param>
+	/// <param name="path2project">Path to the project on the host disk</param>
+	/// <param name="sentBytes">Pointer in which the number of Bytes sent for the patched files is saved</param>
+	/// <returns>SSH_OK on success (also if files couldn't be patched), SSH_ERROR on connection error</returns>
+	int project_patch_files(const Manifest& manifest, std::list<std::string>* files, const char* path2project, uint64_t* sentBytes);
 
 };
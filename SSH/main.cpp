@@ -3,10 +3,12 @@
 #include <pthread.h>
 #include <signal.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <functional>
 #include <iostream>
 #include <unordered_map>
+#include <vector>
 
 #define USERNAME "pi"
 #define PASSWORD "raspberry"
@@ -27,6 +29,10 @@ void* t_func(void* args) {
     // Block here until something is written to stdin
     fgetc(stdin);
 
+    // A running build resp. pipeline is aborted by compile resp. pipeline itself, which disconnects afterwards
+    if (ssh.abort())
+        return nullptr;
+
     // Disconnect from the SSH client and exit the application
     disconnectAndExit();
 
@@ -34,6 +40,17 @@ void* t_func(void* args) {
     return nullptr;
 }
 
+// Returns the targets of relay resp. share or the stages of pipeline, all arguments from the given one on
+std::vector<std::string> targetArgs(char** args) {
+    std::vector<std::string> targets;
+
+    // The arguments are terminated by a null pointer
+    for (char** arg = args; *arg != nullptr; arg++)
+        targets.push_back(*arg);
+
+    return targets;
+}
+
 // Signal Handler
 void signalHandler(int sig) {
     // If CTRL+C was pressed
@@ -43,6 +60,33 @@ void signalHandler(int sig) {
 }
 
 int main(int argc, char* argv[]) {
+    // Index of the first argument after the optional options
+    int i = 1;
+
+    // Iterate through all leading options of the form --key=value
+    for (; i < argc && strncmp(argv[i], "--", 2) == 0; i++) {
+        // Search for the equal sign which separates the key from the value
+        char* value = strchr(argv[i], '=');
+
+        // If there is no equal sign
+        if (value == nullptr) {
+            // Print an error message to stderr
+            std::cerr << "Error: Invalid option " << argv[i] << ", expected --key=value" << std::endl;
+
+            // Exit with an error code
+            return SSH_ERROR;
+        }
+
+        // Save the key without the leading dashes and set the option, the value starts after the equal sign
+        std::string key(argv[i] + 2, value);
+        if (ssh.setOption(key.c_str(), value + 1) != SSH_OK)
+            // Exit with an error code if the value is invalid
+            return SSH_ERROR;
+    }
+
+    // Let the remaining arguments start after the options
+    argv = &argv[i - 1];
+
     // Save the pointer from the arguments which points to the host name
     char* hostName = argv[1];
 
@@ -86,8 +130,18 @@ int main(int argc, char* argv[]) {
     // The functions are lambda expressions to deal with different parameter signatures and default values
     std::unordered_map<std::string, std::function<int()>> str2func = {
         { "status",          [project]()          { return ssh.isAppRunning   (project);             } },
+        { "refresh",         [project]()          { return ssh.refresh        (project);             } },
         { "execute",         [project]()          { return ssh.execute        (project);             } },
         { "save",            [project, optArgs]() { return ssh.save           (project, optArgs[0]); } },
+        { "sync",            [project, optArgs]() { return ssh.sync           (project, optArgs[0]); } },
+        { "update",          [project, optArgs]() { return ssh.update         (project, optArgs[0], optArgs[0] ? optArgs[1] : nullptr); } },
+        { "collect",         [project, optArgs]() { return ssh.collect        (project, optArgs[0]); } },
+        { "pipeline",        [project, optArgs]() { return ssh.pipeline       (project, optArgs[0], optArgs[0] ? targetArgs(&optArgs[1]) : std::vector<std::string>()); } },
+        { "rollback",        [project, optArgs]() { return ssh.rollback       (project, optArgs[0], optArgs[0] ? optArgs[1] : nullptr); } },
+        { "relay",           [project, optArgs]() { return ssh.relay          (project, optArgs[0], optArgs[0] ? targetArgs(&optArgs[1]) : std::vector<std::string>()); } },
+        { "share",           [project, optArgs]() { return ssh.share          (project, targetArgs(optArgs)); } },
+        { "fingerprint",     [project]()          { return ssh.fingerprint    (project);             } },
+        { "manifest",        [project, optArgs]() { return ssh.manifest       (project, optArgs[0]); } },
         { "compile",         [project]()          { return ssh.compile        (project);             } },
         { "start",           [project, optArgs]() { return ssh.start          (project, optArgs[0]); } },
         { "stop",            [project]()          { return ssh.stop           (project);             } },
@@ -107,9 +161,22 @@ int main(int argc, char* argv[]) {
         return SSH_ERROR;
     }
 
-    // Connect to the SSH client with the given address, username and password
+    // Commands which only work on the host disk don't need a connection
+    if (strcmp(command, "manifest") == 0)
+        return execFunc();
+
+    // Split an optional port from the host name (address:port), e.g., to test with multiple SSH servers on localhost
+    unsigned int port = 22;
+    char* colon = strrchr(hostName, ':');
+    if (colon != nullptr && strchr(hostName, ':') == colon) {
+        // Cut the port from the host name
+        *colon = '\0';
+        port = (unsigned int)atoi(colon + 1);
+    }
+
+    // Connect to the SSH client with the given address, port, username and password
     // Save the return code
-    int rc = ssh.connect(hostName, USERNAME, PASSWORD);
+    int rc = ssh.connect(hostName, port, USERNAME, PASSWORD);
 
     // If there was an error while connecting to the SSH client
     if (rc != SSH_OK)